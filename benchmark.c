@@ -1,9 +1,13 @@
-#define _POSIX_C_SOURCE 199309L
+#define _POSIX_C_SOURCE 200809L
+#define VISTRUTAH_INTERNAL
 #include "vistrutah.h"
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <time.h>
+#include <unistd.h>
 
 #if defined(VISTRUTAH_INTEL)
 #    include <immintrin.h>
@@ -867,6 +871,1380 @@ benchmark_small_messages()
     }
 }
 
+static void
+benchmark_job_manager()
+{
+    printf("\nSmall Messages via Job Manager (Vistrutah-512, 16 keys, 4096 messages)\n");
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    static const int   max_blocks[] = { 1, 2, 4, 8, 8 };
+    static const char *size_names[] = { "64B", "128B", "256B", "512B", "64-512B mixed" };
+    const size_t       MESSAGES     = 4096;
+    const int          NUM_SAMPLES  = 5;
+    const int          ITERATIONS   = 20;
+
+    vistrutah_512_ctx ctx[16];
+    vistrutah_mb_mgr  mgr;
+    vistrutah_mb_job *jobs = malloc(MESSAGES * sizeof *jobs);
+    uint8_t          *data = safe_aligned_alloc(64, MESSAGES * 512);
+    uint8_t           key[64];
+    double            samples[NUM_SAMPLES];
+    char              label[64];
+
+    for (int k = 0; k < 16; k++) {
+        init_random_data(key, sizeof key);
+        vistrutah_512_init(&ctx[k], key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+    }
+    init_random_data(data, MESSAGES * 512);
+
+    for (int sz = 0; sz < 5; sz++) {
+        size_t total = 0;
+
+        for (size_t m = 0; m < MESSAGES; m++) {
+            jobs[m].ctx     = &ctx[m % 16];
+            jobs[m].decrypt = 0;
+            jobs[m].in      = data + 512 * m;
+            jobs[m].out     = data + 512 * m;
+            jobs[m].blocks  = sz < 4 ? (size_t) max_blocks[sz] : 1 + (size_t) rand() % 8;
+            total += 64 * jobs[m].blocks;
+        }
+
+        for (int mode = 0; mode < 2; mode++) {
+            for (int s = 0; s < NUM_SAMPLES; s++) {
+                uint64_t start = get_nanos();
+                for (int it = 0; it < ITERATIONS; it++) {
+                    if (mode == 0) {
+                        for (size_t m = 0; m < MESSAGES; m++) {
+                            vistrutah_512_encrypt_blocks(jobs[m].in, jobs[m].out, jobs[m].blocks,
+                                                         jobs[m].ctx->key, 64,
+                                                         VISTRUTAH_512_ROUNDS_LONG_512KEY);
+                        }
+                        continue;
+                    }
+                    vistrutah_mb_init(&mgr, 64, 0);
+                    for (size_t m = 0; m < MESSAGES; m++) {
+                        vistrutah_mb_submit(&mgr, &jobs[m]);
+                        while (vistrutah_mb_get_completed(&mgr) != NULL) {
+                        }
+                    }
+                    vistrutah_mb_flush(&mgr);
+                    while (vistrutah_mb_get_completed(&mgr) != NULL) {
+                    }
+                }
+                uint64_t end = get_nanos();
+
+                g_benchmark_checksum += data[0];
+
+                samples[s] =
+                    ((double) total * ITERATIONS / (1024.0 * 1024.0)) / ((end - start) / 1e9);
+            }
+
+            stats_t stats = get_stats(samples, NUM_SAMPLES);
+
+            snprintf(label, sizeof label, "%s, %s", size_names[sz],
+                     mode == 0 ? "one call per message" : "job manager");
+            printf("  %-40s %7.1f MB/s  (min: %6.1f, max: %6.1f)\n", label, stats.median,
+                   stats.min, stats.max);
+        }
+    }
+
+    free(jobs);
+    free(data);
+}
+
+static void
+benchmark_offload()
+{
+    printf("\nOffload Engine vs Inline (Vistrutah-512, 1 worker, 1 producer)\n");
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    static const size_t sizes[]      = { 64, 512, 4096 };
+    static const char  *size_names[] = { "64B", "512B", "4KB" };
+    const size_t        TOTAL        = 8 * 1024 * 1024;
+    const int           NUM_SAMPLES  = 3;
+    const int           ROUND_TRIPS  = 2000;
+
+    vistrutah_512_ctx  ctx;
+    vistrutah_offload *engine = vistrutah_offload_create(1, 1, 256, NULL);
+    vistrutah_mb_job  *jobs   = malloc(256 * sizeof *jobs);
+    uint8_t           *data   = safe_aligned_alloc(64, TOTAL);
+    double            *lat    = malloc(ROUND_TRIPS * sizeof *lat);
+    uint8_t            key[64];
+    double             samples[NUM_SAMPLES];
+    char               label[64];
+
+    if (engine == NULL) {
+        printf("  (could not start the offload engine)\n");
+        free(jobs);
+        free(data);
+        free(lat);
+        return;
+    }
+    init_random_data(key, sizeof key);
+    init_random_data(data, TOTAL);
+    vistrutah_512_init(&ctx, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+
+    for (size_t sz = 0; sz < sizeof sizes / sizeof sizes[0]; sz++) {
+        size_t size     = sizes[sz];
+        size_t requests = TOTAL / size;
+
+        // Throughput: keep up to 256 requests in flight
+        for (int mode = 0; mode < 2; mode++) {
+            for (int s = 0; s < NUM_SAMPLES; s++) {
+                size_t   submitted = 0, completed = 0;
+                uint64_t start     = get_nanos();
+
+                if (mode == 0) {
+                    for (size_t r = 0; r < requests; r++) {
+                        vistrutah_512_encrypt_blocks(data + size * r, data + size * r, size / 64,
+                                                     key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+                    }
+                }
+                while (mode == 1 && completed < requests) {
+                    for (; submitted < requests && submitted - completed < 256; submitted++) {
+                        vistrutah_mb_job *job = &jobs[submitted % 256];
+
+                        job->ctx     = &ctx;
+                        job->decrypt = 0;
+                        job->in      = data + size * submitted;
+                        job->out     = data + size * submitted;
+                        job->blocks  = size / 64;
+                        vistrutah_offload_submit(engine, 0, job);
+                    }
+                    while (vistrutah_offload_poll(engine, 0) != NULL) {
+                        completed++;
+                    }
+                    sched_yield();
+                }
+                uint64_t end = get_nanos();
+
+                g_benchmark_checksum += data[0];
+
+                samples[s] = (TOTAL / (1024.0 * 1024.0)) / ((double) (end - start) / 1e9);
+            }
+
+            stats_t stats = get_stats(samples, NUM_SAMPLES);
+
+            snprintf(label, sizeof label, "%s, %s", size_names[sz],
+                     mode == 0 ? "inline" : "offloaded");
+            printf("  %-40s %7.1f MB/s  (min: %6.1f, max: %6.1f)\n", label, stats.median,
+                   stats.min, stats.max);
+        }
+
+        // Round trip: one request at a time
+        for (int mode = 0; mode < 2; mode++) {
+            for (int i = 0; i < ROUND_TRIPS; i++) {
+                vistrutah_mb_job *job = &jobs[0];
+                uint64_t          start;
+
+                job->ctx     = &ctx;
+                job->decrypt = 0;
+                job->in      = data;
+                job->out     = data;
+                job->blocks  = size / 64;
+
+                start = get_nanos();
+                if (mode == 0) {
+                    vistrutah_512_encrypt_blocks(data, data, size / 64, key, 64,
+                                                 VISTRUTAH_512_ROUNDS_LONG_512KEY);
+                } else {
+                    vistrutah_offload_submit(engine, 0, job);
+                    while (vistrutah_offload_poll(engine, 0) == NULL) {
+                        sched_yield();
+                    }
+                }
+                uint64_t end = get_nanos();
+
+                lat[i] = (double) (end - start) / 1000.0;
+            }
+
+            qsort(lat, ROUND_TRIPS, sizeof *lat, compare_double);
+            snprintf(label, sizeof label, "%s round trip, %s", size_names[sz],
+                     mode == 0 ? "inline" : "offloaded");
+            printf("  %-40s p50 %6.2f us  p99 %6.2f us  (max: %.2f)\n", label,
+                   lat[ROUND_TRIPS / 2], lat[ROUND_TRIPS * 99 / 100], lat[ROUND_TRIPS - 1]);
+        }
+    }
+
+    vistrutah_offload_destroy(engine);
+    free(jobs);
+    free(data);
+    free(lat);
+}
+
+static double
+multi_block_rate(uint8_t *buf, size_t blocks, const uint8_t *key, int decrypt)
+{
+    const int NUM_SAMPLES = 5;
+    double    samples[NUM_SAMPLES];
+
+    for (int s = 0; s < NUM_SAMPLES; s++) {
+        uint64_t start = get_nanos();
+        if (decrypt) {
+            vistrutah_512_decrypt_blocks(buf, buf, blocks, key, 64,
+                                         VISTRUTAH_512_ROUNDS_LONG_512KEY);
+        } else {
+            vistrutah_512_encrypt_blocks(buf, buf, blocks, key, 64,
+                                         VISTRUTAH_512_ROUNDS_LONG_512KEY);
+        }
+        uint64_t end = get_nanos();
+
+        g_benchmark_checksum += buf[0];
+
+        samples[s] = (blocks * 64 / (1024.0 * 1024.0)) / ((double) (end - start) / 1e9);
+    }
+    return get_stats(samples, NUM_SAMPLES).median;
+}
+
+static void
+benchmark_autotune()
+{
+    printf("\nStartup Autotuning (Vistrutah-512 multi-block, 4 MiB)\n");
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    static const char *names[VISTRUTAH_VARIANTS] = { "256 encrypt", "256 decrypt", "512 encrypt",
+                                                     "512 decrypt" };
+    const size_t       SIZE                      = 4 * 1024 * 1024;
+
+    vistrutah_kernel_config defaults[VISTRUTAH_VARIANTS];
+    uint8_t                *buf = safe_aligned_alloc(64, SIZE);
+    uint8_t                 key[64];
+    double                  before[2], after[2];
+    char                    label[64];
+
+    init_random_data(key, sizeof key);
+    init_random_data(buf, SIZE);
+    for (int v = 0; v < VISTRUTAH_VARIANTS; v++) {
+        defaults[v] = vistrutah_get_kernel_config((vistrutah_variant) v);
+    }
+    for (int d = 0; d < 2; d++) {
+        before[d] = multi_block_rate(buf, SIZE / 64, key, d);
+    }
+
+    uint64_t start = get_nanos();
+    vistrutah_autotune(NULL);
+    uint64_t end = get_nanos();
+
+    printf("  %-40s %7.2f ms\n", "Tuning time", (end - start) / 1e6);
+    for (int v = 0; v < VISTRUTAH_VARIANTS; v++) {
+        vistrutah_kernel_config c = vistrutah_get_kernel_config((vistrutah_variant) v);
+
+        snprintf(label, sizeof label, "%s kernel", names[v]);
+        printf("  %-40s %s x%d (default %s x%d)\n", label, c.kernel, c.blocks_in_flight,
+               defaults[v].kernel, defaults[v].blocks_in_flight);
+    }
+    for (int d = 0; d < 2; d++) {
+        after[d] = multi_block_rate(buf, SIZE / 64, key, d);
+        snprintf(label, sizeof label, "%s, default -> tuned", names[2 + d]);
+        printf("  %-40s %7.1f -> %7.1f MB/s\n", label, before[d], after[d]);
+    }
+
+    // The sections that follow measure the built-in defaults
+    memcpy(vistrutah_kernel_configs, defaults, sizeof defaults);
+    free(buf);
+}
+
+#if defined(VISTRUTAH_INTEL) && defined(__PCLMUL__)
+// Baseline AES-256-GCM with AES-NI and PCLMULQDQ: four-block CTR and a
+// block-at-a-time GHASH (Intel white paper multiplication). Not as tuned as
+// a production GCM with aggregated reduction, but it uses the same units.
+static __m128i
+ghash_mul(__m128i a, __m128i b)
+{
+    __m128i t2, t3, t4, t5, t6, t7, t8, t9;
+
+    t3 = _mm_clmulepi64_si128(a, b, 0x00);
+    t4 = _mm_clmulepi64_si128(a, b, 0x10);
+    t5 = _mm_clmulepi64_si128(a, b, 0x01);
+    t6 = _mm_clmulepi64_si128(a, b, 0x11);
+    t4 = _mm_xor_si128(t4, t5);
+    t5 = _mm_slli_si128(t4, 8);
+    t4 = _mm_srli_si128(t4, 8);
+    t3 = _mm_xor_si128(t3, t5);
+    t6 = _mm_xor_si128(t6, t4);
+    t7 = _mm_srli_epi32(t3, 31);
+    t8 = _mm_srli_epi32(t6, 31);
+    t3 = _mm_slli_epi32(t3, 1);
+    t6 = _mm_slli_epi32(t6, 1);
+    t9 = _mm_srli_si128(t7, 12);
+    t8 = _mm_slli_si128(t8, 4);
+    t7 = _mm_slli_si128(t7, 4);
+    t3 = _mm_or_si128(t3, t7);
+    t6 = _mm_or_si128(t6, t8);
+    t6 = _mm_or_si128(t6, t9);
+    t7 = _mm_slli_epi32(t3, 31);
+    t8 = _mm_slli_epi32(t3, 30);
+    t9 = _mm_slli_epi32(t3, 25);
+    t7 = _mm_xor_si128(t7, t8);
+    t7 = _mm_xor_si128(t7, t9);
+    t8 = _mm_srli_si128(t7, 4);
+    t7 = _mm_slli_si128(t7, 12);
+    t3 = _mm_xor_si128(t3, t7);
+    t2 = _mm_srli_epi32(t3, 1);
+    t4 = _mm_srli_epi32(t3, 2);
+    t5 = _mm_srli_epi32(t3, 7);
+    t2 = _mm_xor_si128(t2, t4);
+    t2 = _mm_xor_si128(t2, t5);
+    t2 = _mm_xor_si128(t2, t8);
+    t3 = _mm_xor_si128(t3, t2);
+    return _mm_xor_si128(t6, t3);
+}
+
+static void
+aes256_gcm_encrypt(const __m128i *rk, const uint8_t *iv, const uint8_t *in, uint8_t *out,
+                   size_t len, uint8_t *tag)
+{
+    const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i one   = _mm_set_epi32(0, 0, 0, 1);
+    uint8_t       j0_bytes[16];
+    uint8_t       zero[16] = { 0 };
+    uint8_t       h_bytes[16];
+
+    memcpy(j0_bytes, iv, 12);
+    j0_bytes[12] = j0_bytes[13] = j0_bytes[14] = 0;
+    j0_bytes[15]                                = 1;
+    aes256_encrypt_with_schedule(zero, h_bytes, rk);
+
+    __m128i h   = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) h_bytes), bswap);
+    __m128i ctr = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) j0_bytes), bswap);
+    __m128i y   = _mm_setzero_si128();
+    size_t  i   = 0;
+
+    for (; i + 64 <= len; i += 64) {
+        __m128i c[4];
+
+        for (int j = 0; j < 4; j++) {
+            ctr  = _mm_add_epi32(ctr, one);
+            c[j] = _mm_xor_si128(_mm_shuffle_epi8(ctr, bswap), rk[0]);
+        }
+        for (int r = 1; r < 14; r++) {
+            for (int j = 0; j < 4; j++) {
+                c[j] = _mm_aesenc_si128(c[j], rk[r]);
+            }
+        }
+        for (int j = 0; j < 4; j++) {
+            c[j] = _mm_aesenclast_si128(c[j], rk[14]);
+            c[j] = _mm_xor_si128(c[j], _mm_loadu_si128((const __m128i *) (in + i + 16 * j)));
+            _mm_storeu_si128((__m128i *) (out + i + 16 * j), c[j]);
+            y = ghash_mul(_mm_xor_si128(y, _mm_shuffle_epi8(c[j], bswap)), h);
+        }
+    }
+    for (; i < len; i += 16) {
+        uint8_t block[16] = { 0 };
+        uint8_t ks[16];
+        size_t  n = len - i < 16 ? len - i : 16;
+
+        ctr = _mm_add_epi32(ctr, one);
+        _mm_storeu_si128((__m128i *) ks, _mm_shuffle_epi8(ctr, bswap));
+        aes256_encrypt_with_schedule(ks, ks, rk);
+        for (size_t j = 0; j < n; j++) {
+            block[j] = out[i + j] = in[i + j] ^ ks[j];
+        }
+        y = ghash_mul(
+            _mm_xor_si128(y, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) block), bswap)), h);
+    }
+
+    __m128i lengths = _mm_set_epi64x(0, (long long) len * 8);
+    uint8_t ek_j0[16];
+
+    y = ghash_mul(_mm_xor_si128(y, lengths), h);
+    aes256_encrypt_with_schedule(j0_bytes, ek_j0, rk);
+    _mm_storeu_si128((__m128i *) tag, _mm_xor_si128(_mm_shuffle_epi8(y, bswap),
+                                                     _mm_loadu_si128((const __m128i *) ek_j0)));
+}
+#endif
+
+// One-pass AEAD throughput on typical message sizes
+static void
+benchmark_aead()
+{
+    printf("\nAEAD Throughput (Vistrutah-512 OCB and SIV, 256-bit key, 14 rounds)\n");
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    const size_t message_sizes[] = { 1024, 4096, 16384, 65536 };
+    const char  *size_names[]    = { "1 KiB", "4 KiB", "16 KiB", "64 KiB" };
+    const int    num_sizes       = 4;
+    const int    NUM_SAMPLES     = 10;
+    const size_t bytes_per_run   = 16 * 1024 * 1024;
+
+    uint8_t key[32];
+    uint8_t nonce[VISTRUTAH_OCB_NONCE_BYTES];
+    uint8_t tag[VISTRUTAH_SIV_BYTES];
+
+    init_random_data(key, sizeof key);
+    init_random_data(nonce, sizeof nonce);
+
+    vistrutah_ocb_ctx ctx;
+    vistrutah_ocb_init(&ctx, key, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+
+    vistrutah_siv_ctx siv_ctx;
+    vistrutah_siv_init(&siv_ctx, key, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+
+#if defined(VISTRUTAH_INTEL) && defined(__PCLMUL__)
+    __m128i rk[15];
+    aes256_key_expansion(key, rk);
+#endif
+
+    for (int sz = 0; sz < num_sizes; sz++) {
+        size_t   msg_size   = message_sizes[sz];
+        size_t   iterations = bytes_per_run / msg_size;
+        uint8_t *input      = safe_aligned_alloc(64, msg_size);
+        uint8_t *output     = safe_aligned_alloc(64, msg_size);
+        double   samples[NUM_SAMPLES];
+        char     label[64];
+
+        init_random_data(input, msg_size);
+
+        for (int mode = 0; mode < 4; mode++) {
+            for (int s = 0; s < NUM_SAMPLES; s++) {
+                uint64_t start = get_nanos();
+                for (size_t iter = 0; iter < iterations; iter++) {
+                    if (mode == 0) {
+                        vistrutah_ocb_encrypt(&ctx, input, output, msg_size, NULL, 0, nonce, tag);
+                    } else if (mode == 1) {
+                        // Authentication fails on random input; the whole
+                        // message is still decrypted before the check.
+                        vistrutah_ocb_decrypt(&ctx, input, output, msg_size, NULL, 0, nonce, tag);
+                    } else if (mode == 2) {
+                        vistrutah_siv_encrypt(&siv_ctx, input, output, msg_size, NULL, 0, tag);
+                    } else {
+#if defined(VISTRUTAH_INTEL) && defined(__PCLMUL__)
+                        aes256_gcm_encrypt(rk, nonce, input, output, msg_size, tag);
+#endif
+                    }
+                }
+                uint64_t end     = get_nanos();
+                double   elapsed = (end - start) / 1e9;
+
+                g_benchmark_checksum += output[0] + tag[0];
+
+                samples[s] = ((double) msg_size * iterations / (1024.0 * 1024.0)) / elapsed;
+            }
+
+#if !(defined(VISTRUTAH_INTEL) && defined(__PCLMUL__))
+            if (mode == 3) {
+                printf("  %-6s AES-256-GCM baseline not available on this platform\n",
+                       size_names[sz]);
+                continue;
+            }
+#endif
+            stats_t stats = get_stats(samples, NUM_SAMPLES);
+
+            snprintf(label, sizeof label, "%-6s %s", size_names[sz],
+                     mode == 0   ? "OCB encrypt"
+                     : mode == 1 ? "OCB decrypt"
+                     : mode == 2 ? "SIV encrypt (two passes)"
+                                 : "AES-256-GCM encrypt (baseline)");
+            printf("  %-40s %7.1f MB/s  (min: %6.1f, max: %6.1f)\n", label, stats.median,
+                   stats.min, stats.max);
+        }
+
+        free(input);
+        free(output);
+    }
+}
+
+#if defined(VISTRUTAH_INTEL) && defined(__SHA__)
+// Baseline SHA-256 with the SHA extensions (the usual SHA-NI round
+// structure, four rounds per iteration)
+static const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static void
+sha256_blocks_shani(uint32_t *state, const uint8_t *data, size_t blocks)
+{
+#    ifdef __AVX__
+    // The SHA instructions only have legacy SSE encodings; without this,
+    // dirty upper vector state makes every one of them pay a transition.
+    _mm256_zeroupper();
+#    endif
+
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i       tmp  = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) &state[0]), 0xB1);
+    __m128i       st1  = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) &state[4]), 0x1B);
+    __m128i       st0  = _mm_alignr_epi8(tmp, st1, 8);
+
+    st1 = _mm_blend_epi16(st1, tmp, 0xF0);
+
+    for (; blocks > 0; blocks--, data += 64) {
+        __m128i abef = st0;
+        __m128i cdgh = st1;
+        __m128i w[4];
+
+        for (int i = 0; i < 16; i++) {
+            __m128i msg;
+
+            if (i < 4) {
+                w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (data + 16 * i)), mask);
+            } else {
+                __m128i t = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+
+                t        = _mm_add_epi32(t, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+                w[i & 3] = _mm_sha256msg2_epu32(t, w[(i + 3) & 3]);
+            }
+            msg = _mm_add_epi32(w[i & 3], _mm_loadu_si128((const __m128i *) &SHA256_K[4 * i]));
+            st1 = _mm_sha256rnds2_epu32(st1, st0, msg);
+            st0 = _mm_sha256rnds2_epu32(st0, st1, _mm_shuffle_epi32(msg, 0x0E));
+        }
+        st0 = _mm_add_epi32(st0, abef);
+        st1 = _mm_add_epi32(st1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(st0, 0x1B);
+    st1 = _mm_shuffle_epi32(st1, 0xB1);
+    _mm_storeu_si128((__m128i *) &state[0], _mm_blend_epi16(tmp, st1, 0xF0));
+    _mm_storeu_si128((__m128i *) &state[4], _mm_alignr_epi8(st1, tmp, 8));
+}
+
+static void
+sha256_shani(const uint8_t *in, size_t len, uint8_t *out)
+{
+    uint32_t state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                          0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    uint8_t  last[128] = { 0 };
+    size_t   full      = len / 64;
+    size_t   rem       = len % 64;
+    size_t   tail      = rem < 56 ? 64 : 128;
+
+    sha256_blocks_shani(state, in, full);
+    memcpy(last, in + 64 * full, rem);
+    last[rem] = 0x80;
+    for (int i = 0; i < 8; i++) {
+        last[tail - 1 - i] = (uint8_t) ((uint64_t) len * 8 >> (8 * i));
+    }
+    sha256_blocks_shani(state, last, tail / 64);
+
+    for (int i = 0; i < 8; i++) {
+        out[4 * i]     = (uint8_t) (state[i] >> 24);
+        out[4 * i + 1] = (uint8_t) (state[i] >> 16);
+        out[4 * i + 2] = (uint8_t) (state[i] >> 8);
+        out[4 * i + 3] = (uint8_t) state[i];
+    }
+}
+#endif
+
+#if defined(VISTRUTAH_INTEL)
+#    define HASH_COST_UNIT "cycles/byte"
+
+static inline uint64_t
+get_hash_cost_counter()
+{
+    return __rdtsc();
+}
+#else
+#    define HASH_COST_UNIT "ns/byte"
+
+static inline uint64_t
+get_hash_cost_counter()
+{
+    return get_nanos();
+}
+#endif
+
+// Hashing cost per byte. Cycles are TSC ticks, so they match core cycles
+// only when the core runs at the nominal frequency.
+static void
+benchmark_hash()
+{
+    printf("\nHash Cost (Vistrutah-512 tree hash, %s)\n", HASH_COST_UNIT);
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    const size_t message_sizes[] = { 64, 1024, 16384, 1024 * 1024 };
+    const char  *size_names[]    = { "64 B", "1 KiB", "16 KiB", "1 MiB" };
+    const int    num_sizes       = 4;
+    const int    NUM_SAMPLES     = 10;
+    const size_t bytes_per_run   = 8 * 1024 * 1024;
+    const int    threads         = 4;
+    const size_t many_count      = 16;
+
+    uint8_t digest[VISTRUTAH_HASH_BYTES * 16];
+
+    for (int sz = 0; sz < num_sizes; sz++) {
+        size_t         msg_size   = message_sizes[sz];
+        size_t         iterations = bytes_per_run / msg_size;
+        uint8_t       *input      = safe_aligned_alloc(64, msg_size * many_count);
+        const uint8_t *inputs[16];
+        size_t         lens[16];
+        double         samples[NUM_SAMPLES];
+        char           label[64];
+
+        init_random_data(input, msg_size * many_count);
+        for (size_t i = 0; i < many_count; i++) {
+            inputs[i] = input + msg_size * i;
+            lens[i]   = msg_size;
+        }
+
+        for (int mode = 0; mode < 4; mode++) {
+#if !(defined(VISTRUTAH_INTEL) && defined(__SHA__))
+            if (mode == 3) {
+                printf("  %-6s SHA-256 baseline not available on this platform\n", size_names[sz]);
+                continue;
+            }
+#endif
+            size_t hashed = msg_size * iterations;
+
+            for (int s = 0; s < NUM_SAMPLES; s++) {
+                uint64_t start = get_hash_cost_counter();
+                if (mode == 0) {
+                    for (size_t iter = 0; iter < iterations; iter++) {
+                        vistrutah_hash(input, msg_size, digest);
+                    }
+                } else if (mode == 1) {
+                    for (size_t iter = 0; iter < iterations; iter++) {
+                        vistrutah_hash_parallel(input, msg_size, digest, threads);
+                    }
+                } else if (mode == 2) {
+                    size_t calls = (iterations + many_count - 1) / many_count;
+
+                    for (size_t iter = 0; iter < calls; iter++) {
+                        vistrutah_hash_many(inputs, lens, many_count, digest);
+                    }
+                    hashed = msg_size * many_count * calls;
+                } else {
+#if defined(VISTRUTAH_INTEL) && defined(__SHA__)
+                    for (size_t iter = 0; iter < iterations; iter++) {
+                        sha256_shani(input, msg_size, digest);
+                    }
+#endif
+                }
+                uint64_t end = get_hash_cost_counter();
+
+                g_benchmark_checksum += digest[0];
+
+                samples[s] = (double) (end - start) / (double) hashed;
+            }
+
+            stats_t stats = get_stats(samples, NUM_SAMPLES);
+
+            snprintf(label, sizeof label, "%-6s %s", size_names[sz],
+                     mode == 0   ? "one-shot"
+                     : mode == 1 ? "4 threads"
+                     : mode == 2 ? "16 messages at once"
+                                 : "SHA-256 (SHA-NI baseline)");
+            printf("  %-40s %7.2f  (min: %6.2f, max: %6.2f)\n", label, stats.median, stats.min,
+                   stats.max);
+        }
+
+        free(input);
+    }
+}
+
+// Short-input latency of the keyless permutation and the sponge XOF. Each
+// call depends on the previous output, so this is latency, not throughput.
+static void
+benchmark_xof_latency()
+{
+    printf("\nPermutation and XOF Latency (32-byte output, chained calls)\n");
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    const int NUM_ITERATIONS = 200000;
+    const int NUM_SAMPLES    = 10;
+
+    static const size_t input_sizes[] = { 32, 64, 128, 256 };
+    static const size_t rates[]       = { 32, 48 };
+
+    uint8_t input[256];
+    uint8_t output[64];
+    double  samples[NUM_SAMPLES];
+    char    label[64];
+
+    init_random_data(input, sizeof input);
+    init_random_data(output, sizeof output);
+
+    for (int mode = 0; mode < 2; mode++) {
+        for (int s = 0; s < NUM_SAMPLES; s++) {
+            uint64_t start = get_nanos();
+            for (int i = 0; i < NUM_ITERATIONS; i++) {
+                if (mode == 0) {
+                    vistrutah_512_permute(output);
+                } else {
+                    vistrutah_512_encrypt(output, output, VISTRUTAH_PERMUTATION_KEY, 64,
+                                          VISTRUTAH_PERMUTATION_ROUNDS);
+                }
+            }
+            uint64_t end = get_nanos();
+
+            g_benchmark_checksum += output[0];
+
+            samples[s] = (double) (end - start) / NUM_ITERATIONS;
+        }
+
+        stats_t stats = get_stats(samples, NUM_SAMPLES);
+
+        printf("  %-40s %6.1f ns/call  (min: %5.1f, max: %5.1f)\n",
+               mode == 0 ? "vistrutah_512_permute" : "vistrutah_512_encrypt (same key)",
+               stats.median, stats.min, stats.max);
+    }
+
+    for (size_t r = 0; r < sizeof rates / sizeof rates[0]; r++) {
+        for (size_t sz = 0; sz < sizeof input_sizes / sizeof input_sizes[0]; sz++) {
+            for (int s = 0; s < NUM_SAMPLES; s++) {
+                uint64_t start = get_nanos();
+                for (int i = 0; i < NUM_ITERATIONS; i++) {
+                    input[0] ^= output[0];
+                    vistrutah_xof(input, input_sizes[sz], output, 32, rates[r]);
+                }
+                uint64_t end = get_nanos();
+
+                g_benchmark_checksum += output[0];
+
+                samples[s] = (double) (end - start) / NUM_ITERATIONS;
+            }
+
+            stats_t stats = get_stats(samples, NUM_SAMPLES);
+
+            snprintf(label, sizeof label, "XOF rate %zu, %zu-byte input", rates[r],
+                     input_sizes[sz]);
+            printf("  %-40s %6.1f ns/call  (min: %5.1f, max: %5.1f)\n", label, stats.median,
+                   stats.min, stats.max);
+        }
+    }
+}
+
+static void
+benchmark_deck()
+{
+    printf("\nDeck Function Throughput (one string absorbed, then squeezed)\n");
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    const size_t sizes[]       = { 64, 1024, 16384, 262144 };
+    const char  *size_names[]  = { "64 B", "1 KiB", "16 KiB", "256 KiB" };
+    const int    num_sizes     = 4;
+    const int    NUM_SAMPLES   = 10;
+    const size_t bytes_per_run = 4 * 1024 * 1024;
+
+    vistrutah_deck_ctx ctx;
+    uint8_t            key[32];
+    uint8_t           *buffer = safe_aligned_alloc(64, sizes[num_sizes - 1]);
+    double             samples[NUM_SAMPLES];
+    char               label[64];
+
+    init_random_data(key, sizeof key);
+    init_random_data(buffer, sizes[num_sizes - 1]);
+
+    for (int mode = 0; mode < 2; mode++) {
+        for (int sz = 0; sz < num_sizes; sz++) {
+            size_t iterations = bytes_per_run / sizes[sz];
+
+            for (int s = 0; s < NUM_SAMPLES; s++) {
+                uint64_t start = get_nanos();
+                for (size_t i = 0; i < iterations; i++) {
+                    vistrutah_deck_init(&ctx, key, sizeof key);
+                    if (mode == 0) {
+                        vistrutah_deck_absorb(&ctx, buffer, sizes[sz]);
+                    } else {
+                        vistrutah_deck_absorb(&ctx, key, sizeof key);
+                        vistrutah_deck_squeeze(&ctx, 0, buffer, sizes[sz]);
+                    }
+                }
+                uint64_t end = get_nanos();
+
+                g_benchmark_checksum += ctx.acc[0] + buffer[0];
+
+                samples[s] = (double) (iterations * sizes[sz]) / ((double) (end - start) / 1e9) /
+                             (1024.0 * 1024.0 * 1024.0);
+            }
+
+            stats_t stats = get_stats(samples, NUM_SAMPLES);
+
+            snprintf(label, sizeof label, "%s %s", mode == 0 ? "Absorb" : "Squeeze",
+                     size_names[sz]);
+            printf("  %-40s %6.3f GB/s  (min: %.3f, max: %.3f)\n", label, stats.median,
+                   stats.min, stats.max);
+        }
+    }
+
+    free(buffer);
+}
+
+#if defined(VISTRUTAH_INTEL) && defined(__AES__)
+// RFC 3394 AES-KW of one 256-bit key: 6 * 4 AES-256 calls
+static void
+aes_kw_wrap_256(const __m128i *rk, const uint8_t *key, uint8_t *out)
+{
+    uint8_t a[8], b[16];
+
+    memset(a, 0xa6, 8);
+    memcpy(out + 8, key, 32);
+    for (int j = 0; j < 6; j++) {
+        for (int i = 1; i <= 4; i++) {
+            uint64_t t = 4 * j + i;
+
+            memcpy(b, a, 8);
+            memcpy(b + 8, out + 8 * i, 8);
+            aes256_encrypt_with_schedule(b, b, rk);
+            for (int k = 0; k < 8; k++) {
+                a[k] = b[k] ^ (uint8_t) (t >> (56 - 8 * k));
+            }
+            memcpy(out + 8 * i, b + 8, 8);
+        }
+    }
+    memcpy(out, a, 8);
+}
+#endif
+
+static void
+benchmark_key_management()
+{
+    printf("\nKey Management (keys per second)\n");
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    const size_t COUNT       = 65536;
+    const int    NUM_SAMPLES = 10;
+
+    vistrutah_kdf_ctx kdf;
+    uint8_t           master[64];
+    uint64_t         *counters = safe_aligned_alloc(64, COUNT * sizeof *counters);
+    uint8_t          *keys     = safe_aligned_alloc(64, COUNT * 64);
+    double            samples[NUM_SAMPLES];
+    char              label[64];
+
+    init_random_data(master, sizeof master);
+    for (size_t i = 0; i < COUNT; i++) {
+        counters[i] = i;
+    }
+    vistrutah_kdf_init(&kdf, master, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY,
+                       (const uint8_t *) "bench", 5);
+
+    for (size_t key_bytes = 32; key_bytes <= 64; key_bytes += 32) {
+        for (int threads = 1; threads <= 4; threads *= 4) {
+            for (int s = 0; s < NUM_SAMPLES; s++) {
+                uint64_t start = get_nanos();
+                vistrutah_kdf_derive_parallel(&kdf, counters, COUNT, keys, key_bytes, threads);
+                uint64_t end = get_nanos();
+
+                g_benchmark_checksum += keys[0];
+
+                samples[s] = COUNT / ((double) (end - start) / 1e9) / 1e6;
+            }
+
+            stats_t stats = get_stats(samples, NUM_SAMPLES);
+
+            snprintf(label, sizeof label, "KDF %zu-bit keys, %d thread%s", key_bytes * 8, threads,
+                     threads > 1 ? "s" : "");
+            printf("  %-40s %6.2f Mkeys/s  (min: %.2f, max: %.2f)\n", label, stats.median,
+                   stats.min, stats.max);
+        }
+    }
+
+    // Wrapping and unwrapping 256-bit keys, one block call each
+    vistrutah_keywrap_ctx kw;
+    uint8_t              *wrapped = safe_aligned_alloc(64, COUNT * VISTRUTAH_KEYWRAP_WRAPPED_BYTES);
+
+    vistrutah_keywrap_init(&kw, master, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+    init_random_data(keys, COUNT * VISTRUTAH_KEYWRAP_KEY_BYTES);
+    vistrutah_keywrap_wrap(&kw, keys, wrapped, COUNT);
+
+    for (int mode = 0; mode < 2; mode++) {
+        for (int s = 0; s < NUM_SAMPLES; s++) {
+            uint64_t start = get_nanos();
+            if (mode == 0) {
+                vistrutah_keywrap_wrap(&kw, keys, wrapped, COUNT);
+            } else {
+                vistrutah_keywrap_unwrap(&kw, wrapped, keys, COUNT, NULL);
+            }
+            uint64_t end = get_nanos();
+
+            g_benchmark_checksum += wrapped[0] + keys[0];
+
+            samples[s] = COUNT / ((double) (end - start) / 1e9) / 1e6;
+        }
+
+        stats_t stats = get_stats(samples, NUM_SAMPLES);
+
+        printf("  %-40s %6.2f Mkeys/s  (min: %.2f, max: %.2f)\n",
+               mode == 0 ? "Key wrap, 256-bit keys" : "Key unwrap, 256-bit keys", stats.median,
+               stats.min, stats.max);
+    }
+
+#if defined(VISTRUTAH_INTEL) && defined(__AES__)
+    __m128i rk[15];
+
+    aes256_key_expansion(master, rk);
+    for (int s = 0; s < NUM_SAMPLES; s++) {
+        uint64_t start = get_nanos();
+        for (size_t i = 0; i < COUNT; i++) {
+            aes_kw_wrap_256(rk, keys + 32 * i, wrapped + 40 * i);
+        }
+        uint64_t end = get_nanos();
+
+        g_benchmark_checksum += wrapped[0];
+
+        samples[s] = COUNT / ((double) (end - start) / 1e9) / 1e6;
+    }
+
+    stats_t stats = get_stats(samples, NUM_SAMPLES);
+
+    printf("  %-40s %6.2f Mkeys/s  (min: %.2f, max: %.2f)\n", "AES-KW wrap (baseline)",
+           stats.median, stats.min, stats.max);
+#endif
+
+    free(counters);
+    free(keys);
+    free(wrapped);
+}
+
+#if defined(VISTRUTAH_INTEL) && defined(__AVX512F__)
+// Strided records fetched with AVX-512 gathers into a staging buffer and
+// written back with scatters, for comparison with the plain strided loads
+static void
+gather_scatter_512(const vistrutah_512_ctx *ctx, const uint8_t *in, size_t in_stride,
+                   uint8_t *out, size_t out_stride, size_t n)
+{
+    uint8_t       buf[8 * 64] __attribute__((aligned(64)));
+    const __m512i lane = _mm512_set_epi64(56, 48, 40, 32, 24, 16, 8, 0);
+
+    for (size_t i = 0; i < n;) {
+        size_t batch = n - i < 8 ? n - i : 8;
+
+        for (size_t j = 0; j < batch; j++) {
+            __m512i idx = _mm512_add_epi64(lane, _mm512_set1_epi64((i + j) * in_stride));
+
+            _mm512_store_si512(buf + 64 * j, _mm512_i64gather_epi64(idx, in, 1));
+        }
+        vistrutah_512_encrypt_blocks(buf, buf, batch, ctx->key, ctx->key_size, ctx->rounds);
+        for (size_t j = 0; j < batch; j++) {
+            __m512i idx = _mm512_add_epi64(lane, _mm512_set1_epi64((i + j) * out_stride));
+
+            _mm512_i64scatter_epi64(out, idx, _mm512_load_si512(buf + 64 * j), 1);
+        }
+        i += batch;
+    }
+}
+#endif
+
+static void
+benchmark_strided()
+{
+    printf("\nStrided Records (4096 records, row stride in bytes)\n");
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    const size_t COUNT         = 4096;
+    const int    NUM_ITERATIONS= 50;
+    const int    NUM_SAMPLES   = 10;
+
+    static const size_t strides[] = { 64, 96, 256 };
+
+    vistrutah_256_ctx ctx256;
+    vistrutah_512_ctx ctx512;
+    uint8_t           key[64];
+    uint8_t          *rows = safe_aligned_alloc(64, COUNT * 256);
+    double            samples[NUM_SAMPLES];
+    char              label[64];
+
+    init_random_data(key, sizeof key);
+    init_random_data(rows, COUNT * 256);
+    vistrutah_256_init(&ctx256, key, 32, VISTRUTAH_256_ROUNDS_LONG);
+    vistrutah_512_init(&ctx512, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+
+    for (size_t st = 0; st < sizeof strides / sizeof strides[0]; st++) {
+        size_t stride = strides[st];
+
+        for (int mode = 0; mode < 3; mode++) {
+            size_t bs = mode == 0 ? 32 : 64;
+
+#if !(defined(VISTRUTAH_INTEL) && defined(__AVX512F__))
+            if (mode == 2) {
+                continue;
+            }
+#endif
+            for (int s = 0; s < NUM_SAMPLES; s++) {
+                uint64_t start = get_nanos();
+                for (int it = 0; it < NUM_ITERATIONS; it++) {
+                    if (mode == 0) {
+                        vistrutah_256_encrypt_strided(&ctx256, rows, stride, rows, stride, COUNT);
+                    } else if (mode == 1) {
+                        vistrutah_512_encrypt_strided(&ctx512, rows, stride, rows, stride, COUNT);
+                    }
+#if defined(VISTRUTAH_INTEL) && defined(__AVX512F__)
+                    else {
+                        gather_scatter_512(&ctx512, rows, stride, rows, stride, COUNT);
+                    }
+#endif
+                }
+                uint64_t end = get_nanos();
+
+                g_benchmark_checksum += rows[0];
+
+                double elapsed = (end - start) / 1e9;
+
+                samples[s] = (COUNT * bs * NUM_ITERATIONS/ (1024.0 * 1024.0)) / elapsed;
+            }
+
+            stats_t            stats   = get_stats(samples, NUM_SAMPLES);
+            static const char *names[] = { "Vistrutah-256 strided", "Vistrutah-512 strided",
+                                           "Vistrutah-512 gather/scatter" };
+
+            snprintf(label, sizeof label, "%s, stride %zu", names[mode], stride);
+            printf("  %-40s %7.1f MB/s  (min: %6.1f, max: %6.1f)\n", label, stats.median,
+                   stats.min, stats.max);
+        }
+    }
+
+    free(rows);
+}
+
+static void
+benchmark_pointer_arrays()
+{
+    printf("\nScattered Entries (64 MiB pool, random slots)\n");
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    const size_t POOL_SLOTS  = 1024 * 1024;
+    const size_t COUNT       = 65536;
+    const int    NUM_SAMPLES = 10;
+
+    vistrutah_256_ctx ctx256;
+    vistrutah_512_ctx ctx512;
+    uint8_t           key[64];
+    uint8_t          *pool = safe_aligned_alloc(64, POOL_SLOTS * 64);
+    const uint8_t   **in   = malloc(COUNT * sizeof *in);
+    uint8_t         **out  = malloc(COUNT * sizeof *out);
+    double            samples[NUM_SAMPLES];
+
+    init_random_data(key, sizeof key);
+    init_random_data(pool, POOL_SLOTS * 64);
+    vistrutah_256_init(&ctx256, key, 32, VISTRUTAH_256_ROUNDS_LONG);
+    vistrutah_512_init(&ctx512, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+
+    for (int mode = 0; mode < 4; mode++) {
+        for (int s = 0; s < NUM_SAMPLES; s++) {
+            // Fresh random slots each sample, so the entries are not cached
+            for (size_t i = 0; i < COUNT; i++) {
+                size_t slot = ((size_t) rand() << 16 ^ (size_t) rand()) % POOL_SLOTS;
+
+                in[i]  = pool + 64 * slot;
+                out[i] = pool + 64 * slot;
+            }
+
+            uint64_t start = get_nanos();
+            switch (mode) {
+            case 0:
+                for (size_t i = 0; i < COUNT; i++) {
+                    vistrutah_256_encrypt(in[i], out[i], key, 32, VISTRUTAH_256_ROUNDS_LONG);
+                }
+                break;
+            case 1:
+                vistrutah_256_encrypt_ptrs(&ctx256, NULL, in, out, COUNT);
+                break;
+            case 2:
+                for (size_t i = 0; i < COUNT; i++) {
+                    vistrutah_512_encrypt(in[i], out[i], key, 64,
+                                          VISTRUTAH_512_ROUNDS_LONG_512KEY);
+                }
+                break;
+            default:
+                vistrutah_512_encrypt_ptrs(&ctx512, NULL, in, out, COUNT);
+                break;
+            }
+            uint64_t end = get_nanos();
+
+            g_benchmark_checksum += pool[0];
+
+            samples[s] = (double) (end - start) / COUNT;
+        }
+
+        stats_t            stats   = get_stats(samples, NUM_SAMPLES);
+        static const char *names[] = { "Vistrutah-256, one call per entry",
+                                       "Vistrutah-256, pointer array",
+                                       "Vistrutah-512, one call per entry",
+                                       "Vistrutah-512, pointer array" };
+
+        printf("  %-40s %6.1f ns/entry  (min: %5.1f, max: %5.1f)\n", names[mode], stats.median,
+               stats.min, stats.max);
+    }
+
+    free(pool);
+    free(in);
+    free(out);
+}
+
+static void
+benchmark_range_reads()
+{
+    printf("\nCTR Range Reads (4 KiB at random offsets in a 1 GiB mmapped object)\n");
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    const size_t OBJECT_SIZE = (size_t) 1 << 30;
+    const size_t RANGE_SIZE  = 4096;
+    const int    NUM_READS   = 20000;
+
+    vistrutah_ctr_ctx ctx;
+    uint8_t           key[64];
+    uint8_t           nonce[VISTRUTAH_CTR_NONCE_BYTES];
+    uint8_t          *range   = safe_aligned_alloc(64, RANGE_SIZE);
+    double           *samples = malloc(NUM_READS * sizeof *samples);
+    FILE             *file    = tmpfile();
+
+    if (file == NULL || ftruncate(fileno(file), (off_t) OBJECT_SIZE) != 0) {
+        printf("  (could not create the object file)\n");
+        free(range);
+        free(samples);
+        return;
+    }
+
+    const uint8_t *object = mmap(NULL, OBJECT_SIZE, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+
+    if (object == MAP_FAILED) {
+        printf("  (could not map the object file)\n");
+        fclose(file);
+        free(range);
+        free(samples);
+        return;
+    }
+
+    init_random_data(key, sizeof key);
+    init_random_data(nonce, sizeof nonce);
+    vistrutah_ctr_init(&ctx, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY, nonce);
+
+    for (int aligned = 1; aligned >= 0; aligned--) {
+        for (int i = 0; i < NUM_READS; i++) {
+            uint64_t offset = ((uint64_t) rand() << 16 ^ (uint64_t) rand()) %
+                              (OBJECT_SIZE - RANGE_SIZE);
+
+            if (aligned) {
+                offset &= ~(uint64_t) (RANGE_SIZE - 1);
+            }
+
+            uint64_t start = get_nanos();
+            vistrutah_ctr_xor(&ctx, offset, object + offset, range, RANGE_SIZE);
+            uint64_t end = get_nanos();
+
+            g_benchmark_checksum += range[0];
+
+            samples[i] = (double) (end - start) / 1000.0;
+        }
+
+        qsort(samples, NUM_READS, sizeof *samples, compare_double);
+        printf("  %-40s p50 %6.2f us  p99 %6.2f us  (max: %.2f)\n",
+               aligned ? "4 KiB range, page-aligned" : "4 KiB range, any byte offset",
+               samples[NUM_READS / 2], samples[NUM_READS * 99 / 100], samples[NUM_READS - 1]);
+    }
+
+    // A large range, split across threads
+    const size_t LARGE = 64 * 1024 * 1024;
+    uint8_t     *large = safe_aligned_alloc(64, LARGE);
+
+    vistrutah_ctr_xor(&ctx, 12345, object + 12345, large, LARGE);
+    for (int threads = 1; threads <= 4; threads *= 4) {
+        uint64_t start = get_nanos();
+        vistrutah_ctr_xor_parallel(&ctx, 12345, object + 12345, large, LARGE, threads);
+        uint64_t end = get_nanos();
+
+        g_benchmark_checksum += large[0];
+
+        char label[64];
+
+        snprintf(label, sizeof label, "64 MiB range, %d thread%s", threads, threads > 1 ? "s" : "");
+        printf("  %-40s %7.1f MB/s\n", label,
+               (LARGE / (1024.0 * 1024.0)) / ((double) (end - start) / 1e9));
+    }
+
+    free(large);
+    munmap((void *) object, OBJECT_SIZE);
+    fclose(file);
+    free(range);
+    free(samples);
+}
+
+static void
+benchmark_reencrypt()
+{
+    printf("\nKey Rotation (128 MiB buffer, in place)\n");
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    const size_t SIZE        = 128 * 1024 * 1024;
+    const size_t BLOCKS      = SIZE / 64;
+    const int    NUM_SAMPLES = 5;
+
+    vistrutah_512_ctx old_key, new_key;
+    vistrutah_ctr_ctx old_ctr, new_ctr;
+    uint8_t           key_a[64], key_b[64], nonce[VISTRUTAH_CTR_NONCE_BYTES];
+    uint8_t          *data = safe_aligned_alloc(64, SIZE);
+    double            samples[NUM_SAMPLES];
+
+    static const char *names[] = { "Blocks, decrypt pass + encrypt pass", "Blocks, fused",
+                                   "CTR, decrypt pass + encrypt pass", "CTR, fused" };
+
+    init_random_data(key_a, sizeof key_a);
+    init_random_data(key_b, sizeof key_b);
+    init_random_data(nonce, sizeof nonce);
+    init_random_data(data, SIZE);
+    vistrutah_512_init(&old_key, key_a, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+    vistrutah_512_init(&new_key, key_b, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+    vistrutah_ctr_init(&old_ctr, key_a, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY, nonce);
+    vistrutah_ctr_init(&new_ctr, key_b, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY, nonce);
+
+    for (int mode = 0; mode < 4; mode++) {
+        for (int s = 0; s < NUM_SAMPLES; s++) {
+            uint64_t start = get_nanos();
+            switch (mode) {
+            case 0:
+                vistrutah_512_decrypt_blocks(data, data, BLOCKS, key_a, 64,
+                                             VISTRUTAH_512_ROUNDS_LONG_512KEY);
+                vistrutah_512_encrypt_blocks(data, data, BLOCKS, key_b, 64,
+                                             VISTRUTAH_512_ROUNDS_LONG_512KEY);
+                break;
+            case 1:
+                vistrutah_512_reencrypt_blocks(&old_key, &new_key, data, data, BLOCKS);
+                break;
+            case 2:
+                vistrutah_ctr_xor(&old_ctr, 0, data, data, SIZE);
+                vistrutah_ctr_xor(&new_ctr, 0, data, data, SIZE);
+                break;
+            default:
+                vistrutah_ctr_reencrypt(&old_ctr, &new_ctr, 0, data, data, SIZE);
+                break;
+            }
+            uint64_t end = get_nanos();
+
+            g_benchmark_checksum += data[0];
+
+            samples[s] = (SIZE / (1024.0 * 1024.0)) / ((double) (end - start) / 1e9);
+        }
+
+        stats_t stats = get_stats(samples, NUM_SAMPLES);
+
+        printf("  %-40s %7.1f MB/s  (min: %6.1f, max: %6.1f)\n", names[mode], stats.median,
+               stats.min, stats.max);
+    }
+
+    free(data);
+}
+
+static void
+benchmark_crc32c()
+{
+    printf("\nEncryption with CRC32C (64 MiB buffer)\n");
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    const size_t SIZE        = 64 * 1024 * 1024;
+    const size_t BLOCKS      = SIZE / 64;
+    const int    NUM_SAMPLES = 5;
+
+    vistrutah_512_ctx ctx;
+    uint8_t           key[64];
+    uint8_t          *in  = safe_aligned_alloc(64, SIZE);
+    uint8_t          *out = safe_aligned_alloc(64, SIZE);
+    double            samples[NUM_SAMPLES];
+
+    static const char *names[] = { "Encrypt only", "CRC32C only", "Encrypt + separate CRC32C",
+                                   "Encrypt, fused CRC32C of ciphertext",
+                                   "Encrypt, fused CRC32C of both" };
+
+    init_random_data(key, sizeof key);
+    init_random_data(in, SIZE);
+    vistrutah_512_init(&ctx, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+
+    for (int mode = 0; mode < 5; mode++) {
+        for (int s = 0; s < NUM_SAMPLES; s++) {
+            uint32_t crc_pt = 0, crc_ct = 0;
+            uint64_t start  = get_nanos();
+            switch (mode) {
+            case 0:
+                vistrutah_512_encrypt_blocks(in, out, BLOCKS, key, 64,
+                                             VISTRUTAH_512_ROUNDS_LONG_512KEY);
+                break;
+            case 1:
+                crc_ct = vistrutah_crc32c(0, in, SIZE);
+                break;
+            case 2:
+                vistrutah_512_encrypt_blocks(in, out, BLOCKS, key, 64,
+                                             VISTRUTAH_512_ROUNDS_LONG_512KEY);
+                crc_ct = vistrutah_crc32c(0, out, SIZE);
+                break;
+            case 3:
+                vistrutah_512_encrypt_blocks_crc32c(&ctx, in, out, BLOCKS, NULL, &crc_ct);
+                break;
+            default:
+                vistrutah_512_encrypt_blocks_crc32c(&ctx, in, out, BLOCKS, &crc_pt, &crc_ct);
+                break;
+            }
+            uint64_t end = get_nanos();
+
+            g_benchmark_checksum += out[0] + crc_pt + crc_ct;
+
+            samples[s] = (SIZE / (1024.0 * 1024.0)) / ((double) (end - start) / 1e9);
+        }
+
+        stats_t stats = get_stats(samples, NUM_SAMPLES);
+
+        printf("  %-40s %7.1f MB/s  (min: %6.1f, max: %6.1f)\n", names[mode], stats.median,
+               stats.min, stats.max);
+    }
+
+    free(in);
+    free(out);
+}
+
+static void
+benchmark_streaming_stores()
+{
+    printf("\nStreaming vs Cached Stores (Vistrutah-256, 10 rounds, buffer-size sweep)\n");
+    printf("════════════════════════════════════════════════════════════════\n");
+
+    static const size_t sizes[]      = { 256 << 10, 1 << 20, 4 << 20, 16 << 20, 64 << 20,
+                                         256 << 20 };
+    static const char  *size_names[] = { "256 KiB", "1 MiB", "4 MiB", "16 MiB", "64 MiB",
+                                         "256 MiB" };
+    const size_t        TOTAL        = 256 << 20;
+    const int           NUM_SAMPLES  = 3;
+
+    vistrutah_256_ctx ctx;
+    uint8_t           key[32];
+    uint8_t          *in  = safe_aligned_alloc(64, TOTAL);
+    uint8_t          *out = safe_aligned_alloc(64, TOTAL);
+    double            samples[NUM_SAMPLES];
+    char              label[64];
+
+    init_random_data(key, sizeof key);
+    init_random_data(in, TOTAL);
+    memset(out, 0, TOTAL);
+    vistrutah_256_init(&ctx, key, 32, VISTRUTAH_256_ROUNDS_SHORT);
+
+    for (size_t sz = 0; sz < sizeof sizes / sizeof sizes[0]; sz++) {
+        size_t size       = sizes[sz];
+        size_t iterations = TOTAL / size;
+
+        for (int mode = 0; mode < 2; mode++) {
+            for (int s = 0; s < NUM_SAMPLES; s++) {
+                uint64_t start = get_nanos();
+                for (size_t it = 0; it < iterations; it++) {
+                    if (mode == 0) {
+                        vistrutah_256_encrypt_blocks(in, out, size / 32, key, 32,
+                                                     VISTRUTAH_256_ROUNDS_SHORT);
+                    } else {
+                        vistrutah_256_encrypt_blocks_stream(&ctx, in, out, size / 32);
+                    }
+                }
+                uint64_t end = get_nanos();
+
+                g_benchmark_checksum += out[0];
+
+                samples[s] = (TOTAL / (1024.0 * 1024.0)) / ((double) (end - start) / 1e9);
+            }
+
+            stats_t stats = get_stats(samples, NUM_SAMPLES);
+
+            snprintf(label, sizeof label, "%s, %s stores", size_names[sz],
+                     mode == 0 ? "cached" : "streaming");
+            printf("  %-40s %7.1f MB/s  (min: %6.1f, max: %6.1f)\n", label, stats.median,
+                   stats.min, stats.max);
+        }
+    }
+
+    free(in);
+    free(out);
+}
+
 int
 main()
 {
@@ -1020,6 +2398,28 @@ main()
     // Small Message Benchmarks
     // ========================================================================
     benchmark_small_messages();
+    benchmark_job_manager();
+    benchmark_offload();
+
+    // ========================================================================
+    // Authenticated Encryption Benchmarks
+    // ========================================================================
+    benchmark_aead();
+
+    // ========================================================================
+    // Hashing Benchmarks
+    // ========================================================================
+    benchmark_hash();
+    benchmark_xof_latency();
+    benchmark_deck();
+    benchmark_key_management();
+    benchmark_strided();
+    benchmark_pointer_arrays();
+    benchmark_range_reads();
+    benchmark_reencrypt();
+    benchmark_crc32c();
+    benchmark_streaming_stores();
+    benchmark_autotune();
 
     printf("\n");
     printf("═══════════════════════════════════════════════════════════════\n");
@@ -1028,5 +2428,13 @@ main()
     printf("\nNote: All measurements show median over 10 runs.\n");
     printf("      Min/max values indicate measurement stability.\n");
 
+#ifdef VISTRUTAH_STATS
+    vistrutah_stats stats;
+
+    printf("\nPer-entry-point statistics of this run:\n");
+    vistrutah_stats_snapshot(&stats);
+    vistrutah_stats_write_json(&stats, stdout);
+#endif
+
     return 0;
 }
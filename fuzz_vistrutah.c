@@ -0,0 +1,536 @@
+#define _POSIX_C_SOURCE 200809L
+#define VISTRUTAH_INTERNAL
+#include "vistrutah.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Differential fuzzing harness. Each input is decoded into a variant, keys,
+// a round count, a message and a buffer layout. The message then goes
+// through every native path (single block, multi-block at every kernel
+// width, in place, strided, pointer arrays, streaming stores, CRC32C,
+// re-encryption and the job manager), and each result is compared with
+// vistrutah_portable.c. The Makefile links the portable code in under a
+// ref_ prefix. Any difference, or a failed round trip, aborts.
+//
+// The same file builds three ways:
+// - as a libFuzzer target (-DFUZZ_LIBFUZZER -fsanitize=fuzzer)
+// - for AFL, with inputs passed as file arguments:
+//   afl-fuzz -i corpus -o findings -- ./fuzz_vistrutah @@
+// - as a standalone random fuzzer: ./fuzz_vistrutah [-seconds N] [-seed N]
+//
+// Input layout: flags, rounds, blocks, input offset, output offset, input
+// stride padding, output stride padding, layout seed, then two 64-byte keys
+// and the message. Missing bytes read as zero.
+
+#define FUZZ_MAX_BLOCKS 40
+
+void ref_256_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8_t* key,
+                     int key_size, int rounds);
+void ref_256_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key,
+                     int key_size, int rounds);
+void ref_512_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8_t* key,
+                     int key_size, int rounds);
+void ref_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key,
+                     int key_size, int rounds);
+
+typedef void (*block_fn)(const uint8_t*, uint8_t*, const uint8_t*, int, int);
+typedef void (*blocks_fn)(const uint8_t*, uint8_t*, size_t, const uint8_t*, int, int);
+
+typedef struct {
+    int               bits;
+    size_t            bs;
+    int               max_rounds;
+    int               key_sizes[2];
+    block_fn          ref_encrypt, ref_decrypt;
+    block_fn          encrypt, decrypt;
+    blocks_fn         encrypt_blocks, decrypt_blocks;
+    vistrutah_variant encrypt_variant, decrypt_variant;
+} variant;
+
+static const variant variants[2] = {
+    { 256, 32, VISTRUTAH_256_ROUNDS_LONG, { 16, 32 }, ref_256_encrypt, ref_256_decrypt,
+      vistrutah_256_encrypt, vistrutah_256_decrypt, vistrutah_256_encrypt_blocks,
+      vistrutah_256_decrypt_blocks, VISTRUTAH_256_ENCRYPT, VISTRUTAH_256_DECRYPT },
+    { 512, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY, { 32, 64 }, ref_512_encrypt, ref_512_decrypt,
+      vistrutah_512_encrypt, vistrutah_512_decrypt, vistrutah_512_encrypt_blocks,
+      vistrutah_512_decrypt_blocks, VISTRUTAH_512_ENCRYPT, VISTRUTAH_512_DECRYPT },
+};
+
+typedef struct {
+    const variant* v;
+    uint8_t        key[64];
+    uint8_t        key2[64];
+    int            key_size;
+    int            rounds;
+    size_t         blocks;
+    size_t         in_offset;
+    size_t         out_offset;
+    size_t         in_stride;
+    size_t         out_stride;
+    uint32_t       seed;
+    uint8_t*       plain;     // the message
+    uint8_t*       expected;  // reference encryption under key
+    uint8_t*       expected2; // reference encryption under key2
+} fuzz_case;
+
+// Current input of the standalone driver, saved when a check fails
+static const uint8_t* current_input;
+static size_t         current_size;
+
+static void
+check(int ok, const fuzz_case* c, const char* path)
+{
+    if (ok) {
+        return;
+    }
+    fprintf(stderr, "MISMATCH in %s: Vistrutah-%d, %s, key %d bytes, %d rounds, %zu blocks\n",
+            path, c->v->bits, vistrutah_get_impl_name(), c->key_size, c->rounds, c->blocks);
+    if (current_input != NULL) {
+        FILE* f = fopen("fuzz-crash.bin", "wb");
+
+        if (f != NULL) {
+            fwrite(current_input, 1, current_size, f);
+            fclose(f);
+            fprintf(stderr, "Input written to fuzz-crash.bin\n");
+        }
+    }
+    abort();
+}
+
+static uint32_t
+next_random(uint32_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// Buffers are allocated at their exact size, so that sanitizers catch any
+// access past the end
+static uint8_t*
+alloc_at(size_t offset, size_t len)
+{
+    uint8_t* p = malloc(offset + len ? offset + len : 1);
+
+    if (p == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        abort();
+    }
+    return p + offset;
+}
+
+static void
+free_at(uint8_t* p, size_t offset)
+{
+    free(p - offset);
+}
+
+static uint32_t
+crc32c_bitwise(uint32_t crc, const uint8_t* data, size_t len)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++) {
+            crc = crc >> 1 ^ (0x82f63b78 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static void
+check_single(const fuzz_case* c)
+{
+    const variant* v = c->v;
+    uint8_t        out[64], back[64];
+
+    for (size_t i = 0; i < c->blocks; i++) {
+        v->encrypt(c->plain + v->bs * i, out, c->key, c->key_size, c->rounds);
+        check(memcmp(out, c->expected + v->bs * i, v->bs) == 0, c, "single-block encrypt");
+        v->decrypt(out, back, c->key, c->key_size, c->rounds);
+        check(memcmp(back, c->plain + v->bs * i, v->bs) == 0, c, "single-block decrypt");
+        v->ref_decrypt(out, back, c->key, c->key_size, c->rounds);
+        check(memcmp(back, c->plain + v->bs * i, v->bs) == 0, c, "reference decrypt");
+    }
+}
+
+static void
+check_blocks(const fuzz_case* c)
+{
+    const variant* v   = c->v;
+    size_t         len = v->bs * c->blocks;
+    uint8_t*       in  = alloc_at(c->in_offset, len);
+    uint8_t*       out = alloc_at(c->out_offset, len);
+
+    memcpy(in, c->plain, len);
+    v->encrypt_blocks(in, out, c->blocks, c->key, c->key_size, c->rounds);
+    check(memcmp(out, c->expected, len) == 0, c, "multi-block encrypt");
+    v->decrypt_blocks(out, in, c->blocks, c->key, c->key_size, c->rounds);
+    check(memcmp(in, c->plain, len) == 0, c, "multi-block decrypt");
+
+    v->encrypt_blocks(in, in, c->blocks, c->key, c->key_size, c->rounds);
+    check(memcmp(in, c->expected, len) == 0, c, "in-place multi-block encrypt");
+    v->decrypt_blocks(in, in, c->blocks, c->key, c->key_size, c->rounds);
+    check(memcmp(in, c->plain, len) == 0, c, "in-place multi-block decrypt");
+
+    free_at(in, c->in_offset);
+    free_at(out, c->out_offset);
+}
+
+// Context-based paths. The 256 and 512 APIs have distinct context types,
+// so each gets its own function, with the same checks.
+
+static void
+check_ctx_256(const fuzz_case* c)
+{
+    vistrutah_256_ctx        ctx[2];
+    const vistrutah_256_ctx* ctxs[FUZZ_MAX_BLOCKS];
+    const uint8_t*           ins[FUZZ_MAX_BLOCKS];
+    uint8_t*                 outs[FUZZ_MAX_BLOCKS];
+    size_t                   n    = c->blocks;
+    uint8_t*                 sin  = alloc_at(c->in_offset, c->in_stride * n);
+    uint8_t*                 sout = alloc_at(c->out_offset, c->out_stride * n);
+    uint8_t*                 out  = alloc_at(c->out_offset, 32 * n);
+    uint32_t                 state = c->seed * 0x9e3779b9u | 1;
+    uint32_t                 crc_in, crc_out;
+
+    vistrutah_256_init(&ctx[0], c->key, c->key_size, c->rounds);
+    vistrutah_256_init(&ctx[1], c->key2, c->key_size, c->rounds);
+
+    memset(sin, 0xa5, c->in_stride * n);
+    for (size_t i = 0; i < n; i++) {
+        memcpy(sin + c->in_stride * i, c->plain + 32 * i, 32);
+    }
+    vistrutah_256_encrypt_strided(&ctx[0], sin, c->in_stride, sout, c->out_stride, n);
+    for (size_t i = 0; i < n; i++) {
+        check(memcmp(sout + c->out_stride * i, c->expected + 32 * i, 32) == 0, c,
+              "strided encrypt");
+    }
+    vistrutah_256_decrypt_strided(&ctx[0], sout, c->out_stride, sin, c->in_stride, n);
+    for (size_t i = 0; i < n; i++) {
+        check(memcmp(sin + c->in_stride * i, c->plain + 32 * i, 32) == 0, c, "strided decrypt");
+    }
+
+    // Records in a shuffled order, each under one of the two keys
+    for (size_t i = 0; i < n; i++) {
+        size_t j = next_random(&state) % (i + 1);
+
+        ins[i]  = ins[j];
+        outs[i] = outs[j];
+        ins[j]  = c->plain + 32 * i;
+        outs[j] = out + 32 * i;
+    }
+    for (size_t i = 0; i < n; i++) {
+        ctxs[i] = &ctx[next_random(&state) & 1];
+    }
+    vistrutah_256_encrypt_ptrs(NULL, ctxs, ins, outs, n);
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t* want = ctxs[i] == &ctx[0] ? c->expected : c->expected2;
+        size_t         k    = (size_t) (ins[i] - c->plain) / 32;
+
+        check(memcmp(outs[i], want + 32 * k, 32) == 0, c, "pointer-array encrypt");
+    }
+    vistrutah_256_encrypt_ptrs(&ctx[1], NULL, ins, outs, n);
+    vistrutah_256_decrypt_ptrs(&ctx[1], NULL, (const uint8_t* const*) outs, outs, n);
+    check(n == 0 || memcmp(out, c->plain, 32 * n) == 0, c, "pointer-array round trip");
+
+    vistrutah_256_encrypt_blocks_stream(&ctx[0], c->plain, out, n);
+    check(memcmp(out, c->expected, 32 * n) == 0, c, "streaming encrypt");
+    vistrutah_256_decrypt_blocks_stream(&ctx[0], out, out, n);
+    check(memcmp(out, c->plain, 32 * n) == 0, c, "streaming decrypt");
+
+    crc_in  = 0;
+    crc_out = 0;
+    vistrutah_256_encrypt_blocks_crc32c(&ctx[0], c->plain, out, n, &crc_in, &crc_out);
+    check(memcmp(out, c->expected, 32 * n) == 0, c, "CRC32C encrypt");
+    check(crc_in == crc32c_bitwise(0, c->plain, 32 * n), c, "CRC32C of the input");
+    check(crc_out == crc32c_bitwise(0, c->expected, 32 * n), c, "CRC32C of the output");
+    crc_out = 0;
+    vistrutah_256_decrypt_blocks_crc32c(&ctx[0], out, out, n, NULL, &crc_out);
+    check(memcmp(out, c->plain, 32 * n) == 0, c, "CRC32C decrypt");
+    check(crc_out == crc_in, c, "CRC32C after decryption");
+
+    free_at(sin, c->in_offset);
+    free_at(sout, c->out_offset);
+    free_at(out, c->out_offset);
+}
+
+static void
+check_ctx_512(const fuzz_case* c)
+{
+    vistrutah_512_ctx        ctx[2];
+    const vistrutah_512_ctx* ctxs[FUZZ_MAX_BLOCKS];
+    const uint8_t*           ins[FUZZ_MAX_BLOCKS];
+    uint8_t*                 outs[FUZZ_MAX_BLOCKS];
+    vistrutah_mb_job         jobs[FUZZ_MAX_BLOCKS];
+    vistrutah_mb_mgr         mgr;
+    size_t                   n    = c->blocks;
+    uint8_t*                 sin  = alloc_at(c->in_offset, c->in_stride * n);
+    uint8_t*                 sout = alloc_at(c->out_offset, c->out_stride * n);
+    uint8_t*                 out  = alloc_at(c->out_offset, 64 * n);
+    uint32_t                 state = c->seed * 0x9e3779b9u | 1;
+    uint32_t                 crc_in, crc_out;
+    size_t                   njobs = 0;
+
+    vistrutah_512_init(&ctx[0], c->key, c->key_size, c->rounds);
+    vistrutah_512_init(&ctx[1], c->key2, c->key_size, c->rounds);
+
+    memset(sin, 0xa5, c->in_stride * n);
+    for (size_t i = 0; i < n; i++) {
+        memcpy(sin + c->in_stride * i, c->plain + 64 * i, 64);
+    }
+    vistrutah_512_encrypt_strided(&ctx[0], sin, c->in_stride, sout, c->out_stride, n);
+    for (size_t i = 0; i < n; i++) {
+        check(memcmp(sout + c->out_stride * i, c->expected + 64 * i, 64) == 0, c,
+              "strided encrypt");
+    }
+    vistrutah_512_decrypt_strided(&ctx[0], sout, c->out_stride, sin, c->in_stride, n);
+    for (size_t i = 0; i < n; i++) {
+        check(memcmp(sin + c->in_stride * i, c->plain + 64 * i, 64) == 0, c, "strided decrypt");
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        size_t j = next_random(&state) % (i + 1);
+
+        ins[i]  = ins[j];
+        outs[i] = outs[j];
+        ins[j]  = c->plain + 64 * i;
+        outs[j] = out + 64 * i;
+    }
+    for (size_t i = 0; i < n; i++) {
+        ctxs[i] = &ctx[next_random(&state) & 1];
+    }
+    vistrutah_512_encrypt_ptrs(NULL, ctxs, ins, outs, n);
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t* want = ctxs[i] == &ctx[0] ? c->expected : c->expected2;
+        size_t         k    = (size_t) (ins[i] - c->plain) / 64;
+
+        check(memcmp(outs[i], want + 64 * k, 64) == 0, c, "pointer-array encrypt");
+    }
+    vistrutah_512_encrypt_ptrs(&ctx[1], NULL, ins, outs, n);
+    vistrutah_512_decrypt_ptrs(&ctx[1], NULL, (const uint8_t* const*) outs, outs, n);
+    check(n == 0 || memcmp(out, c->plain, 64 * n) == 0, c, "pointer-array round trip");
+
+    vistrutah_512_encrypt_blocks_stream(&ctx[0], c->plain, out, n);
+    check(memcmp(out, c->expected, 64 * n) == 0, c, "streaming encrypt");
+    vistrutah_512_decrypt_blocks_stream(&ctx[0], out, out, n);
+    check(memcmp(out, c->plain, 64 * n) == 0, c, "streaming decrypt");
+
+    crc_in  = 0;
+    crc_out = 0;
+    vistrutah_512_encrypt_blocks_crc32c(&ctx[0], c->plain, out, n, &crc_in, &crc_out);
+    check(memcmp(out, c->expected, 64 * n) == 0, c, "CRC32C encrypt");
+    check(crc_in == crc32c_bitwise(0, c->plain, 64 * n), c, "CRC32C of the input");
+    check(crc_out == crc32c_bitwise(0, c->expected, 64 * n), c, "CRC32C of the output");
+    crc_out = 0;
+    vistrutah_512_decrypt_blocks_crc32c(&ctx[0], out, out, n, NULL, &crc_out);
+    check(memcmp(out, c->plain, 64 * n) == 0, c, "CRC32C decrypt");
+    check(crc_out == crc_in, c, "CRC32C after decryption");
+
+    // Re-encryption from key to key2
+    vistrutah_512_reencrypt_blocks(&ctx[0], &ctx[1], c->expected, out, n);
+    check(memcmp(out, c->expected2, 64 * n) == 0, c, "re-encryption");
+
+    // The message split into jobs of random length and key, decrypting the
+    // blocks that were encrypted under key2
+    vistrutah_mb_init(&mgr, 1 + next_random(&state) % 8, 1 + next_random(&state) % 32);
+    for (size_t i = 0; i < n;) {
+        size_t            len = 1 + next_random(&state) % (n - i < 5 ? n - i : 5);
+        vistrutah_mb_job* job = &jobs[njobs++];
+        int               dec = (int) (next_random(&state) & 1);
+
+        job->ctx     = &ctx[dec];
+        job->decrypt = dec;
+        job->in      = (dec ? c->expected2 : c->plain) + 64 * i;
+        job->out     = out + 64 * i;
+        job->blocks  = len;
+        check(vistrutah_mb_submit(&mgr, job) == 0, c, "job submission");
+        i += len;
+    }
+    vistrutah_mb_flush(&mgr);
+    for (size_t j = 0; j < njobs; j++) {
+        vistrutah_mb_job* job  = vistrutah_mb_get_completed(&mgr);
+        size_t            i    = job != NULL ? (size_t) (job->out - out) / 64 : 0;
+        const uint8_t*    want = job != NULL && job->decrypt ? c->plain : c->expected;
+
+        check(job == &jobs[j], c, "job completion order");
+        check(memcmp(job->out, want + 64 * i, 64 * job->blocks) == 0, c, "job manager");
+    }
+
+    free_at(sin, c->in_offset);
+    free_at(sout, c->out_offset);
+    free_at(out, c->out_offset);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+int
+LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    uint8_t   header[8] = { 0 };
+    fuzz_case c;
+    size_t    pos = 0;
+
+    memset(&c, 0, sizeof c);
+    for (size_t i = 0; i < sizeof header && pos < size; i++) {
+        header[i] = data[pos++];
+    }
+    for (size_t i = 0; i < 64 && pos < size; i++) {
+        c.key[i] = data[pos++];
+    }
+    for (size_t i = 0; i < 64 && pos < size; i++) {
+        c.key2[i] = data[pos++];
+    }
+
+    c.v          = &variants[header[0] & 1];
+    c.key_size   = c.v->key_sizes[header[0] >> 1 & 1];
+    c.rounds     = ROUNDS_PER_STEP * (1 + header[1] % (c.v->max_rounds / ROUNDS_PER_STEP));
+    c.blocks     = header[2] % (FUZZ_MAX_BLOCKS + 1);
+    c.in_offset  = header[3] % 64;
+    c.out_offset = header[4] % 64;
+    c.in_stride  = c.v->bs + header[5] % 64;
+    c.out_stride = c.v->bs + header[6] % 64;
+    c.seed       = header[7];
+
+    size_t len = c.v->bs * c.blocks;
+
+    c.plain     = alloc_at(0, len);
+    c.expected  = alloc_at(0, len);
+    c.expected2 = alloc_at(0, len);
+    for (size_t i = 0; i < len; i++) {
+        c.plain[i] = pos < size ? data[pos++] : 0;
+    }
+    for (size_t i = 0; i < c.blocks; i++) {
+        c.v->ref_encrypt(c.plain + c.v->bs * i, c.expected + c.v->bs * i, c.key, c.key_size,
+                         c.rounds);
+        c.v->ref_encrypt(c.plain + c.v->bs * i, c.expected2 + c.v->bs * i, c.key2, c.key_size,
+                         c.rounds);
+    }
+
+    // The layout seed also picks the number of blocks in flight, which
+    // selects between kernels where the backend has more than one. Width 0
+    // keeps the configured one.
+    static const int        widths[] = { 0, 1, 2, 4, 6, 8 };
+    int                     width    = widths[c.seed % (sizeof widths / sizeof widths[0])];
+    vistrutah_kernel_config saved_enc = vistrutah_kernel_configs[c.v->encrypt_variant];
+    vistrutah_kernel_config saved_dec = vistrutah_kernel_configs[c.v->decrypt_variant];
+
+    if (width != 0) {
+        vistrutah_kernel_configs[c.v->encrypt_variant].blocks_in_flight = width;
+        vistrutah_kernel_configs[c.v->decrypt_variant].blocks_in_flight = width;
+    }
+    check_single(&c);
+    check_blocks(&c);
+    if (c.v->bits == 256) {
+        check_ctx_256(&c);
+    } else {
+        check_ctx_512(&c);
+    }
+    vistrutah_kernel_configs[c.v->encrypt_variant] = saved_enc;
+    vistrutah_kernel_configs[c.v->decrypt_variant] = saved_dec;
+
+    free(c.plain);
+    free(c.expected);
+    free(c.expected2);
+    return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+static int
+run_file(const char* path)
+{
+    FILE*    f = fopen(path, "rb");
+    uint8_t* buf;
+    long     size;
+
+    if (f == NULL || fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < 0) {
+        fprintf(stderr, "Cannot read %s\n", path);
+        if (f != NULL) {
+            fclose(f);
+        }
+        return -1;
+    }
+    rewind(f);
+    buf = malloc((size_t) size + 1);
+    if (fread(buf, 1, (size_t) size, f) != (size_t) size) {
+        fprintf(stderr, "Cannot read %s\n", path);
+        fclose(f);
+        free(buf);
+        return -1;
+    }
+    fclose(f);
+
+    current_input = buf;
+    current_size  = (size_t) size;
+    LLVMFuzzerTestOneInput(buf, (size_t) size);
+    current_input = NULL;
+    free(buf);
+    return 0;
+}
+
+static double
+now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+int
+main(int argc, char** argv)
+{
+    double   seconds = 60;
+    uint32_t seed    = (uint32_t) time(NULL);
+    int      files   = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t) strtoul(argv[++i], NULL, 0);
+        } else {
+            if (run_file(argv[i]) != 0) {
+                return 1;
+            }
+            files++;
+        }
+    }
+    if (files > 0) {
+        printf("%d input(s) passed\n", files);
+        return 0;
+    }
+
+    // Standalone mode: random inputs until the time is up. Layout bytes
+    // are drawn uniformly; message lengths favour short inputs.
+    uint8_t  input[8 + 128 + FUZZ_MAX_BLOCKS * 64];
+    uint32_t state = seed != 0 ? seed : 1;
+    double   start = now_seconds(), report = start + 10;
+    uint64_t runs  = 0;
+
+    printf("Fuzzing %s against the portable reference for %.0f s (seed %u)\n",
+           vistrutah_get_impl_name(), seconds, seed);
+    while (now_seconds() - start < seconds) {
+        size_t size = next_random(&state) % 2 ? sizeof input : next_random(&state) % sizeof input;
+
+        for (size_t i = 0; i < size; i++) {
+            input[i] = (uint8_t) next_random(&state);
+        }
+        current_input = input;
+        current_size  = size;
+        LLVMFuzzerTestOneInput(input, size);
+        runs++;
+
+        if (now_seconds() >= report) {
+            printf("  %llu inputs, %.0f s\n", (unsigned long long) runs, now_seconds() - start);
+            fflush(stdout);
+            report += 10;
+        }
+    }
+    printf("%llu inputs, no differences\n", (unsigned long long) runs);
+    return 0;
+}
+#endif
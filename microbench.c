@@ -0,0 +1,380 @@
+#define _POSIX_C_SOURCE 200809L
+#define VISTRUTAH_BACKEND
+
+// Per-primitive microbenchmarks. The backend sources are included here
+// instead of being linked, so that their static helpers (round functions,
+// mixing layers, rotate_bytes, apply_permutation) can be timed on their own.
+// The Makefile leaves those sources out of the link.
+//
+// Each primitive is measured two ways:
+// - latency: one chain where every call consumes the previous result, which
+//   is how the primitive sits on the critical path of a single block
+// - throughput: several independent chains interleaved, as in the batch
+//   kernels; reported per call
+//
+// Costs are cycles on x86 (TSC ticks, which match core cycles only at the
+// nominal frequency) and nanoseconds elsewhere. Each figure is the minimum
+// of several runs. An argument runs only primitives whose name contains it.
+
+#include "vistrutah.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(MICROBENCH_PORTABLE)
+#    include "vistrutah_portable.c"
+#elif defined(VISTRUTAH_ARM)
+#    include "vistrutah_arm.c"
+#    include "vistrutah_512_arm.c"
+#elif defined(VISTRUTAH_INTEL)
+// vistrutah_intel.c and vistrutah_512_intel.c define the same round helpers
+#    define aes_round           aes_round_256
+#    define aes_final_round     aes_final_round_256
+#    define aes_inv_round       aes_inv_round_256
+#    define aes_inv_final_round aes_inv_final_round_256
+#    include "vistrutah_intel.c"
+#    undef aes_round
+#    undef aes_final_round
+#    undef aes_inv_round
+#    undef aes_inv_final_round
+#    include "vistrutah_512_intel.c"
+#    include "vistrutah_512_vaes.c"
+#endif
+
+#define MIN_TICKS (1u << 20)
+#define RUNS      11
+
+#if defined(VISTRUTAH_INTEL)
+#    define COST_UNIT "cycles"
+
+static inline uint64_t
+read_ticks()
+{
+    return __rdtsc();
+}
+#else
+#    define COST_UNIT "ns"
+
+static inline uint64_t
+read_ticks()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+// Random starting states, and a round key for the AES primitives
+static uint8_t seed_data[1024];
+static uint8_t round_key[16];
+
+static volatile uint8_t sink;
+
+static void
+consume(const void* p, size_t len)
+{
+    const uint8_t* b   = p;
+    uint8_t        acc = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        acc ^= b[i];
+    }
+    sink = acc;
+}
+
+// Defines name_latency(n) and name_throughput(n), which apply op n times
+// to one state of the given type, or to each of lanes independent states
+#define PRIMITIVE(name, type, lanes, op)                                                           \
+    enum { name##_lanes = lanes };                                                                 \
+                                                                                                   \
+    static void name##_latency(size_t n)                                                           \
+    {                                                                                              \
+        type x;                                                                                    \
+                                                                                                   \
+        memcpy(&x, seed_data, sizeof x);                                                           \
+        for (size_t i = 0; i < n; i++) {                                                           \
+            op(x);                                                                                 \
+        }                                                                                          \
+        consume(&x, sizeof x);                                                                     \
+    }                                                                                              \
+                                                                                                   \
+    static void name##_throughput(size_t n)                                                        \
+    {                                                                                              \
+        type x[lanes];                                                                             \
+                                                                                                   \
+        memcpy(x, seed_data, sizeof x);                                                            \
+        for (size_t i = 0; i < n; i++) {                                                           \
+            for (int j = 0; j < lanes; j++) {                                                      \
+                op(x[j]);                                                                          \
+            }                                                                                      \
+        }                                                                                          \
+        consume(x, sizeof x);                                                                      \
+    }
+
+typedef struct {
+    const char* name;
+    void (*latency)(size_t n);
+    void (*throughput)(size_t n);
+    int         lanes;
+} primitive;
+
+#define ENTRY(name, label) { label, name##_latency, name##_throughput, name##_lanes }
+
+typedef struct {
+    uint8_t b[16];
+} bytes16;
+typedef struct {
+    uint8_t b[32];
+} bytes32;
+typedef struct {
+    uint8_t b[64];
+} bytes64;
+
+#if defined(MICROBENCH_PORTABLE)
+#    define AES_ROUND(x)       aes_round(x.b, round_key)
+#    define AES_DEC_ROUND(x)   aes_dec_round(x.b, round_key)
+#    define MIX_256(x)         mixing_layer_256(x.b)
+#    define INV_MIX_256(x)     inv_mixing_layer_256(x.b)
+#    define PERMUTE(x)         apply_permutation(VISTRUTAH_P4, x.b, 16)
+#    define KEY_STEP_256(x)                                                                        \
+        apply_permutation(VISTRUTAH_P4, x.b, 16);                                                  \
+        apply_permutation(VISTRUTAH_P5, x.b + 16, 16)
+#    define MIX_512(x)         mixing_layer_512(x.b)
+#    define INV_MIX_512(x)     inv_mixing_layer_512(x.b)
+#    define ROTATE(x)          rotate_bytes(x.b, 5, 16)
+#    define KEY_STEP_512(x)                                                                        \
+        rotate_bytes(x.b, 5, 16);                                                                  \
+        rotate_bytes(x.b + 16, 10, 16);                                                            \
+        rotate_bytes(x.b + 32, 5, 16);                                                             \
+        rotate_bytes(x.b + 48, 10, 16)
+
+PRIMITIVE(aes_round_1, bytes16, 8, AES_ROUND)
+PRIMITIVE(aes_dec_round_1, bytes16, 8, AES_DEC_ROUND)
+PRIMITIVE(mixing_256, bytes32, 8, MIX_256)
+PRIMITIVE(inv_mixing_256, bytes32, 8, INV_MIX_256)
+PRIMITIVE(permutation, bytes16, 8, PERMUTE)
+PRIMITIVE(key_step_256, bytes32, 8, KEY_STEP_256)
+PRIMITIVE(mixing_512, bytes64, 8, MIX_512)
+PRIMITIVE(inv_mixing_512, bytes64, 8, INV_MIX_512)
+PRIMITIVE(rotate, bytes16, 8, ROTATE)
+PRIMITIVE(key_step_512, bytes64, 8, KEY_STEP_512)
+
+static const primitive primitives[] = {
+    ENTRY(aes_round_1, "aes_round"),
+    ENTRY(aes_dec_round_1, "aes_dec_round"),
+    ENTRY(mixing_256, "mixing_layer_256"),
+    ENTRY(inv_mixing_256, "inv_mixing_layer_256"),
+    ENTRY(permutation, "apply_permutation (16 bytes)"),
+    ENTRY(key_step_256, "key schedule step, 256 (P4, P5)"),
+    ENTRY(mixing_512, "mixing_layer_512"),
+    ENTRY(inv_mixing_512, "inv_mixing_layer_512"),
+    ENTRY(rotate, "rotate_bytes (16 bytes)"),
+    ENTRY(key_step_512, "key schedule step, 512 (4 rotations)"),
+};
+#elif defined(VISTRUTAH_ARM)
+typedef struct {
+    uint8x16_t v[2];
+} vec2;
+typedef struct {
+    uint8x16_t v[4];
+} vec4;
+
+#    define AES_ROUND(x)     x = AES_ENC(x, vld1q_u8(round_key))
+#    define AES_DEC_ROUND(x) x = AES_DEC(x, vld1q_u8(round_key))
+#    define MIX_256(x)       mixing_layer_256(&x.v[0], &x.v[1])
+#    define INV_MIX_256(x)   inv_mixing_layer_256(&x.v[0], &x.v[1])
+#    define PERMUTE(x)       x = vqtbl1q_u8(x, vld1q_u8(VISTRUTAH_P4))
+#    define KEY_STEP_256(x)                                                                        \
+        x.v[0] = vqtbl1q_u8(x.v[0], vld1q_u8(VISTRUTAH_P4));                                       \
+        x.v[1] = vqtbl1q_u8(x.v[1], vld1q_u8(VISTRUTAH_P5))
+#    define MIX_512(x)     mixing_layer_512(&x.v[0], &x.v[1], &x.v[2], &x.v[3])
+#    define INV_MIX_512(x) inv_mixing_layer_512(&x.v[0], &x.v[1], &x.v[2], &x.v[3])
+#    define ROTATE(x)      x = rotate_bytes(x, 5)
+#    define KEY_STEP_512(x)                                                                        \
+        x.v[0] = rotate_bytes(x.v[0], 5);                                                          \
+        x.v[1] = rotate_bytes(x.v[1], 10);                                                         \
+        x.v[2] = rotate_bytes(x.v[2], 5);                                                          \
+        x.v[3] = rotate_bytes(x.v[3], 10)
+
+PRIMITIVE(aes_round_1, uint8x16_t, 8, AES_ROUND)
+PRIMITIVE(aes_dec_round_1, uint8x16_t, 8, AES_DEC_ROUND)
+PRIMITIVE(mixing_256, vec2, 8, MIX_256)
+PRIMITIVE(inv_mixing_256, vec2, 8, INV_MIX_256)
+PRIMITIVE(permutation, uint8x16_t, 8, PERMUTE)
+PRIMITIVE(key_step_256, vec2, 8, KEY_STEP_256)
+PRIMITIVE(mixing_512, vec4, 4, MIX_512)
+PRIMITIVE(inv_mixing_512, vec4, 4, INV_MIX_512)
+PRIMITIVE(rotate, uint8x16_t, 8, ROTATE)
+PRIMITIVE(key_step_512, vec4, 4, KEY_STEP_512)
+
+static const primitive primitives[] = {
+    ENTRY(aes_round_1, "AES_ENC (AESE+AESMC)"),
+    ENTRY(aes_dec_round_1, "AES_DEC (AESD+AESIMC)"),
+    ENTRY(mixing_256, "mixing_layer_256"),
+    ENTRY(inv_mixing_256, "inv_mixing_layer_256"),
+    ENTRY(permutation, "key permutation (TBL)"),
+    ENTRY(key_step_256, "key schedule step, 256 (P4, P5)"),
+    ENTRY(mixing_512, "mixing_layer_512"),
+    ENTRY(inv_mixing_512, "inv_mixing_layer_512"),
+    ENTRY(rotate, "rotate_bytes"),
+    ENTRY(key_step_512, "key schedule step, 512 (4 rotations)"),
+};
+#elif defined(VISTRUTAH_INTEL)
+typedef struct {
+    __m128i v[2];
+} vec2;
+typedef struct {
+    __m128i v[4];
+} vec4;
+
+#    define AES_ROUND(x)     x = aes_round_256(x, _mm_loadu_si128((const __m128i *) round_key))
+#    define AES_DEC_ROUND(x) x = aes_inv_round_256(x, _mm_loadu_si128((const __m128i *) round_key))
+#    define MIX_256(x)       mixing_layer_256(&x.v[0], &x.v[1])
+#    define INV_MIX_256(x)   inv_mixing_layer_256(&x.v[0], &x.v[1])
+#    define PERMUTE(x)       apply_permutation(VISTRUTAH_P4, x.b, 16)
+#    define KEY_STEP_256(x)                                                                        \
+        apply_permutation(VISTRUTAH_P4, x.b, 16);                                                  \
+        apply_permutation(VISTRUTAH_P5, x.b + 16, 16)
+
+PRIMITIVE(aes_round_1, __m128i, 8, AES_ROUND)
+PRIMITIVE(aes_dec_round_1, __m128i, 8, AES_DEC_ROUND)
+PRIMITIVE(mixing_256, vec2, 8, MIX_256)
+PRIMITIVE(inv_mixing_256, vec2, 8, INV_MIX_256)
+PRIMITIVE(permutation, bytes16, 8, PERMUTE)
+PRIMITIVE(key_step_256, bytes32, 8, KEY_STEP_256)
+
+#    ifndef VISTRUTAH_512_VAES256
+#        define MIX_512(x)     mixing_layer_512_sse(&x.v[0], &x.v[1], &x.v[2], &x.v[3])
+#        define INV_MIX_512(x) inv_mixing_layer_512_sse(&x.v[0], &x.v[1], &x.v[2], &x.v[3])
+#        define ROTATE(x)      rotate_bytes(x.b, 5, 16)
+#        define KEY_STEP_512(x)                                                                    \
+            rotate_bytes(x.b, 5, 16);                                                              \
+            rotate_bytes(x.b + 16, 10, 16);                                                        \
+            rotate_bytes(x.b + 32, 5, 16);                                                         \
+            rotate_bytes(x.b + 48, 10, 16)
+
+PRIMITIVE(mixing_512, vec4, 4, MIX_512)
+PRIMITIVE(inv_mixing_512, vec4, 4, INV_MIX_512)
+PRIMITIVE(rotate, bytes16, 8, ROTATE)
+PRIMITIVE(key_step_512, bytes64, 8, KEY_STEP_512)
+#    endif
+
+#    ifdef VISTRUTAH_512_VAES_KERNEL
+typedef struct {
+    __m256i v[2];
+} ymm2;
+
+#        define VAES_ROUND(x)                                                                      \
+            x = _mm256_aesenc_epi128(x, _mm256_broadcastsi128_si256(                               \
+                                            _mm_loadu_si128((const __m128i *) round_key)))
+#        define VAES_MIX_512(x)     mixing_layer_512(&x.v[0], &x.v[1])
+#        define VAES_INV_MIX_512(x) inv_mixing_layer_512(&x.v[0], &x.v[1])
+
+PRIMITIVE(vaes_round, __m256i, 8, VAES_ROUND)
+PRIMITIVE(vaes_mixing_512, ymm2, 8, VAES_MIX_512)
+PRIMITIVE(vaes_inv_mixing_512, ymm2, 8, VAES_INV_MIX_512)
+#    endif
+
+#    if defined(VISTRUTAH_AVX512) && defined(VISTRUTAH_VAES)
+#        define VAES512_ROUND(x)                                                                   \
+            x = _mm512_aesenc_epi128(x, _mm512_broadcast_i32x4(                                    \
+                                            _mm_loadu_si128((const __m128i *) round_key)))
+
+PRIMITIVE(vaes512_round, __m512i, 8, VAES512_ROUND)
+#    endif
+
+static const primitive primitives[] = {
+    ENTRY(aes_round_1, "aes_round (AESENC)"),
+    ENTRY(aes_dec_round_1, "aes_inv_round (AESDEC)"),
+    ENTRY(mixing_256, "mixing_layer_256"),
+    ENTRY(inv_mixing_256, "inv_mixing_layer_256"),
+    ENTRY(permutation, "apply_permutation (16 bytes)"),
+    ENTRY(key_step_256, "key schedule step, 256 (P4, P5)"),
+#    ifndef VISTRUTAH_512_VAES256
+    ENTRY(mixing_512, "mixing_layer_512_sse"),
+    ENTRY(inv_mixing_512, "inv_mixing_layer_512_sse"),
+    ENTRY(rotate, "rotate_bytes (16 bytes)"),
+    ENTRY(key_step_512, "key schedule step, 512 (4 rotations)"),
+#    endif
+#    ifdef VISTRUTAH_512_VAES_KERNEL
+    ENTRY(vaes_round, "VAES round, 256-bit (2 AES blocks)"),
+    ENTRY(vaes_mixing_512, "mixing_layer_512 (VAES kernel)"),
+    ENTRY(vaes_inv_mixing_512, "inv_mixing_layer_512 (VAES kernel)"),
+#    endif
+#    if defined(VISTRUTAH_AVX512) && defined(VISTRUTAH_VAES)
+    ENTRY(vaes512_round, "VAES round, 512-bit (4 AES blocks)"),
+#    endif
+};
+#else
+// The RISC-V backend works on whole batches in vector register groups and
+// has no per-block primitives to time on their own
+static const primitive primitives[] = {};
+#endif
+
+static uint64_t
+time_run(void (*fn)(size_t), size_t n)
+{
+    uint64_t start = read_ticks();
+    fn(n);
+    return read_ticks() - start;
+}
+
+// Cost per call of fn: the call count is doubled until a run takes at least
+// MIN_TICKS, then the fastest of RUNS runs is kept
+static double
+measure(void (*fn)(size_t), int calls_per_iteration)
+{
+    size_t   n = 64;
+    uint64_t best;
+
+    while (time_run(fn, n) < MIN_TICKS) {
+        n *= 2;
+    }
+    best = time_run(fn, n);
+    for (int r = 1; r < RUNS; r++) {
+        uint64_t t = time_run(fn, n);
+        if (t < best) {
+            best = t;
+        }
+    }
+    return (double) best / ((double) n * calls_per_iteration);
+}
+
+int
+main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : NULL;
+    size_t      count  = sizeof primitives / sizeof primitives[0];
+
+    srand(12345);
+    for (size_t i = 0; i < sizeof seed_data; i++) {
+        seed_data[i] = (uint8_t) rand();
+    }
+    for (size_t i = 0; i < sizeof round_key; i++) {
+        round_key[i] = (uint8_t) rand();
+    }
+
+    printf("Primitive Latency and Throughput (%s, %s/call)\n", vistrutah_get_impl_name(),
+           COST_UNIT);
+    printf("════════════════════════════════════════════════════════════════\n");
+    if (count == 0) {
+        printf("  No per-primitive benchmarks for this backend\n");
+        return 0;
+    }
+    printf("  %-40s %8s %11s %6s\n", "", "latency", "throughput", "chains");
+
+    for (size_t i = 0; i < count; i++) {
+        const primitive* p = &primitives[i];
+
+        if (filter != NULL && strstr(p->name, filter) == NULL) {
+            continue;
+        }
+        double latency    = measure(p->latency, 1);
+        double throughput = measure(p->throughput, p->lanes);
+
+        printf("  %-40s %8.2f %11.2f %6d\n", p->name, latency, throughput, p->lanes);
+    }
+
+    return 0;
+}
@@ -1,4 +1,7 @@
+#define VISTRUTAH_INTERNAL
 #include "vistrutah.h"
+#include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -497,6 +500,24 @@ test_edge_cases()
         printf("✗ Single bit test failed\n");
     }
 
+    // Test 5: More rounds than the named round counts; every backend takes any
+    // even count up to the round constants available
+    printf("\nTest 5: Vistrutah-512 with 32 rounds\n");
+    uint8_t batch_in[128], batch_out[128];
+    for (int i = 0; i < 128; i++) {
+        batch_in[i] = (uint8_t) (i * 7 + 1);
+    }
+    vistrutah_512_encrypt(batch_in, output, pattern, 64, 32);
+    vistrutah_512_decrypt(output, decrypted, pattern, 64, 32);
+    vistrutah_512_encrypt_blocks(batch_in, batch_out, 2, pattern, 64, 32);
+    total++;
+    if (memcmp(batch_in, decrypted, 64) == 0 && memcmp(output, batch_out, 64) == 0) {
+        printf("✓ Long round count test passed\n");
+        passed++;
+    } else {
+        printf("✗ Long round count test failed\n");
+    }
+
     printf("\nEdge cases: %d/%d passed\n", passed, total);
 }
 
@@ -782,6 +803,1937 @@ test_consistency()
     }
 }
 
+void
+test_batch_api()
+{
+    printf("\n=== Multi-Block API Test ===\n");
+    printf("Comparing *_blocks() against the single-block functions\n");
+
+    // Odd counts exercise partial vector groups in wide backends
+    static const size_t block_counts[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 64 };
+    static const struct {
+        int key_size;
+        int rounds;
+    } variants_256[] = { { 16, VISTRUTAH_256_ROUNDS_SHORT },
+                         { 32, VISTRUTAH_256_ROUNDS_SHORT },
+                         { 16, VISTRUTAH_256_ROUNDS_LONG },
+                         { 32, VISTRUTAH_256_ROUNDS_LONG } },
+      variants_512[] = { { 32, VISTRUTAH_512_ROUNDS_SHORT_256KEY },
+                         { 64, VISTRUTAH_512_ROUNDS_SHORT_512KEY },
+                         { 32, VISTRUTAH_512_ROUNDS_LONG_256KEY },
+                         { 64, VISTRUTAH_512_ROUNDS_LONG_512KEY } };
+    const size_t max_blocks = 64;
+
+    uint8_t  key[64];
+    uint8_t* plaintext = malloc(64 * max_blocks);
+    uint8_t* batch     = malloc(64 * max_blocks);
+    uint8_t* single    = malloc(64 * max_blocks);
+    uint8_t* decrypted = malloc(64 * max_blocks);
+    int      checks    = 0;
+
+    for (size_t i = 0; i < sizeof key; i++) {
+        key[i] = (uint8_t) (i * 7 + 3);
+    }
+    for (size_t i = 0; i < 64 * max_blocks; i++) {
+        plaintext[i] = (uint8_t) (i * 13 + (i >> 8));
+    }
+
+    for (size_t v = 0; v < sizeof variants_256 / sizeof variants_256[0]; v++) {
+        int key_size = variants_256[v].key_size;
+        int rounds   = variants_256[v].rounds;
+
+        for (size_t c = 0; c < sizeof block_counts / sizeof block_counts[0]; c++) {
+            size_t n = block_counts[c];
+
+            memset(batch, 0xaa, 32 * max_blocks);
+            memset(single, 0xaa, 32 * max_blocks);
+            vistrutah_256_encrypt_blocks(plaintext, batch, n, key, key_size, rounds);
+            for (size_t i = 0; i < n; i++) {
+                vistrutah_256_encrypt(plaintext + 32 * i, single + 32 * i, key, key_size, rounds);
+            }
+            vistrutah_256_decrypt_blocks(batch, decrypted, n, key, key_size, rounds);
+            if (memcmp(batch, single, 32 * max_blocks) != 0 ||
+                memcmp(decrypted, plaintext, 32 * n) != 0) {
+                printf("✗ Vistrutah-256 batch mismatch (key %d, %d rounds, %zu blocks)\n",
+                       key_size * 8, rounds, n);
+                exit(1);
+            }
+            checks++;
+        }
+    }
+
+    for (size_t v = 0; v < sizeof variants_512 / sizeof variants_512[0]; v++) {
+        int key_size = variants_512[v].key_size;
+        int rounds   = variants_512[v].rounds;
+
+        for (size_t c = 0; c < sizeof block_counts / sizeof block_counts[0]; c++) {
+            size_t n = block_counts[c];
+
+            memset(batch, 0xaa, 64 * max_blocks);
+            memset(single, 0xaa, 64 * max_blocks);
+            vistrutah_512_encrypt_blocks(plaintext, batch, n, key, key_size, rounds);
+            for (size_t i = 0; i < n; i++) {
+                vistrutah_512_encrypt(plaintext + 64 * i, single + 64 * i, key, key_size, rounds);
+            }
+            vistrutah_512_decrypt_blocks(batch, decrypted, n, key, key_size, rounds);
+            if (memcmp(batch, single, 64 * max_blocks) != 0 ||
+                memcmp(decrypted, plaintext, 64 * n) != 0) {
+                printf("✗ Vistrutah-512 batch mismatch (key %d, %d rounds, %zu blocks)\n",
+                       key_size * 8, rounds, n);
+                exit(1);
+            }
+            checks++;
+        }
+    }
+
+    printf("✓ %d block-count/variant combinations match\n", checks);
+
+    free(plaintext);
+    free(batch);
+    free(single);
+    free(decrypted);
+}
+
+static void
+test_strided()
+{
+    printf("\n=== Strided API Test ===\n");
+
+    static const size_t strides[] = { 0, 1, 16, 40 };
+    const size_t        n         = 37;
+    const size_t        max_size  = n * (64 + 40);
+
+    vistrutah_256_ctx ctx256;
+    vistrutah_512_ctx ctx512;
+    uint8_t           key[64];
+    uint8_t*          records  = malloc(max_size);
+    uint8_t*          out      = malloc(max_size);
+    uint8_t*          expected = malloc(n * 64);
+    uint8_t*          column   = malloc(n * 64);
+    int               failures = 0;
+
+    for (size_t i = 0; i < sizeof key; i++) {
+        key[i] = (uint8_t) (i * 3 + 1);
+    }
+    for (size_t i = 0; i < max_size; i++) {
+        records[i] = (uint8_t) (i * 17 + 9);
+    }
+
+    if (vistrutah_256_init(&ctx256, key, 64, VISTRUTAH_256_ROUNDS_LONG) != -1 ||
+        vistrutah_512_init(&ctx512, key, 16, VISTRUTAH_512_ROUNDS_LONG_256KEY) != -1 ||
+        vistrutah_512_init(&ctx512, key, 48, VISTRUTAH_512_ROUNDS_LONG_512KEY) != -1) {
+        printf("✗ Unsupported key size was accepted\n");
+        failures++;
+    }
+    vistrutah_256_init(&ctx256, key, 32, VISTRUTAH_256_ROUNDS_LONG);
+    vistrutah_512_init(&ctx512, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+
+    // Records with padding between them (e.g. a field of a row) give the
+    // same result as the contiguous multi-block call, and round trip; the
+    // untouched bytes between records are left alone
+    for (int wide = 0; wide < 2; wide++) {
+        size_t bs = wide ? 64 : 32;
+
+        for (size_t s = 0; s < sizeof strides / sizeof strides[0]; s++) {
+            size_t stride = bs + strides[s];
+
+            for (size_t i = 0; i < n; i++) {
+                memcpy(column + bs * i, records + stride * i, bs);
+            }
+            memset(out, 0x5a, max_size);
+            if (wide) {
+                vistrutah_512_encrypt_blocks(column, expected, n, key, 64,
+                                             VISTRUTAH_512_ROUNDS_LONG_512KEY);
+                vistrutah_512_encrypt_strided(&ctx512, records, stride, out, stride, n);
+            } else {
+                vistrutah_256_encrypt_blocks(column, expected, n, key, 32,
+                                             VISTRUTAH_256_ROUNDS_LONG);
+                vistrutah_256_encrypt_strided(&ctx256, records, stride, out, stride, n);
+            }
+            for (size_t i = 0; i < n; i++) {
+                if (memcmp(out + stride * i, expected + bs * i, bs) != 0 ||
+                    (stride > bs && out[stride * i + bs] != 0x5a)) {
+                    printf("✗ %zu-bit strided encryption differs (stride %zu)\n", 8 * bs,
+                           stride);
+                    failures++;
+                    break;
+                }
+            }
+
+            // Decrypt in place into a contiguous column
+            if (wide) {
+                vistrutah_512_decrypt_strided(&ctx512, out, stride, out, bs, n);
+            } else {
+                vistrutah_256_decrypt_strided(&ctx256, out, stride, out, bs, n);
+            }
+            if (memcmp(out, column, bs * n) != 0) {
+                printf("✗ %zu-bit strided decryption failed (stride %zu)\n", 8 * bs, stride);
+                failures++;
+            }
+        }
+    }
+
+    if (failures == 0) {
+        printf("✓ Strided batches match the multi-block API and round trip\n");
+    }
+
+    free(records);
+    free(out);
+    free(expected);
+    free(column);
+}
+
+static void
+test_pointer_arrays()
+{
+    printf("\n=== Pointer-Array API Test ===\n");
+
+    const size_t n    = 45;
+    const size_t slot = 80;
+
+    vistrutah_256_ctx        ctx256[3];
+    vistrutah_512_ctx        ctx512[3];
+    const vistrutah_256_ctx* ctxs256[45];
+    const vistrutah_512_ctx* ctxs512[45];
+    const uint8_t*           in[45];
+    uint8_t*                 out[45];
+    uint8_t                  key[3][64];
+    uint8_t                  expected[64];
+    uint8_t*                 pool     = malloc(n * slot);
+    uint8_t*                 dest     = malloc(n * slot);
+    int                      failures = 0;
+
+    for (int k = 0; k < 3; k++) {
+        for (int i = 0; i < 64; i++) {
+            key[k][i] = (uint8_t) (k * 64 + i);
+        }
+        vistrutah_256_init(&ctx256[k], key[k], 32, VISTRUTAH_256_ROUNDS_LONG);
+        vistrutah_512_init(&ctx512[k], key[k], 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+    }
+    for (size_t i = 0; i < n * slot; i++) {
+        pool[i] = (uint8_t) (i * 23 + 1);
+    }
+
+    // Entries are scattered (slot (7 * i) mod n), and the per-entry contexts
+    // form runs of different lengths
+    for (size_t i = 0; i < n; i++) {
+        size_t k = i < 10 ? 0 : i < 11 ? 1 : i < 30 ? 2 : i % 3;
+
+        in[i]      = pool + slot * ((7 * i) % n);
+        out[i]     = dest + slot * ((7 * i) % n);
+        ctxs256[i] = &ctx256[k];
+        ctxs512[i] = &ctx512[k];
+    }
+
+    for (int wide = 0; wide < 2; wide++) {
+        size_t bs = wide ? 64 : 32;
+
+        for (int per_entry = 0; per_entry < 2; per_entry++) {
+            if (wide) {
+                vistrutah_512_encrypt_ptrs(&ctx512[1], per_entry ? ctxs512 : NULL, in, out, n);
+            } else {
+                vistrutah_256_encrypt_ptrs(&ctx256[1], per_entry ? ctxs256 : NULL, in, out, n);
+            }
+            for (size_t i = 0; i < n; i++) {
+                const uint8_t* k = per_entry ? (wide ? ctxs512[i]->key : ctxs256[i]->key)
+                                             : key[1];
+
+                if (wide) {
+                    vistrutah_512_encrypt(in[i], expected, k, 64,
+                                          VISTRUTAH_512_ROUNDS_LONG_512KEY);
+                } else {
+                    vistrutah_256_encrypt(in[i], expected, k, 32, VISTRUTAH_256_ROUNDS_LONG);
+                }
+                if (memcmp(out[i], expected, bs) != 0) {
+                    printf("✗ %zu-bit pointer-array encryption differs (entry %zu%s)\n", 8 * bs,
+                           i, per_entry ? ", per-entry keys" : "");
+                    failures++;
+                    break;
+                }
+            }
+
+            // Decrypt in place through the output pointers
+            if (wide) {
+                vistrutah_512_decrypt_ptrs(&ctx512[1], per_entry ? ctxs512 : NULL,
+                                           (const uint8_t* const*) out, out, n);
+            } else {
+                vistrutah_256_decrypt_ptrs(&ctx256[1], per_entry ? ctxs256 : NULL,
+                                           (const uint8_t* const*) out, out, n);
+            }
+            for (size_t i = 0; i < n; i++) {
+                if (memcmp(out[i], in[i], bs) != 0) {
+                    printf("✗ %zu-bit pointer-array decryption failed (entry %zu)\n", 8 * bs, i);
+                    failures++;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (failures == 0) {
+        printf("✓ Scattered entries, shared and per-entry contexts, in-place use\n");
+    }
+
+    free(pool);
+    free(dest);
+}
+
+static uint32_t
+crc32c_reference(uint32_t crc, const uint8_t* data, size_t len)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++) {
+            crc = crc >> 1 ^ (0x82f63b78 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static void
+test_crc32c()
+{
+    printf("\n=== Fused CRC32C Test ===\n");
+
+    const size_t blocks = 53;
+
+    vistrutah_256_ctx ctx256;
+    vistrutah_512_ctx ctx512;
+    uint8_t           key[64];
+    uint8_t*          plaintext = malloc(64 * blocks);
+    uint8_t*          expected  = malloc(64 * blocks);
+    uint8_t*          out       = malloc(64 * blocks);
+    int               failures  = 0;
+
+    if (vistrutah_crc32c(0, (const uint8_t*) "123456789", 9) != 0xe3069283) {
+        printf("✗ CRC32C check value mismatch\n");
+        failures++;
+    }
+    for (size_t i = 0; i < sizeof key; i++) {
+        key[i] = (uint8_t) (i * 5 + 1);
+    }
+    for (size_t i = 0; i < 64 * blocks; i++) {
+        plaintext[i] = (uint8_t) (i * 29 + 11);
+    }
+    if (vistrutah_crc32c(vistrutah_crc32c(0, plaintext, 1001), plaintext + 1001, 2000) !=
+        crc32c_reference(0, plaintext, 3001)) {
+        printf("✗ Chained CRC32C differs from the reference\n");
+        failures++;
+    }
+
+    vistrutah_256_init(&ctx256, key, 32, VISTRUTAH_256_ROUNDS_LONG);
+    vistrutah_512_init(&ctx512, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+
+    for (int wide = 0; wide <= 1; wide++) {
+        size_t   bsize = wide ? 64 : 32;
+        size_t   bytes = bsize * blocks;
+        uint32_t crc_pt = 0, crc_ct = 0, crc_back = 0, crc_dec_in = 0;
+
+        if (wide) {
+            vistrutah_512_encrypt_blocks(plaintext, expected, blocks, key, 64,
+                                         VISTRUTAH_512_ROUNDS_LONG_512KEY);
+        } else {
+            vistrutah_256_encrypt_blocks(plaintext, expected, blocks, key, 32,
+                                         VISTRUTAH_256_ROUNDS_LONG);
+        }
+
+        // Two calls, so the running CRCs are chained across a split
+        for (size_t done = 0, n = 20; done < blocks; done += n, n = blocks - done) {
+            if (wide) {
+                vistrutah_512_encrypt_blocks_crc32c(&ctx512, plaintext + bsize * done,
+                                                    out + bsize * done, n, &crc_pt, &crc_ct);
+            } else {
+                vistrutah_256_encrypt_blocks_crc32c(&ctx256, plaintext + bsize * done,
+                                                    out + bsize * done, n, &crc_pt, &crc_ct);
+            }
+        }
+        if (memcmp(out, expected, bytes) != 0 ||
+            crc_pt != crc32c_reference(0, plaintext, bytes) ||
+            crc_ct != crc32c_reference(0, expected, bytes)) {
+            printf("✗ Vistrutah-%d encryption with CRC32C failed\n", wide ? 512 : 256);
+            failures++;
+        }
+
+        // In place, checksumming only the recovered plaintext
+        if (wide) {
+            vistrutah_512_decrypt_blocks_crc32c(&ctx512, out, out, blocks, NULL, &crc_back);
+            vistrutah_512_decrypt_blocks_crc32c(&ctx512, expected, expected, blocks,
+                                                &crc_dec_in, NULL);
+        } else {
+            vistrutah_256_decrypt_blocks_crc32c(&ctx256, out, out, blocks, NULL, &crc_back);
+            vistrutah_256_decrypt_blocks_crc32c(&ctx256, expected, expected, blocks,
+                                                &crc_dec_in, NULL);
+        }
+        if (memcmp(out, plaintext, bytes) != 0 || crc_back != crc_pt || crc_dec_in != crc_ct) {
+            printf("✗ Vistrutah-%d decryption with CRC32C failed\n", wide ? 512 : 256);
+            failures++;
+        }
+    }
+
+    if (failures == 0) {
+        printf("✓ CRC32C check value and fused encrypt/decrypt checksums\n");
+    }
+
+    free(plaintext);
+    free(expected);
+    free(out);
+}
+
+static void
+test_streaming_stores()
+{
+    printf("\n=== Streaming Store Test ===\n");
+
+    const size_t blocks = 45;
+
+    vistrutah_256_ctx ctx256;
+    vistrutah_512_ctx ctx512;
+    uint8_t           key[64];
+    uint8_t           out[64 * 45 + 8 + 64] __attribute__((aligned(64)));
+    uint8_t*          plaintext = malloc(64 * blocks);
+    uint8_t*          expected  = malloc(64 * blocks);
+    int               failures  = 0;
+
+    for (size_t i = 0; i < sizeof key; i++) {
+        key[i] = (uint8_t) (i * 13 + 7);
+    }
+    for (size_t i = 0; i < 64 * blocks; i++) {
+        plaintext[i] = (uint8_t) (i * 31 + 5);
+    }
+    vistrutah_256_init(&ctx256, key, 32, VISTRUTAH_256_ROUNDS_LONG);
+    vistrutah_512_init(&ctx512, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+
+    for (int wide = 0; wide <= 1; wide++) {
+        size_t bytes = (wide ? 64 : 32) * blocks;
+
+        if (wide) {
+            vistrutah_512_encrypt_blocks(plaintext, expected, blocks, key, 64,
+                                         VISTRUTAH_512_ROUNDS_LONG_512KEY);
+        } else {
+            vistrutah_256_encrypt_blocks(plaintext, expected, blocks, key, 32,
+                                         VISTRUTAH_256_ROUNDS_LONG);
+        }
+
+        // An aligned destination takes the streaming path, an offset one the cached path.
+        // The destination is exactly bytes long and followed by guard bytes.
+        for (size_t misalign = 0; misalign <= 8; misalign += 8) {
+            uint8_t* dst = out + misalign;
+
+            memset(dst + bytes, 0xa5, 64);
+            if (wide) {
+                vistrutah_512_encrypt_blocks_stream(&ctx512, plaintext, dst, blocks);
+            } else {
+                vistrutah_256_encrypt_blocks_stream(&ctx256, plaintext, dst, blocks);
+            }
+            if (memcmp(dst, expected, bytes) != 0) {
+                printf("✗ Vistrutah-%d streaming encryption failed (offset %zu)\n",
+                       wide ? 512 : 256, misalign);
+                failures++;
+            }
+            if (wide) {
+                vistrutah_512_decrypt_blocks_stream(&ctx512, dst, dst, blocks);
+            } else {
+                vistrutah_256_decrypt_blocks_stream(&ctx256, dst, dst, blocks);
+            }
+            if (memcmp(dst, plaintext, bytes) != 0) {
+                printf("✗ Vistrutah-%d in-place streaming decryption failed (offset %zu)\n",
+                       wide ? 512 : 256, misalign);
+                failures++;
+            }
+            for (size_t k = 0; k < 64; k++) {
+                if (dst[bytes + k] != 0xa5) {
+                    printf("✗ Vistrutah-%d streaming stores wrote past the end (offset %zu)\n",
+                           wide ? 512 : 256, misalign);
+                    failures++;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (failures == 0) {
+        printf("✓ Streaming encrypt/decrypt, aligned, unaligned and in place\n");
+    }
+
+    free(plaintext);
+    free(expected);
+}
+
+static void
+test_job_manager()
+{
+    printf("\n=== Multi-Buffer Job Manager Test ===\n");
+
+    const size_t jobs_count = 40;
+
+    vistrutah_512_ctx ctx[3];
+    vistrutah_mb_mgr  mgr;
+    vistrutah_mb_job  jobs[40];
+    uint8_t           key[64];
+    uint8_t*          in       = malloc(64 * 8 * jobs_count);
+    uint8_t*          out      = malloc(64 * 8 * jobs_count);
+    uint8_t*          expected = malloc(64 * 8 * jobs_count);
+    size_t            next     = 0;
+    int               failures = 0;
+
+    for (size_t i = 0; i < sizeof key; i++) {
+        key[i] = (uint8_t) (i * 3 + 17);
+    }
+    for (size_t i = 0; i < 64 * 8 * jobs_count; i++) {
+        in[i] = (uint8_t) (i * 41 + 9);
+    }
+    vistrutah_512_init(&ctx[0], key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+    vistrutah_512_init(&ctx[1], key + 16, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+    vistrutah_512_init(&ctx[2], key + 32, 32, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+
+    // Lengths of 1 to 8 blocks, contexts and directions vary from job to job
+    for (size_t j = 0; j < jobs_count; j++) {
+        const vistrutah_512_ctx* c = &ctx[(j * 5) % 3];
+
+        jobs[j].ctx       = c;
+        jobs[j].decrypt   = (j % 4) == 3;
+        jobs[j].in        = in + 64 * 8 * j;
+        jobs[j].out       = out + 64 * 8 * j;
+        jobs[j].blocks    = 1 + (j * 7) % 8;
+        jobs[j].user_data = &jobs[j];
+        if (jobs[j].decrypt) {
+            vistrutah_512_decrypt_blocks(jobs[j].in, expected + 64 * 8 * j, jobs[j].blocks, c->key,
+                                         c->key_size, c->rounds);
+        } else {
+            vistrutah_512_encrypt_blocks(jobs[j].in, expected + 64 * 8 * j, jobs[j].blocks, c->key,
+                                         c->key_size, c->rounds);
+        }
+    }
+
+    vistrutah_mb_init(&mgr, 7, 24);
+    for (size_t j = 0; j < jobs_count; j++) {
+        vistrutah_mb_job* done;
+
+        if (vistrutah_mb_submit(&mgr, &jobs[j]) != 0) {
+            printf("✗ Submission %zu rejected\n", j);
+            failures++;
+        }
+        while ((done = vistrutah_mb_get_completed(&mgr)) != NULL) {
+            if (done->user_data != &jobs[next++]) {
+                failures++;
+            }
+        }
+        if (j - next + 1 >= 7) {
+            printf("✗ Job %zu waited past the flush policy\n", next);
+            failures++;
+        }
+    }
+    vistrutah_mb_flush(&mgr);
+    for (vistrutah_mb_job* done; (done = vistrutah_mb_get_completed(&mgr)) != NULL;) {
+        if (done->user_data != &jobs[next++]) {
+            failures++;
+        }
+    }
+    if (next != jobs_count) {
+        printf("✗ Jobs completed out of order or missing\n");
+        failures++;
+    }
+    for (size_t j = 0; j < jobs_count; j++) {
+        if (memcmp(jobs[j].out, expected + 64 * 8 * j, 64 * jobs[j].blocks) != 0) {
+            printf("✗ Job %zu output differs from a direct call\n", j);
+            failures++;
+        }
+    }
+
+    // A full manager rejects new jobs until completed ones are collected
+    vistrutah_mb_init(&mgr, 0, 0);
+    for (size_t j = 0; j < VISTRUTAH_MB_MAX_JOBS; j++) {
+        vistrutah_mb_submit(&mgr, &jobs[j % jobs_count]);
+    }
+    if (vistrutah_mb_submit(&mgr, &jobs[0]) != -1 || vistrutah_mb_get_completed(&mgr) == NULL ||
+        vistrutah_mb_submit(&mgr, &jobs[0]) != 0) {
+        printf("✗ Full manager handling failed\n");
+        failures++;
+    }
+
+    if (failures == 0) {
+        printf("✓ Mixed lengths, keys and directions, in-order completion, flush policy\n");
+    }
+
+    free(in);
+    free(out);
+    free(expected);
+}
+
+static void
+test_offload()
+{
+    printf("\n=== Offload Engine Test ===\n");
+
+    const size_t jobs_count = 120;
+    const int    producers  = 3;
+
+    vistrutah_512_ctx  ctx[2];
+    vistrutah_mb_job   jobs[120];
+    vistrutah_offload* engine;
+    uint8_t            key[64];
+    uint8_t*           in       = malloc(64 * 4 * jobs_count);
+    uint8_t*           out      = calloc(64 * 4 * jobs_count, 1);
+    uint8_t*           expected = calloc(64 * 4 * jobs_count, 1);
+    size_t             submitted[3] = { 0 }, next[3] = { 0 }, received = 0;
+    int                failures = 0;
+
+    for (size_t i = 0; i < sizeof key; i++) {
+        key[i] = (uint8_t) (i * 11 + 2);
+    }
+    for (size_t i = 0; i < 64 * 4 * jobs_count; i++) {
+        in[i] = (uint8_t) (i * 37 + 1);
+    }
+    vistrutah_512_init(&ctx[0], key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+    vistrutah_512_init(&ctx[1], key + 32, 32, VISTRUTAH_512_ROUNDS_SHORT_256KEY);
+
+    // Producer p submits jobs p, p + 3, p + 6, ...
+    for (size_t j = 0; j < jobs_count; j++) {
+        const vistrutah_512_ctx* c = &ctx[j % 2];
+
+        jobs[j].ctx       = c;
+        jobs[j].decrypt   = (j % 5) == 0;
+        jobs[j].in        = in + 256 * j;
+        jobs[j].out       = out + 256 * j;
+        jobs[j].blocks    = 1 + j % 4;
+        jobs[j].user_data = &jobs[j];
+        if (jobs[j].decrypt) {
+            vistrutah_512_decrypt_blocks(jobs[j].in, expected + 256 * j, jobs[j].blocks, c->key,
+                                         c->key_size, c->rounds);
+        } else {
+            vistrutah_512_encrypt_blocks(jobs[j].in, expected + 256 * j, jobs[j].blocks, c->key,
+                                         c->key_size, c->rounds);
+        }
+    }
+
+    engine = vistrutah_offload_create(2, producers, 8, NULL);
+    if (engine == NULL) {
+        printf("✗ Offload engine creation failed\n");
+        failures++;
+    }
+
+    // This thread plays all producers in turn, each with its own rings
+    while (engine != NULL && received < jobs_count) {
+        for (int p = 0; p < producers; p++) {
+            vistrutah_mb_job* done;
+            size_t            j = p + producers * submitted[p];
+
+            while (j < jobs_count && vistrutah_offload_submit(engine, p, &jobs[j]) == 0) {
+                submitted[p]++;
+                j += producers;
+            }
+            while ((done = vistrutah_offload_poll(engine, p)) != NULL) {
+                if (done->user_data != &jobs[p + producers * next[p]++]) {
+                    failures++;
+                }
+                received++;
+            }
+        }
+        sched_yield();
+    }
+    if (memcmp(out, expected, 256 * jobs_count) != 0) {
+        printf("✗ Offloaded jobs differ from direct calls\n");
+        failures++;
+    }
+
+    // Jobs still queued at destruction are completed
+    memset(out, 0, 256 * jobs_count);
+    for (size_t j = 0; engine != NULL && j < 8; j++) {
+        vistrutah_offload_submit(engine, 0, &jobs[3 * j]);
+    }
+    vistrutah_offload_destroy(engine);
+    for (size_t j = 0; j < 8; j++) {
+        if (memcmp(out + 768 * j, expected + 768 * j, 64 * jobs[3 * j].blocks) != 0) {
+            printf("✗ Job queued at shutdown was not processed\n");
+            failures++;
+            break;
+        }
+    }
+
+    if (failures == 0) {
+        printf("✓ Multiple producers, mixed jobs, in-order completion, drain at shutdown\n");
+    }
+
+    free(in);
+    free(out);
+    free(expected);
+}
+
+static void
+test_autotune()
+{
+    printf("\n=== Autotuner Test ===\n");
+
+    static const int widths[] = { 1, 2, 4, 6, 8 };
+    const char*      path     = "test_vistrutah.tune";
+    const size_t     blocks   = 29;
+
+    vistrutah_kernel_config saved[VISTRUTAH_VARIANTS], tuned[VISTRUTAH_VARIANTS];
+    uint8_t                 key[64];
+    uint8_t*                plaintext = malloc(64 * blocks);
+    uint8_t*                expected  = malloc(64 * blocks);
+    uint8_t*                out       = malloc(64 * blocks);
+    int                     failures  = 0;
+
+    for (size_t i = 0; i < sizeof key; i++) {
+        key[i] = (uint8_t) (i * 19 + 4);
+    }
+    for (size_t i = 0; i < 64 * blocks; i++) {
+        plaintext[i] = (uint8_t) (i * 7 + 3);
+    }
+    memcpy(saved, vistrutah_kernel_configs, sizeof saved);
+    vistrutah_512_encrypt_blocks(plaintext, expected, blocks, key, 64,
+                                 VISTRUTAH_512_ROUNDS_LONG_512KEY);
+
+    // Every number of blocks in flight gives the same result, including
+    // ones that are not among this backend's candidates
+    for (size_t w = 0; w < sizeof widths / sizeof widths[0]; w++) {
+        vistrutah_kernel_configs[VISTRUTAH_512_ENCRYPT].blocks_in_flight = widths[w];
+        vistrutah_kernel_configs[VISTRUTAH_512_DECRYPT].blocks_in_flight = widths[w];
+        vistrutah_512_encrypt_blocks(plaintext, out, blocks, key, 64,
+                                     VISTRUTAH_512_ROUNDS_LONG_512KEY);
+        if (memcmp(out, expected, 64 * blocks) != 0) {
+            printf("✗ Encryption with %d blocks in flight differs\n", widths[w]);
+            failures++;
+        }
+        vistrutah_512_decrypt_blocks(out, out, blocks, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+        if (memcmp(out, plaintext, 64 * blocks) != 0) {
+            printf("✗ Decryption with %d blocks in flight differs\n", widths[w]);
+            failures++;
+        }
+    }
+    memcpy(vistrutah_kernel_configs, saved, sizeof saved);
+
+    // Tune and write the cache, then reload it
+    remove(path);
+    if (vistrutah_autotune(path) != 0) {
+        printf("✗ Autotuning could not write its cache\n");
+        failures++;
+    }
+    for (int v = 0; v < VISTRUTAH_VARIANTS; v++) {
+        tuned[v] = vistrutah_get_kernel_config((vistrutah_variant) v);
+    }
+
+    // No cache is written where the CPU model is unknown
+    FILE* cache = fopen(path, "r");
+
+    if (cache != NULL) {
+        fclose(cache);
+        memcpy(vistrutah_kernel_configs, saved, sizeof saved);
+        if (vistrutah_autotune(path) != 0) {
+            printf("✗ Autotuning cache could not be read back\n");
+            failures++;
+        }
+        for (int v = 0; v < VISTRUTAH_VARIANTS; v++) {
+            vistrutah_kernel_config c = vistrutah_get_kernel_config((vistrutah_variant) v);
+
+            if (strcmp(c.kernel, tuned[v].kernel) != 0 ||
+                c.blocks_in_flight != tuned[v].blocks_in_flight) {
+                printf("✗ Cached configuration differs for variant %d\n", v);
+                failures++;
+            }
+        }
+    }
+    vistrutah_512_encrypt_blocks(plaintext, out, blocks, key, 64,
+                                 VISTRUTAH_512_ROUNDS_LONG_512KEY);
+    if (memcmp(out, expected, 64 * blocks) != 0) {
+        printf("✗ Encryption with the tuned configuration differs\n");
+        failures++;
+    }
+    remove(path);
+    memcpy(vistrutah_kernel_configs, saved, sizeof saved);
+
+    if (failures == 0) {
+        printf("✓ All widths agree; tuned choice cached and reloaded (512 encrypt: %s x%d)\n",
+               tuned[VISTRUTAH_512_ENCRYPT].kernel, tuned[VISTRUTAH_512_ENCRYPT].blocks_in_flight);
+    }
+
+    free(plaintext);
+    free(expected);
+    free(out);
+}
+
+#ifdef VISTRUTAH_STATS
+static void*
+stats_thread(void* arg)
+{
+    const uint8_t* key = arg;
+    uint8_t        block[64] = { 0 };
+
+    for (int i = 0; i < 5; i++) {
+        vistrutah_512_encrypt(block, block, key, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+    }
+    return NULL;
+}
+
+static void
+test_stats()
+{
+    printf("\n=== Statistics Test ===\n");
+
+    const vistrutah_stat* e;
+    vistrutah_stats       stats, doubled;
+    vistrutah_ocb_ctx     ocb;
+    pthread_t             thread;
+    uint8_t               key[32], nonce[VISTRUTAH_OCB_NONCE_BYTES] = { 0 };
+    uint8_t               tag[VISTRUTAH_OCB_TAG_BYTES];
+    uint8_t*              buf      = calloc(100, 64);
+    int                   failures = 0;
+
+    for (size_t i = 0; i < sizeof key; i++) {
+        key[i] = (uint8_t) (i * 5 + 1);
+    }
+    vistrutah_ocb_init(&ocb, key, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+    vistrutah_stats_reset();
+
+    // Single blocks, timed one in VISTRUTAH_STATS_SAMPLE
+    for (int i = 0; i < 10; i++) {
+        vistrutah_512_encrypt(buf, buf, key, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+    }
+    // A batch large enough to always be timed
+    vistrutah_512_encrypt_blocks(buf, buf, 100, key, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+    // OCB calls the block cipher internally; only the OCB call counts
+    vistrutah_ocb_encrypt(&ocb, buf, buf, 1000, NULL, 0, nonce, tag);
+    // An exited thread still shows up; its first call is timed
+    pthread_create(&thread, NULL, stats_thread, key);
+    pthread_join(thread, NULL);
+
+    vistrutah_stats_snapshot(&stats);
+
+    e = &stats.entries[VISTRUTAH_STAT_512_ENCRYPT];
+    if (e->calls != 15 || e->bytes != 15 * 64 || e->size_timed[0] != e->timed ||
+        e->timed < 1 || e->timed > 2) {
+        printf("✗ 512_encrypt: %llu calls, %llu bytes, %llu timed\n",
+               (unsigned long long) e->calls, (unsigned long long) e->bytes,
+               (unsigned long long) e->timed);
+        failures++;
+    }
+    e = &stats.entries[VISTRUTAH_STAT_512_ENCRYPT_BLOCKS];
+    if (e->calls != 1 || e->bytes != 6400 || e->timed != 1 || e->size_timed[4] != 1 ||
+        e->cycles == 0) {
+        printf("✗ 512_encrypt_blocks: %llu calls, %llu bytes, %llu timed\n",
+               (unsigned long long) e->calls, (unsigned long long) e->bytes,
+               (unsigned long long) e->timed);
+        failures++;
+    }
+    e = &stats.entries[VISTRUTAH_STAT_OCB_ENCRYPT];
+    if (e->calls != 1 || e->bytes != 1000 || e->size_timed[2] != e->timed) {
+        printf("✗ ocb_encrypt: %llu calls, %llu bytes\n", (unsigned long long) e->calls,
+               (unsigned long long) e->bytes);
+        failures++;
+    }
+
+    uint64_t histogram_total = 0;
+
+    for (int i = 0; i < VISTRUTAH_STATS_BUCKETS; i++) {
+        histogram_total += stats.entries[VISTRUTAH_STAT_512_ENCRYPT].histogram[i];
+    }
+    if (histogram_total != stats.entries[VISTRUTAH_STAT_512_ENCRYPT].timed) {
+        printf("✗ Histogram does not add up to the timed calls\n");
+        failures++;
+    }
+
+    memcpy(&doubled, &stats, sizeof stats);
+    vistrutah_stats_merge(&doubled, &stats);
+    if (doubled.entries[VISTRUTAH_STAT_512_ENCRYPT].calls != 30) {
+        printf("✗ Merge did not add the counters\n");
+        failures++;
+    }
+
+    FILE* f = tmpfile();
+    char  json[8192] = { 0 };
+
+    if (f == NULL || vistrutah_stats_write_json(&stats, f) != 0) {
+        printf("✗ JSON could not be written\n");
+        failures++;
+    } else {
+        rewind(f);
+        fread(json, 1, sizeof json - 1, f);
+        if (strstr(json, "\"ocb_encrypt\": {\"calls\": 1, \"bytes\": 1000") == NULL ||
+            strstr(json, "\"512_decrypt\"") != NULL || json[strlen(json) - 2] != '}') {
+            printf("✗ Unexpected JSON: %s\n", json);
+            failures++;
+        }
+    }
+    if (f != NULL) {
+        fclose(f);
+    }
+
+    vistrutah_stats_reset();
+    vistrutah_stats_snapshot(&stats);
+    for (int i = 0; i < VISTRUTAH_STAT_ENTRIES; i++) {
+        if (stats.entries[i].calls != 0) {
+            printf("✗ %s not cleared by reset\n",
+                   vistrutah_stats_entry_name((vistrutah_stat_entry) i));
+            failures++;
+        }
+    }
+
+    // The hash, key wrap and multi-buffer calls use the block cipher
+    // internally and are recorded under their own entries
+    vistrutah_512_ctx     cipher;
+    vistrutah_keywrap_ctx kw;
+    vistrutah_mb_mgr      mgr;
+    vistrutah_mb_job      job = { .ctx = &cipher, .in = buf, .out = buf, .blocks = 3 };
+
+    vistrutah_512_init(&cipher, key, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+    vistrutah_hash(buf, 1000, buf);
+    vistrutah_keywrap_init(&kw, key, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+    vistrutah_keywrap_wrap(&kw, buf, buf + 64 * 10, 2);
+    vistrutah_mb_init(&mgr, 4, 0);
+    vistrutah_mb_submit(&mgr, &job);
+    vistrutah_mb_flush(&mgr);
+    // The thread does not record again: a reset must not leave its old
+    // counters in the snapshot, nor touch them from this thread
+    pthread_create(&thread, NULL, stats_thread, key);
+    pthread_join(thread, NULL);
+    vistrutah_stats_reset();
+    vistrutah_hash(buf, 1000, buf);
+    vistrutah_stats_snapshot(&stats);
+    if (stats.entries[VISTRUTAH_STAT_HASH].calls != 1 ||
+        stats.entries[VISTRUTAH_STAT_HASH].bytes != 1000 ||
+        stats.entries[VISTRUTAH_STAT_512_ENCRYPT_BLOCKS].calls != 0 ||
+        stats.entries[VISTRUTAH_STAT_512_ENCRYPT].calls != 0) {
+        printf("✗ Hash calls recorded under the wrong entry after a reset\n");
+        failures++;
+    }
+    vistrutah_stats_reset();
+    vistrutah_keywrap_wrap(&kw, buf, buf + 64 * 10, 2);
+    vistrutah_mb_submit(&mgr, &job);
+    vistrutah_mb_flush(&mgr);
+    vistrutah_stats_snapshot(&stats);
+    if (stats.entries[VISTRUTAH_STAT_KEYWRAP_WRAP].bytes != 128 ||
+        stats.entries[VISTRUTAH_STAT_MB_DISPATCH].bytes != 192 ||
+        stats.entries[VISTRUTAH_STAT_512_ENCRYPT_BLOCKS].calls != 0 ||
+        stats.entries[VISTRUTAH_STAT_512_ENCRYPT_PTRS].calls != 0) {
+        printf("✗ Key wrap or multi-buffer calls recorded under the wrong entry\n");
+        failures++;
+    }
+
+    if (failures == 0) {
+        printf("✓ Calls, bytes, size classes, histograms, merge, reset, JSON and nested calls\n");
+    }
+    free(buf);
+}
+#endif
+
+static void
+test_ctr()
+{
+    printf("\n=== CTR Random Access Test ===\n");
+
+    const size_t total = 5000;
+
+    vistrutah_ctr_ctx ctx;
+    uint8_t           key[64];
+    uint8_t           nonce[VISTRUTAH_CTR_NONCE_BYTES];
+    uint8_t           block[64];
+    uint8_t*          plaintext = malloc(total);
+    uint8_t*          stream    = malloc(total);
+    uint8_t*          out       = malloc(total);
+    int               failures  = 0;
+
+    for (size_t i = 0; i < sizeof key; i++) {
+        key[i] = (uint8_t) (i ^ 0x5c);
+    }
+    for (size_t i = 0; i < sizeof nonce; i++) {
+        nonce[i] = (uint8_t) (i * 9);
+    }
+    for (size_t i = 0; i < total; i++) {
+        plaintext[i] = (uint8_t) (i * 31 + 4);
+    }
+
+    if (vistrutah_ctr_init(&ctx, key, 48, VISTRUTAH_512_ROUNDS_LONG_512KEY, nonce) != -1) {
+        printf("✗ Unsupported key size was accepted\n");
+        failures++;
+    }
+    vistrutah_ctr_init(&ctx, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY, nonce);
+    vistrutah_ctr_xor(&ctx, 0, plaintext, stream, total);
+
+    // Block 70 of the stream is the encryption of nonce || 70
+    memcpy(block, nonce, sizeof nonce);
+    memset(block + sizeof nonce, 0, 8);
+    block[63] = 70;
+    vistrutah_512_encrypt(block, block, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+    for (int j = 0; j < 64; j++) {
+        block[j] ^= plaintext[64 * 70 + j];
+    }
+    if (memcmp(block, stream + 64 * 70, 64) != 0) {
+        printf("✗ Keystream block does not match the counter block encryption\n");
+        failures++;
+    }
+
+    // Any range, with partial blocks at either end, matches the full stream
+    for (size_t offset = 0; offset < total; offset += 97) {
+        size_t len = (offset * 13) % 1500;
+
+        if (offset + len > total) {
+            len = total - offset;
+        }
+        vistrutah_ctr_xor(&ctx, offset, stream + offset, out, len);
+        if (memcmp(out, plaintext + offset, len) != 0) {
+            printf("✗ Range decryption at offset %zu (%zu bytes) failed\n", offset, len);
+            failures++;
+            break;
+        }
+    }
+
+    // Threads only split the work, also from an unaligned offset
+    for (int threads = 2; threads <= 8; threads *= 2) {
+        memcpy(out, stream, total);
+        vistrutah_ctr_xor_parallel(&ctx, 3, out + 3, out + 3, total - 3, threads);
+        if (memcmp(out + 3, plaintext + 3, total - 3) != 0) {
+            printf("✗ Parallel decryption with %d threads failed\n", threads);
+            failures++;
+        }
+    }
+
+    if (failures == 0) {
+        printf("✓ Counter blocks, random ranges and parallel ranges\n");
+    }
+
+    free(plaintext);
+    free(stream);
+    free(out);
+}
+
+static void
+test_reencrypt()
+{
+    printf("\n=== Re-encryption Test ===\n");
+
+    const size_t blocks = 77;
+    const size_t len    = 64 * blocks - 5;
+
+    vistrutah_512_ctx old_key, new_key;
+    vistrutah_ctr_ctx old_ctr, new_ctr;
+    uint8_t           key_a[64], key_b[32];
+    uint8_t           nonce_a[VISTRUTAH_CTR_NONCE_BYTES], nonce_b[VISTRUTAH_CTR_NONCE_BYTES];
+    uint8_t*          plaintext = malloc(64 * blocks);
+    uint8_t*          under_a   = malloc(64 * blocks);
+    uint8_t*          under_b   = malloc(64 * blocks);
+    uint8_t*          out       = malloc(64 * blocks);
+    int               failures  = 0;
+
+    for (size_t i = 0; i < sizeof key_a; i++) {
+        key_a[i] = (uint8_t) (i * 7);
+    }
+    for (size_t i = 0; i < sizeof key_b; i++) {
+        key_b[i] = (uint8_t) (0xff - i);
+    }
+    for (size_t i = 0; i < sizeof nonce_a; i++) {
+        nonce_a[i] = (uint8_t) i;
+        nonce_b[i] = (uint8_t) (i + 100);
+    }
+    for (size_t i = 0; i < 64 * blocks; i++) {
+        plaintext[i] = (uint8_t) (i * 19 + 3);
+    }
+
+    // Raw blocks, with a different key size and round count on each side
+    vistrutah_512_init(&old_key, key_a, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+    vistrutah_512_init(&new_key, key_b, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+    vistrutah_512_encrypt_blocks(plaintext, under_a, blocks, key_a, 64,
+                                 VISTRUTAH_512_ROUNDS_LONG_512KEY);
+    vistrutah_512_encrypt_blocks(plaintext, under_b, blocks, key_b, 32,
+                                 VISTRUTAH_512_ROUNDS_LONG_256KEY);
+    vistrutah_512_reencrypt_blocks(&old_key, &new_key, under_a, out, blocks);
+    if (memcmp(out, under_b, 64 * blocks) != 0) {
+        printf("✗ Block re-encryption differs from decrypt-then-encrypt\n");
+        failures++;
+    }
+    for (int threads = 2; threads <= 4; threads++) {
+        memcpy(out, under_a, 64 * blocks);
+        vistrutah_512_reencrypt_blocks_parallel(&old_key, &new_key, out, out, blocks, threads);
+        if (memcmp(out, under_b, 64 * blocks) != 0) {
+            printf("✗ Parallel in-place block re-encryption failed (%d threads)\n", threads);
+            failures++;
+        }
+    }
+
+    // CTR to CTR with a new key and nonce, for a full object and a range
+    vistrutah_ctr_init(&old_ctr, key_a, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY, nonce_a);
+    vistrutah_ctr_init(&new_ctr, key_b, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY, nonce_b);
+    vistrutah_ctr_xor(&old_ctr, 0, plaintext, under_a, len);
+    vistrutah_ctr_xor(&new_ctr, 0, plaintext, under_b, len);
+    vistrutah_ctr_reencrypt(&old_ctr, &new_ctr, 0, under_a, out, len);
+    if (memcmp(out, under_b, len) != 0) {
+        printf("✗ CTR re-encryption differs from decrypt-then-encrypt\n");
+        failures++;
+    }
+    vistrutah_ctr_reencrypt(&old_ctr, &new_ctr, 1001, under_a + 1001, out, 999);
+    if (memcmp(out, under_b + 1001, 999) != 0) {
+        printf("✗ CTR range re-encryption failed\n");
+        failures++;
+    }
+    memset(out, 0, len);
+    vistrutah_ctr_reencrypt_parallel(&old_ctr, &new_ctr, 0, under_a, out, len, 3);
+    if (memcmp(out, under_b, len) != 0) {
+        printf("✗ Parallel CTR re-encryption failed\n");
+        failures++;
+    }
+
+    if (failures == 0) {
+        printf("✓ Block and CTR re-encryption, ranges and threads\n");
+    }
+
+    free(plaintext);
+    free(under_a);
+    free(under_b);
+    free(out);
+}
+
+void
+test_ocb()
+{
+    printf("\n=== OCB AEAD Test ===\n");
+
+    static const size_t lengths[] = { 0, 1, 63, 64, 65, 127, 128, 511, 512, 513, 576, 1000, 4096 };
+    const size_t        max_len   = 4096;
+
+    vistrutah_ocb_ctx ctx;
+    uint8_t           key[64];
+    uint8_t           nonce[VISTRUTAH_OCB_NONCE_BYTES];
+    uint8_t           tag[VISTRUTAH_OCB_TAG_BYTES];
+    uint8_t           ad[100];
+    uint8_t*          plaintext  = malloc(max_len);
+    uint8_t*          ciphertext = malloc(max_len);
+    uint8_t*          decrypted  = malloc(max_len);
+    int               failures   = 0;
+
+    for (size_t i = 0; i < sizeof key; i++) {
+        key[i] = (uint8_t) (i + 1);
+    }
+    for (size_t i = 0; i < sizeof nonce; i++) {
+        nonce[i] = (uint8_t) (0xa0 + i);
+    }
+    for (size_t i = 0; i < sizeof ad; i++) {
+        ad[i] = (uint8_t) (i * 3);
+    }
+    for (size_t i = 0; i < max_len; i++) {
+        plaintext[i] = (uint8_t) (i * 7 + 1);
+    }
+
+    if (vistrutah_ocb_init(&ctx, key, 48, VISTRUTAH_512_ROUNDS_LONG_512KEY) != -1) {
+        printf("✗ Unsupported key size was accepted\n");
+        failures++;
+    }
+    vistrutah_ocb_init(&ctx, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+
+    // Round trips, with and without associated data
+    for (size_t l = 0; l < sizeof lengths / sizeof lengths[0]; l++) {
+        size_t len = lengths[l];
+
+        for (size_t ad_len = 0; ad_len <= sizeof ad; ad_len += 50) {
+            vistrutah_ocb_encrypt(&ctx, plaintext, ciphertext, len, ad, ad_len, nonce, tag);
+            memset(decrypted, 0xff, max_len);
+            if (vistrutah_ocb_decrypt(&ctx, ciphertext, decrypted, len, ad, ad_len, nonce, tag) !=
+                    0 ||
+                memcmp(decrypted, plaintext, len) != 0) {
+                printf("✗ Round trip failed (%zu bytes, %zu bytes of AD)\n", len, ad_len);
+                failures++;
+            }
+        }
+    }
+
+    // Nine blocks cover a full batch plus one block, checked against a
+    // block-at-a-time computation of the same construction
+    {
+        uint8_t offset[64], checksum[64] = { 0 }, block[64], expected[9 * 64], full_tag[64];
+        uint8_t nonce_block[64] = { 0 };
+
+        nonce_block[0]                              = VISTRUTAH_OCB_TAG_BYTES;
+        nonce_block[63 - VISTRUTAH_OCB_NONCE_BYTES] = 1;
+        memcpy(nonce_block + 64 - VISTRUTAH_OCB_NONCE_BYTES, nonce, VISTRUTAH_OCB_NONCE_BYTES);
+        vistrutah_512_encrypt(nonce_block, offset, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+
+        for (int i = 1; i <= 9; i++) {
+            int ntz = __builtin_ctz(i);
+
+            for (int j = 0; j < 64; j++) {
+                offset[j] ^= ctx.L[ntz][j];
+                checksum[j] ^= plaintext[64 * (i - 1) + j];
+                block[j] = plaintext[64 * (i - 1) + j] ^ offset[j];
+            }
+            vistrutah_512_encrypt(block, block, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+            for (int j = 0; j < 64; j++) {
+                expected[64 * (i - 1) + j] = block[j] ^ offset[j];
+            }
+        }
+        for (int j = 0; j < 64; j++) {
+            block[j] = checksum[j] ^ offset[j] ^ ctx.L_dollar[j];
+        }
+        vistrutah_512_encrypt(block, full_tag, key, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+
+        vistrutah_ocb_encrypt(&ctx, plaintext, ciphertext, 9 * 64, NULL, 0, nonce, tag);
+        if (memcmp(ciphertext, expected, 9 * 64) != 0 ||
+            memcmp(tag, full_tag, VISTRUTAH_OCB_TAG_BYTES) != 0) {
+            printf("✗ Batched OCB does not match the block-at-a-time computation\n");
+            failures++;
+        }
+    }
+
+    // In-place operation
+    memcpy(decrypted, plaintext, 1000);
+    vistrutah_ocb_encrypt(&ctx, decrypted, decrypted, 1000, ad, sizeof ad, nonce, tag);
+    vistrutah_ocb_encrypt(&ctx, plaintext, ciphertext, 1000, ad, sizeof ad, nonce, tag);
+    if (memcmp(decrypted, ciphertext, 1000) != 0 ||
+        vistrutah_ocb_decrypt(&ctx, decrypted, decrypted, 1000, ad, sizeof ad, nonce, tag) != 0 ||
+        memcmp(decrypted, plaintext, 1000) != 0) {
+        printf("✗ In-place encryption/decryption failed\n");
+        failures++;
+    }
+
+    // Forgeries must be rejected, and the output wiped
+    vistrutah_ocb_encrypt(&ctx, plaintext, ciphertext, 1000, ad, sizeof ad, nonce, tag);
+    ciphertext[500] ^= 1;
+    if (vistrutah_ocb_decrypt(&ctx, ciphertext, decrypted, 1000, ad, sizeof ad, nonce, tag) != -1) {
+        printf("✗ Modified ciphertext was accepted\n");
+        failures++;
+    }
+    for (size_t i = 0; i < 1000; i++) {
+        if (decrypted[i] != 0) {
+            printf("✗ Plaintext not cleared after a failed verification\n");
+            failures++;
+            break;
+        }
+    }
+    ciphertext[500] ^= 1;
+    ad[0] ^= 1;
+    if (vistrutah_ocb_decrypt(&ctx, ciphertext, decrypted, 1000, ad, sizeof ad, nonce, tag) != -1) {
+        printf("✗ Modified associated data was accepted\n");
+        failures++;
+    }
+    ad[0] ^= 1;
+    tag[VISTRUTAH_OCB_TAG_BYTES - 1] ^= 0x80;
+    if (vistrutah_ocb_decrypt(&ctx, ciphertext, decrypted, 1000, ad, sizeof ad, nonce, tag) != -1) {
+        printf("✗ Modified tag was accepted\n");
+        failures++;
+    }
+    tag[VISTRUTAH_OCB_TAG_BYTES - 1] ^= 0x80;
+    nonce[0] ^= 1;
+    if (vistrutah_ocb_decrypt(&ctx, ciphertext, decrypted, 1000, ad, sizeof ad, nonce, tag) != -1) {
+        printf("✗ Wrong nonce was accepted\n");
+        failures++;
+    }
+
+    if (failures == 0) {
+        printf("✓ Round trips, batching, in-place use and forgery rejection\n");
+    }
+
+    free(plaintext);
+    free(ciphertext);
+    free(decrypted);
+}
+
+static void
+test_siv()
+{
+    printf("\n=== SIV Deterministic AEAD Test ===\n");
+
+    static const size_t lengths[] = { 0, 1, 63, 64, 65, 511, 512, 513, 1000, 4096, 10000 };
+    const size_t        max_len   = 10000;
+
+    vistrutah_siv_ctx ctx;
+    uint8_t           key[32];
+    uint8_t           siv[VISTRUTAH_SIV_BYTES];
+    uint8_t           siv2[VISTRUTAH_SIV_BYTES];
+    uint8_t           ad[100];
+    uint8_t*          plaintext  = malloc(max_len);
+    uint8_t*          ciphertext = malloc(max_len);
+    uint8_t*          decrypted  = malloc(max_len);
+    int               failures   = 0;
+
+    for (size_t i = 0; i < sizeof key; i++) {
+        key[i] = (uint8_t) (0x40 + i);
+    }
+    for (size_t i = 0; i < sizeof ad; i++) {
+        ad[i] = (uint8_t) (i * 5 + 2);
+    }
+    for (size_t i = 0; i < max_len; i++) {
+        plaintext[i] = (uint8_t) (i * 11 + 3);
+    }
+
+    if (vistrutah_siv_init(&ctx, key, 16, VISTRUTAH_512_ROUNDS_LONG_256KEY) != -1) {
+        printf("✗ Unsupported key size was accepted\n");
+        failures++;
+    }
+    vistrutah_siv_init(&ctx, key, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+
+    // Round trips, and the one-shot API against the streamed passes fed in
+    // uneven chunks
+    for (size_t l = 0; l < sizeof lengths / sizeof lengths[0]; l++) {
+        size_t len = lengths[l];
+
+        for (size_t ad_len = 0; ad_len <= sizeof ad; ad_len += 50) {
+            vistrutah_siv_mac_state mac;
+            vistrutah_siv_ctr_state ctr;
+
+            vistrutah_siv_encrypt(&ctx, plaintext, ciphertext, len, ad, ad_len, siv);
+            memset(decrypted, 0xff, max_len);
+            if (vistrutah_siv_decrypt(&ctx, ciphertext, decrypted, len, ad, ad_len, siv) != 0 ||
+                memcmp(decrypted, plaintext, len) != 0) {
+                printf("✗ Round trip failed (%zu bytes, %zu bytes of AD)\n", len, ad_len);
+                failures++;
+            }
+
+            vistrutah_siv_mac_init(&mac, &ctx, ad, ad_len);
+            for (size_t pos = 0, chunk = 1; pos < len; pos += chunk, chunk = chunk * 3 + 1) {
+                size_t n = chunk < len - pos ? chunk : len - pos;
+
+                vistrutah_siv_mac_update(&mac, plaintext + pos, n);
+            }
+            vistrutah_siv_mac_final(&mac, siv2);
+            vistrutah_siv_ctr_init(&ctr, &ctx, siv2);
+            for (size_t pos = 0, chunk = 7; pos < len; pos += chunk, chunk = chunk * 2 + 5) {
+                size_t n = chunk < len - pos ? chunk : len - pos;
+
+                vistrutah_siv_ctr_update(&ctr, plaintext + pos, decrypted + pos, n);
+            }
+            if (memcmp(siv, siv2, sizeof siv) != 0 || memcmp(ciphertext, decrypted, len) != 0) {
+                printf("✗ Streaming does not match one-shot (%zu bytes, %zu bytes of AD)\n", len,
+                       ad_len);
+                failures++;
+            }
+        }
+    }
+
+    // Deterministic: same inputs, same output; any change moves the SIV
+    vistrutah_siv_encrypt(&ctx, plaintext, ciphertext, 1000, ad, sizeof ad, siv);
+    vistrutah_siv_encrypt(&ctx, plaintext, decrypted, 1000, ad, sizeof ad, siv2);
+    if (memcmp(siv, siv2, sizeof siv) != 0 || memcmp(ciphertext, decrypted, 1000) != 0) {
+        printf("✗ Encryption is not deterministic\n");
+        failures++;
+    }
+    vistrutah_siv_encrypt(&ctx, plaintext, decrypted, 1000, ad, sizeof ad - 1, siv2);
+    if (memcmp(siv, siv2, sizeof siv) == 0) {
+        printf("✗ Associated data does not affect the SIV\n");
+        failures++;
+    }
+    vistrutah_siv_encrypt(&ctx, plaintext, decrypted, 999, ad, sizeof ad, siv2);
+    if (memcmp(siv, siv2, sizeof siv) == 0) {
+        printf("✗ Message length does not affect the SIV\n");
+        failures++;
+    }
+
+    // In-place operation
+    memcpy(decrypted, plaintext, 1000);
+    vistrutah_siv_encrypt(&ctx, decrypted, decrypted, 1000, ad, sizeof ad, siv2);
+    if (memcmp(decrypted, ciphertext, 1000) != 0 ||
+        vistrutah_siv_decrypt(&ctx, decrypted, decrypted, 1000, ad, sizeof ad, siv2) != 0 ||
+        memcmp(decrypted, plaintext, 1000) != 0) {
+        printf("✗ In-place encryption/decryption failed\n");
+        failures++;
+    }
+
+    // Forgeries must be rejected, and the output wiped
+    ciphertext[700] ^= 4;
+    if (vistrutah_siv_decrypt(&ctx, ciphertext, decrypted, 1000, ad, sizeof ad, siv) != -1) {
+        printf("✗ Modified ciphertext was accepted\n");
+        failures++;
+    }
+    for (size_t i = 0; i < 1000; i++) {
+        if (decrypted[i] != 0) {
+            printf("✗ Plaintext not cleared after a failed verification\n");
+            failures++;
+            break;
+        }
+    }
+    ciphertext[700] ^= 4;
+    ad[99] ^= 1;
+    if (vistrutah_siv_decrypt(&ctx, ciphertext, decrypted, 1000, ad, sizeof ad, siv) != -1) {
+        printf("✗ Modified associated data was accepted\n");
+        failures++;
+    }
+    ad[99] ^= 1;
+    siv[0] ^= 1;
+    if (vistrutah_siv_decrypt(&ctx, ciphertext, decrypted, 1000, ad, sizeof ad, siv) != -1) {
+        printf("✗ Modified SIV was accepted\n");
+        failures++;
+    }
+
+    if (failures == 0) {
+        printf("✓ Round trips, streaming, determinism, in-place use and forgery rejection\n");
+    }
+
+    free(plaintext);
+    free(ciphertext);
+    free(decrypted);
+}
+
+static void
+hash_ref_chunk(const uint8_t* in, size_t len, uint64_t counter, uint8_t flags, uint8_t* cv)
+{
+    size_t blocks = len > 0 ? (len + 63) / 64 : 1;
+
+    memset(cv, 0, 64);
+    for (size_t j = 0; j < blocks; j++) {
+        uint8_t x[64], y[64] = { 0 };
+        size_t  block_len = len - 64 * j < 64 ? len - 64 * j : 64;
+
+        memcpy(x, cv, 64);
+        for (int i = 0; i < 8; i++) {
+            x[i] ^= (uint8_t) (counter >> (8 * i));
+        }
+        x[8] ^= (uint8_t) block_len;
+        x[9] ^= (j == 0 ? 0x01 : 0) | (j == blocks - 1 ? 0x02 | flags : 0);
+        memcpy(y, in + 64 * j, block_len);
+        vistrutah_512_compress(cv, x, y);
+    }
+}
+
+static void
+hash_ref_parent(const uint8_t* left, const uint8_t* right, uint8_t flags, uint8_t* out)
+{
+    uint8_t x[64];
+
+    memcpy(x, left, 64);
+    x[8] ^= 64;
+    x[9] ^= 0x04 | flags;
+    vistrutah_512_compress(out, x, right);
+}
+
+static void
+test_hash()
+{
+    printf("\n=== Vistrutah-512 Hash Test ===\n");
+
+    static const size_t lengths[] = { 0,    1,    63,   64,   65,   1023,  1024,
+                                      1025, 2048, 3000, 8193, 20000, 100000 };
+    const size_t        max_len   = 100000;
+
+    uint8_t* msg = malloc(max_len);
+    uint8_t  expected[VISTRUTAH_HASH_BYTES];
+    uint8_t  digest[VISTRUTAH_HASH_BYTES];
+    int      failures = 0;
+
+    for (size_t i = 0; i < max_len; i++) {
+        msg[i] = (uint8_t) (i * 13 + (i >> 8));
+    }
+
+    // Three chunks, against a compression-at-a-time computation of the tree
+    {
+        uint8_t c0[64], c1[64], c2[64], p01[64];
+
+        hash_ref_chunk(msg, 1024, 0, 0, c0);
+        hash_ref_chunk(msg + 1024, 1024, 1, 0, c1);
+        hash_ref_chunk(msg + 2048, 952, 2, 0, c2);
+        hash_ref_parent(c0, c1, 0, p01);
+        hash_ref_parent(p01, c2, 0x08, expected);
+
+        vistrutah_hash(msg, 3000, digest);
+        if (memcmp(digest, expected, sizeof digest) != 0) {
+            printf("✗ Tree hash does not match the reference computation\n");
+            failures++;
+        }
+        hash_ref_chunk(msg, 100, 0, 0x08, expected);
+        vistrutah_hash(msg, 100, digest);
+        if (memcmp(digest, expected, sizeof digest) != 0) {
+            printf("✗ Single-chunk hash does not match the reference computation\n");
+            failures++;
+        }
+    }
+
+    // Incremental, threaded and multi-buffer interfaces agree with one-shot
+    const uint8_t* inputs[sizeof lengths / sizeof lengths[0]];
+    uint8_t        digests[sizeof lengths / sizeof lengths[0]][VISTRUTAH_HASH_BYTES];
+    uint8_t        many[sizeof lengths / sizeof lengths[0] * VISTRUTAH_HASH_BYTES];
+
+    for (size_t l = 0; l < sizeof lengths / sizeof lengths[0]; l++) {
+        size_t               len = lengths[l];
+        vistrutah_hash_state st;
+
+        vistrutah_hash(msg, len, digests[l]);
+        inputs[l] = msg;
+
+        vistrutah_hash_init(&st);
+        for (size_t pos = 0, chunk = 1; pos < len; pos += chunk, chunk = chunk * 2 + 3) {
+            size_t n = chunk < len - pos ? chunk : len - pos;
+
+            vistrutah_hash_update(&st, msg + pos, n);
+        }
+        vistrutah_hash_final(&st, digest);
+        if (memcmp(digest, digests[l], sizeof digest) != 0) {
+            printf("✗ Incremental hash differs (%zu bytes)\n", len);
+            failures++;
+        }
+
+        for (int threads = 2; threads <= 7; threads += 5) {
+            if (vistrutah_hash_parallel(msg, len, digest, threads) != 0 ||
+                memcmp(digest, digests[l], sizeof digest) != 0) {
+                printf("✗ Threaded hash differs (%zu bytes, %d threads)\n", len, threads);
+                failures++;
+            }
+        }
+
+        for (size_t m = 0; m < l; m++) {
+            if (memcmp(digests[m], digests[l], sizeof digest) == 0) {
+                printf("✗ Messages of %zu and %zu bytes collide\n", lengths[m], len);
+                failures++;
+            }
+        }
+    }
+
+    vistrutah_hash_many(inputs, lengths, sizeof lengths / sizeof lengths[0], many);
+    if (memcmp(many, digests, sizeof many) != 0) {
+        printf("✗ Multi-buffer hash differs from one-shot\n");
+        failures++;
+    }
+
+    if (failures == 0) {
+        printf("✓ Tree structure, incremental, threaded and multi-buffer hashing\n");
+    }
+
+    free(msg);
+}
+
+static void
+test_permutation_xof()
+{
+    printf("\n=== Permutation and XOF Test ===\n");
+
+    uint8_t state[64], expected[64];
+    uint8_t msg[300];
+    uint8_t out[300], out2[300];
+    int     failures = 0;
+
+    for (size_t i = 0; i < sizeof msg; i++) {
+        msg[i] = (uint8_t) (i * 29 + 7);
+    }
+
+    // The baked-in round keys must give Vistrutah-512 under the fixed key
+    for (int t = 0; t < 4; t++) {
+        memcpy(state, msg + 64 * t, 64);
+        vistrutah_512_encrypt(state, expected, VISTRUTAH_PERMUTATION_KEY, 64,
+                              VISTRUTAH_PERMUTATION_ROUNDS);
+        vistrutah_512_permute(state);
+        if (memcmp(state, expected, 64) != 0) {
+            printf("✗ Permutation does not match Vistrutah-512 under the fixed key\n");
+            failures++;
+            break;
+        }
+    }
+
+    // Streaming absorb and squeeze agree with the one-shot call
+    static const size_t rates[] = { 1, 16, 32, 48, 63 };
+
+    for (size_t r = 0; r < sizeof rates / sizeof rates[0]; r++) {
+        for (size_t len = 0; len <= sizeof msg; len += 37) {
+            vistrutah_xof_state st;
+
+            vistrutah_xof(msg, len, out, sizeof out, rates[r]);
+
+            vistrutah_xof_init(&st, rates[r]);
+            for (size_t pos = 0, chunk = 1; pos < len; pos += chunk, chunk += 5) {
+                size_t n = chunk < len - pos ? chunk : len - pos;
+
+                vistrutah_xof_absorb(&st, msg + pos, n);
+            }
+            for (size_t pos = 0, chunk = 3; pos < sizeof out2; pos += chunk, chunk += 11) {
+                size_t n = chunk < sizeof out2 - pos ? chunk : sizeof out2 - pos;
+
+                vistrutah_xof_squeeze(&st, out2 + pos, n);
+            }
+            if (memcmp(out, out2, sizeof out) != 0) {
+                printf("✗ Streaming XOF differs (rate %zu, %zu bytes)\n", rates[r], len);
+                failures++;
+            }
+        }
+    }
+
+    // Shorter outputs are prefixes of longer ones
+    vistrutah_xof(msg, 100, out, 300, VISTRUTAH_XOF_DEFAULT_RATE);
+    vistrutah_xof(msg, 100, out2, 77, VISTRUTAH_XOF_DEFAULT_RATE);
+    if (memcmp(out, out2, 77) != 0) {
+        printf("✗ XOF output is not prefix-consistent\n");
+        failures++;
+    }
+
+    // A full last block and a padded one must not collide
+    memcpy(state, msg, 32);
+    state[31] = 0x01;
+    vistrutah_xof(state, 31, out, 64, 32);
+    vistrutah_xof(state, 32, out2, 64, 32);
+    if (memcmp(out, out2, 64) == 0) {
+        printf("✗ Full and padded final blocks collide\n");
+        failures++;
+    }
+
+    // The rate is part of the domain
+    vistrutah_xof(msg, 100, out, 64, 32);
+    vistrutah_xof(msg, 100, out2, 64, 48);
+    if (memcmp(out, out2, 64) == 0) {
+        printf("✗ Different rates give the same output\n");
+        failures++;
+    }
+
+    if (vistrutah_xof(msg, 10, out, 10, 0) != -1 || vistrutah_xof(msg, 10, out, 10, 64) != -1) {
+        printf("✗ Invalid rate was accepted\n");
+        failures++;
+    }
+
+    if (failures == 0) {
+        printf("✓ Fixed-key permutation, streaming, prefixes, padding and rates\n");
+    }
+}
+
+static void
+deck_ref_double(uint8_t* x)
+{
+    uint8_t carry = x[0] >> 7;
+
+    for (int i = 0; i < 63; i++) {
+        x[i] = (uint8_t) (x[i] << 1 | x[i + 1] >> 7);
+    }
+    x[63] = (uint8_t) (x[63] << 1);
+    if (carry) {
+        x[62] ^= 0x01;
+        x[63] ^= 0x25;
+    }
+}
+
+static void
+test_deck()
+{
+    printf("\n=== Deck Function Test ===\n");
+
+    vistrutah_deck_ctx ctx, ctx2;
+    uint8_t            key[32];
+    uint8_t            msg[700];
+    uint8_t            out[1000], out2[1000];
+    int                failures = 0;
+
+    for (size_t i = 0; i < sizeof key; i++) {
+        key[i] = (uint8_t) (0x40 + i);
+    }
+    for (size_t i = 0; i < sizeof msg; i++) {
+        msg[i] = (uint8_t) (i * 13 + 5);
+    }
+
+    // A nine-block string covers a full batch plus one block; the first
+    // output block is checked against a block-at-a-time computation
+    {
+        uint8_t mask[64] = { 0 }, acc[64] = { 0 }, block[64], y[64];
+        size_t  len      = 8 * 64 + 63;
+
+        memcpy(mask, key, sizeof key);
+        mask[sizeof key] = 0x01;
+        vistrutah_512_encrypt(mask, mask, VISTRUTAH_PERMUTATION_KEY, 64,
+                              VISTRUTAH_512_ROUNDS_LONG_512KEY);
+        for (size_t i = 0; i < 9; i++) {
+            size_t n = i < 8 ? 64 : len - 64 * 8;
+
+            memset(block, 0, 64);
+            memcpy(block, msg + 64 * i, n);
+            if (n < 64) {
+                block[n] = 0x01;
+            }
+            for (int j = 0; j < 64; j++) {
+                block[j] ^= mask[j];
+            }
+            vistrutah_512_encrypt(block, block, VISTRUTAH_PERMUTATION_KEY, 64,
+                                  VISTRUTAH_512_ROUNDS_SHORT_512KEY);
+            for (int j = 0; j < 64; j++) {
+                acc[j] ^= block[j];
+            }
+            deck_ref_double(mask);
+        }
+        deck_ref_double(mask);
+        vistrutah_512_encrypt(acc, y, VISTRUTAH_PERMUTATION_KEY, 64,
+                              VISTRUTAH_512_ROUNDS_LONG_512KEY);
+        vistrutah_512_encrypt(y, block, VISTRUTAH_PERMUTATION_KEY, 64,
+                              VISTRUTAH_512_ROUNDS_SHORT_512KEY);
+        for (int j = 0; j < 64; j++) {
+            block[j] ^= mask[j];
+        }
+
+        vistrutah_deck_init(&ctx, key, sizeof key);
+        vistrutah_deck_absorb(&ctx, msg, len);
+        vistrutah_deck_squeeze(&ctx, 0, out, 64);
+        if (memcmp(out, block, 64) != 0) {
+            printf("✗ Batched deck absorb does not match the block-at-a-time computation\n");
+            failures++;
+        }
+    }
+
+    // Any window of the output matches the same bytes of a longer squeeze
+    vistrutah_deck_init(&ctx, key, sizeof key);
+    vistrutah_deck_absorb(&ctx, msg, 100);
+    vistrutah_deck_absorb(&ctx, msg + 100, 300);
+    vistrutah_deck_squeeze(&ctx, 0, out, sizeof out);
+    for (size_t offset = 0; offset < 700; offset += 97) {
+        size_t len = (offset * 7) % 300 + 1;
+
+        vistrutah_deck_squeeze(&ctx, offset, out2, len);
+        if (memcmp(out + offset, out2, len) != 0) {
+            printf("✗ Squeeze at offset %zu differs from the full output\n", offset);
+            failures++;
+        }
+    }
+
+    // Squeezing does not consume anything; absorbing more continues the sequence
+    ctx2 = ctx;
+    vistrutah_deck_absorb(&ctx2, msg, 10);
+    vistrutah_deck_squeeze(&ctx, 0, out2, 64);
+    if (memcmp(out, out2, 64) != 0) {
+        printf("✗ Squeezing changed the deck state\n");
+        failures++;
+    }
+    vistrutah_deck_squeeze(&ctx2, 0, out2, 64);
+    if (memcmp(out, out2, 64) == 0) {
+        printf("✗ Absorbing another string did not change the output\n");
+        failures++;
+    }
+
+    // String boundaries are part of the input: one string made of a padded
+    // first string followed by a second must not match the two strings
+    {
+        uint8_t joined[74];
+
+        memcpy(joined, msg, 63);
+        joined[63] = 0x01;
+        memcpy(joined + 64, msg + 63, 10);
+
+        vistrutah_deck_init(&ctx, key, sizeof key);
+        vistrutah_deck_absorb(&ctx, msg, 63);
+        vistrutah_deck_absorb(&ctx, msg + 63, 10);
+        vistrutah_deck_squeeze(&ctx, 0, out, 64);
+
+        vistrutah_deck_init(&ctx, key, sizeof key);
+        vistrutah_deck_absorb(&ctx, joined, sizeof joined);
+        vistrutah_deck_squeeze(&ctx, 0, out2, 64);
+        if (memcmp(out, out2, 64) == 0) {
+            printf("✗ Two strings collide with their padded concatenation\n");
+            failures++;
+        }
+
+        vistrutah_deck_init(&ctx, key, sizeof key);
+        vistrutah_deck_absorb(&ctx, msg + 63, 10);
+        vistrutah_deck_absorb(&ctx, msg, 63);
+        vistrutah_deck_squeeze(&ctx, 0, out2, 64);
+        if (memcmp(out, out2, 64) == 0) {
+            printf("✗ String order does not affect the output\n");
+            failures++;
+        }
+
+        vistrutah_deck_init(&ctx, key, sizeof key);
+        vistrutah_deck_absorb(&ctx, NULL, 0);
+        vistrutah_deck_squeeze(&ctx, 0, out, 64);
+        vistrutah_deck_init(&ctx, key, sizeof key);
+        vistrutah_deck_squeeze(&ctx, 0, out2, 64);
+        if (memcmp(out, out2, 64) == 0) {
+            printf("✗ An empty string is not distinguished from no input\n");
+            failures++;
+        }
+    }
+
+    // The key matters, and only valid key lengths are accepted
+    vistrutah_deck_init(&ctx, key, sizeof key);
+    vistrutah_deck_absorb(&ctx, msg, 100);
+    vistrutah_deck_squeeze(&ctx, 0, out, 64);
+    key[0] ^= 1;
+    vistrutah_deck_init(&ctx, key, sizeof key);
+    vistrutah_deck_absorb(&ctx, msg, 100);
+    vistrutah_deck_squeeze(&ctx, 0, out2, 64);
+    if (memcmp(out, out2, 64) == 0) {
+        printf("✗ Different keys give the same output\n");
+        failures++;
+    }
+    if (vistrutah_deck_init(&ctx, key, 0) != -1 || vistrutah_deck_init(&ctx, msg, 64) != -1 ||
+        vistrutah_deck_init(&ctx, msg, 63) != 0) {
+        printf("✗ Key length checks are wrong\n");
+        failures++;
+    }
+
+    if (failures == 0) {
+        printf("✓ Batched absorb, output windows, string boundaries and keys\n");
+    }
+}
+
+static void
+test_kdf()
+{
+    printf("\n=== Key Derivation Test ===\n");
+
+    static const uint8_t label[] = "tenant-object-key";
+    const size_t         count   = 1000;
+
+    vistrutah_kdf_ctx ctx;
+    uint8_t           master[64];
+    uint8_t           block[64];
+    uint64_t*         counters = malloc(count * sizeof *counters);
+    uint8_t*          keys     = malloc(count * 64);
+    uint8_t*          keys2    = malloc(count * 64);
+    int               failures = 0;
+
+    for (size_t i = 0; i < sizeof master; i++) {
+        master[i] = (uint8_t) (i * 5 + 3);
+    }
+    for (size_t i = 0; i < count; i++) {
+        counters[i] = (uint64_t) i * 0x9e3779b97f4a7c15ULL;
+    }
+
+    vistrutah_kdf_init(&ctx, master, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY, label,
+                       sizeof label - 1);
+
+    // Each derived key is one block encryption of the documented input
+    for (size_t key_bytes = 32; key_bytes <= 64; key_bytes += 32) {
+        vistrutah_kdf_derive(&ctx, counters, count, keys, key_bytes);
+        for (size_t i = 0; i < count; i += 111) {
+            memset(block, 0, sizeof block);
+            memcpy(block, label, sizeof label - 1);
+            block[54] = sizeof label - 1;
+            block[55] = (uint8_t) key_bytes;
+            for (int k = 0; k < 8; k++) {
+                block[63 - k] = (uint8_t) (counters[i] >> (8 * k));
+            }
+            vistrutah_512_encrypt(block, block, master, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY);
+            if (memcmp(keys + key_bytes * i, block, key_bytes) != 0) {
+                printf("✗ Derived %zu-byte key %zu does not match a single encryption\n",
+                       key_bytes, i);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    // The output length is part of the input
+    vistrutah_kdf_derive(&ctx, counters, 1, keys, 64);
+    vistrutah_kdf_derive(&ctx, counters, 1, keys2, 32);
+    if (memcmp(keys, keys2, 32) == 0) {
+        printf("✗ A 256-bit key is a prefix of the 512-bit key\n");
+        failures++;
+    }
+
+    // Threads only split the work
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        vistrutah_kdf_derive(&ctx, counters, count, keys, 32);
+        memset(keys2, 0, count * 32);
+        if (vistrutah_kdf_derive_parallel(&ctx, counters, count, keys2, 32, threads) != 0 ||
+            memcmp(keys, keys2, count * 32) != 0) {
+            printf("✗ Parallel derivation with %d threads differs\n", threads);
+            failures++;
+        }
+    }
+
+    // A different label gives unrelated keys
+    vistrutah_kdf_init(&ctx, master, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY, label, 6);
+    vistrutah_kdf_derive(&ctx, counters, 1, keys2, 32);
+    if (memcmp(keys, keys2, 32) == 0) {
+        printf("✗ Different labels give the same key\n");
+        failures++;
+    }
+
+    if (vistrutah_kdf_init(&ctx, master, 48, VISTRUTAH_512_ROUNDS_LONG_512KEY, NULL, 0) != -1 ||
+        vistrutah_kdf_init(&ctx, master, 64, VISTRUTAH_512_ROUNDS_LONG_512KEY, master, 55) != -1 ||
+        vistrutah_kdf_derive(&ctx, counters, 1, keys, 16) != -1) {
+        printf("✗ Invalid parameters were accepted\n");
+        failures++;
+    }
+
+    if (failures == 0) {
+        printf("✓ Single-block derivation, output lengths, threads and labels\n");
+    }
+
+    free(counters);
+    free(keys);
+    free(keys2);
+}
+
+static void
+test_keywrap()
+{
+    printf("\n=== Key Wrap Test ===\n");
+
+    const size_t count = 100;
+
+    vistrutah_keywrap_ctx ctx;
+    uint8_t               kek[32];
+    uint8_t               block[64];
+    uint8_t               valid[100];
+    uint8_t*              keys      = malloc(count * VISTRUTAH_KEYWRAP_KEY_BYTES);
+    uint8_t*              wrapped   = malloc(count * VISTRUTAH_KEYWRAP_WRAPPED_BYTES);
+    uint8_t*              unwrapped = malloc(count * VISTRUTAH_KEYWRAP_KEY_BYTES);
+    int                   failures  = 0;
+
+    for (size_t i = 0; i < sizeof kek; i++) {
+        kek[i] = (uint8_t) (0xf0 - i);
+    }
+    for (size_t i = 0; i < count * VISTRUTAH_KEYWRAP_KEY_BYTES; i++) {
+        keys[i] = (uint8_t) (i * 11 + 2);
+    }
+
+    if (vistrutah_keywrap_init(&ctx, kek, 128, VISTRUTAH_512_ROUNDS_LONG_512KEY) != -1) {
+        printf("✗ Unsupported key size was accepted\n");
+        failures++;
+    }
+    vistrutah_keywrap_init(&ctx, kek, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+    vistrutah_keywrap_wrap(&ctx, keys, wrapped, count);
+
+    // A wrapped key is one encryption of the header followed by the key
+    memset(block, 0xa6, 32);
+    memcpy(block + 32, keys + 32 * 17, 32);
+    vistrutah_512_encrypt(block, block, kek, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+    if (memcmp(block, wrapped + 64 * 17, 64) != 0) {
+        printf("✗ Wrapped key does not match a single encryption\n");
+        failures++;
+    }
+
+    if (vistrutah_keywrap_unwrap(&ctx, wrapped, unwrapped, count, valid) != 0 ||
+        memcmp(unwrapped, keys, count * VISTRUTAH_KEYWRAP_KEY_BYTES) != 0) {
+        printf("✗ Round trip failed\n");
+        failures++;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (valid[i] != 1) {
+            printf("✗ Valid wrapped key %zu was flagged\n", i);
+            failures++;
+            break;
+        }
+    }
+
+    // A modified wrapped key fails alone, and its output is zeroed
+    wrapped[64 * 42 + 63] ^= 0x10;
+    if (vistrutah_keywrap_unwrap(&ctx, wrapped, unwrapped, count, valid) != -1) {
+        printf("✗ Modified wrapped key was accepted\n");
+        failures++;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* k        = unwrapped + 32 * i;
+        int            expected = i != 42;
+
+        if (valid[i] != expected || (expected && memcmp(k, keys + 32 * i, 32) != 0)) {
+            printf("✗ Wrong result for key %zu after a modification\n", i);
+            failures++;
+            break;
+        }
+    }
+    for (int t = 0; t < 32; t++) {
+        if (unwrapped[32 * 42 + t] != 0) {
+            printf("✗ Rejected key was not zeroed\n");
+            failures++;
+            break;
+        }
+    }
+    wrapped[64 * 42 + 63] ^= 0x10;
+
+    // A different KEK rejects everything
+    kek[0] ^= 1;
+    vistrutah_keywrap_init(&ctx, kek, 32, VISTRUTAH_512_ROUNDS_LONG_256KEY);
+    if (vistrutah_keywrap_unwrap(&ctx, wrapped, unwrapped, count, NULL) != -1) {
+        printf("✗ Wrong KEK was accepted\n");
+        failures++;
+    }
+
+    if (failures == 0) {
+        printf("✓ Single-block wrapping, round trips and per-key rejection\n");
+    }
+
+    free(keys);
+    free(wrapped);
+    free(unwrapped);
+}
+
 int
 main()
 {
@@ -808,6 +2760,32 @@ main()
     // Edge cases and consistency
     test_edge_cases();
     test_consistency();
+    test_batch_api();
+    test_strided();
+    test_pointer_arrays();
+    test_crc32c();
+    test_streaming_stores();
+    test_job_manager();
+    test_offload();
+    test_autotune();
+#ifdef VISTRUTAH_STATS
+    test_stats();
+#endif
+
+    // Modes of operation
+    test_ctr();
+    test_reencrypt();
+    test_ocb();
+    test_siv();
+
+    // Hashing
+    test_hash();
+    test_permutation_xof();
+    test_deck();
+
+    // Key management
+    test_kdf();
+    test_keywrap();
 
     printf("\n=== All Tests Completed ===\n");
 
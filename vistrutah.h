@@ -2,6 +2,7 @@
 #define VISTRUTAH_PORTABLE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -24,11 +25,26 @@
 #            define VISTRUTAH_VAES
 #        endif
 #    endif
+
+// Vistrutah-512 on 256-bit VAES when AVX-512 is not available
+#    if defined(VISTRUTAH_VAES) && defined(__AVX2__) && !defined(VISTRUTAH_AVX512)
+#        define VISTRUTAH_512_VAES256
+#    endif
+
+// The 256-bit VAES batch kernel itself is built whenever VAES and AVX2 are
+// available; with AVX-512 it is an alternative picked by the autotuner
+#    if defined(VISTRUTAH_VAES) && defined(__AVX2__)
+#        define VISTRUTAH_512_VAES_KERNEL
+#    endif
 #elif defined(__aarch64__) || defined(__arm64__) || defined(_M_ARM64)
 #    ifndef VISTRUTAH_ARM
 #        define VISTRUTAH_ARM
 #    endif
 #    include <arm_neon.h>
+#elif defined(__riscv) && defined(__riscv_zvkned)
+#    ifndef VISTRUTAH_RISCV
+#        define VISTRUTAH_RISCV
+#    endif
 #endif
 
 // Core constants
@@ -76,6 +92,49 @@ typedef struct {
 } v512_t;
 #endif
 
+// USDT probes (provider "vistrutah") for bpftrace, perf and SystemTap,
+// compiled in when <sys/sdt.h> is available unless VISTRUTAH_NO_USDT is
+// defined. Until a tracer attaches, a probe is a nop. The probes are
+//   batch_start, batch_end  multi-block, strided, pointer-array, streaming,
+//                           CRC32C, re-encryption, permutation and
+//                           multi-buffer dispatch calls
+//   mode_start, mode_end    CTR, OCB, SIV, hash, XOF, deck, KDF and key wrap
+//                           calls
+//   key_init                creation of a keyed context
+// with arguments: variant (string), length in bytes (the key size for
+// key_init), backend (string, as returned by vistrutah_get_impl_name()).
+#if !defined(VISTRUTAH_NO_USDT) && defined(__has_include)
+#    if __has_include(<sys/sdt.h>)
+#        include <sys/sdt.h>
+#        define VISTRUTAH_USDT
+#    endif
+#endif
+
+#if defined(VISTRUTAH_STATS) || defined(VISTRUTAH_USDT)
+#    define VISTRUTAH_ENTRY_HOOKS
+#endif
+
+// With entry hooks, the backends (which define VISTRUTAH_BACKEND before
+// including this header) compile the block cipher entry points under a
+// _raw name, and vistrutah_stats.c wraps them: all eight for statistics,
+// the multi-block ones for probes. Backends also see the declarations
+// under VISTRUTAH_INTERNAL, which the other library sources define.
+#ifdef VISTRUTAH_BACKEND
+#    define VISTRUTAH_INTERNAL
+#endif
+#if defined(VISTRUTAH_STATS) && defined(VISTRUTAH_BACKEND)
+#    define vistrutah_256_encrypt vistrutah_256_encrypt_raw
+#    define vistrutah_256_decrypt vistrutah_256_decrypt_raw
+#    define vistrutah_512_encrypt vistrutah_512_encrypt_raw
+#    define vistrutah_512_decrypt vistrutah_512_decrypt_raw
+#endif
+#if defined(VISTRUTAH_ENTRY_HOOKS) && defined(VISTRUTAH_BACKEND)
+#    define vistrutah_256_encrypt_blocks vistrutah_256_encrypt_blocks_raw
+#    define vistrutah_256_decrypt_blocks vistrutah_256_decrypt_blocks_raw
+#    define vistrutah_512_encrypt_blocks vistrutah_512_encrypt_blocks_raw
+#    define vistrutah_512_decrypt_blocks vistrutah_512_decrypt_blocks_raw
+#endif
+
 // Function prototypes
 void vistrutah_256_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8_t* key,
                            int key_size, int rounds);
@@ -87,10 +146,630 @@ void vistrutah_512_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const
 void vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key,
                            int key_size, int rounds);
 
+// Multi-block variants: process `blocks` consecutive blocks under one key.
+// Backends with wide AES units (e.g. SVE2-AES) keep several blocks in flight.
+void vistrutah_256_encrypt_blocks(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                                  const uint8_t* key, int key_size, int rounds);
+void vistrutah_256_decrypt_blocks(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                                  const uint8_t* key, int key_size, int rounds);
+
+void vistrutah_512_encrypt_blocks(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                                  const uint8_t* key, int key_size, int rounds);
+void vistrutah_512_decrypt_blocks(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                                  const uint8_t* key, int key_size, int rounds);
+
+// Keyed contexts, and strided variants for records that are not contiguous
+// (struct-of-arrays columns, or fields in a row layout). Record i is read
+// from in + i * in_stride and written to out + i * out_stride. The init
+// functions return -1 for a key size the cipher does not support (16 or 32
+// bytes for Vistrutah-256, 32 or 64 for Vistrutah-512), 0 otherwise.
+typedef struct {
+    uint8_t key[32];
+    int     key_size;
+    int     rounds;
+} vistrutah_256_ctx;
+
+typedef struct {
+    uint8_t key[64];
+    int     key_size;
+    int     rounds;
+} vistrutah_512_ctx;
+
+int vistrutah_256_init(vistrutah_256_ctx* ctx, const uint8_t* key, int key_size, int rounds);
+int vistrutah_512_init(vistrutah_512_ctx* ctx, const uint8_t* key, int key_size, int rounds);
+
+void vistrutah_256_encrypt_strided(const vistrutah_256_ctx* ctx, const uint8_t* in,
+                                   size_t in_stride, uint8_t* out, size_t out_stride, size_t n);
+void vistrutah_256_decrypt_strided(const vistrutah_256_ctx* ctx, const uint8_t* in,
+                                   size_t in_stride, uint8_t* out, size_t out_stride, size_t n);
+void vistrutah_512_encrypt_strided(const vistrutah_512_ctx* ctx, const uint8_t* in,
+                                   size_t in_stride, uint8_t* out, size_t out_stride, size_t n);
+void vistrutah_512_decrypt_strided(const vistrutah_512_ctx* ctx, const uint8_t* in,
+                                   size_t in_stride, uint8_t* out, size_t out_stride, size_t n);
+
+// Pointer-array variants for blocks scattered in memory: entry i is read
+// from in[i] and written to out[i]. If ctxs is not NULL, entry i uses
+// ctxs[i] and ctx is ignored; consecutive entries with the same context
+// share one key schedule. Upcoming entries are prefetched while the
+// current group is processed. The VAES backend also runs entries with
+// different contexts side by side when their round counts match.
+void vistrutah_256_encrypt_ptrs(const vistrutah_256_ctx* ctx, const vistrutah_256_ctx* const* ctxs,
+                                const uint8_t* const* in, uint8_t* const* out, size_t n);
+void vistrutah_256_decrypt_ptrs(const vistrutah_256_ctx* ctx, const vistrutah_256_ctx* const* ctxs,
+                                const uint8_t* const* in, uint8_t* const* out, size_t n);
+void vistrutah_512_encrypt_ptrs(const vistrutah_512_ctx* ctx, const vistrutah_512_ctx* const* ctxs,
+                                const uint8_t* const* in, uint8_t* const* out, size_t n);
+void vistrutah_512_decrypt_ptrs(const vistrutah_512_ctx* ctx, const vistrutah_512_ctx* const* ctxs,
+                                const uint8_t* const* in, uint8_t* const* out, size_t n);
+
+// Multi-buffer job manager (vistrutah_mb.c) for many short messages under
+// Vistrutah-512. Jobs may differ in length, context and direction; blocks of
+// all pending jobs are dispatched together through the pointer-array API so
+// that blocks from different messages share the lanes of the batch kernel.
+// Completed jobs are returned in submission order.
+//
+// Flush policy: pending jobs are dispatched as soon as there are max_jobs of
+// them or they hold max_blocks blocks, so a job waits for at most
+// max_jobs - 1 later submissions; vistrutah_mb_flush() dispatches at once.
+// vistrutah_mb_submit() returns -1 when the manager already holds
+// VISTRUTAH_MB_MAX_JOBS jobs; completed jobs must be collected first.
+#define VISTRUTAH_MB_MAX_JOBS 256
+
+typedef struct {
+    const vistrutah_512_ctx* ctx;
+    int                      decrypt;
+    const uint8_t*           in;
+    uint8_t*                 out;
+    size_t                   blocks;
+    void*                    user_data;
+} vistrutah_mb_job;
+
+typedef struct {
+    vistrutah_mb_job* jobs[VISTRUTAH_MB_MAX_JOBS];
+    size_t            head;      // oldest job not yet returned
+    size_t            completed; // completed jobs from head on
+    size_t            count;     // all jobs held
+    size_t            pending_blocks;
+    size_t            max_jobs;
+    size_t            max_blocks;
+} vistrutah_mb_mgr;
+
+void              vistrutah_mb_init(vistrutah_mb_mgr* mgr, size_t max_jobs, size_t max_blocks);
+int               vistrutah_mb_submit(vistrutah_mb_mgr* mgr, vistrutah_mb_job* job);
+void              vistrutah_mb_flush(vistrutah_mb_mgr* mgr);
+vistrutah_mb_job* vistrutah_mb_get_completed(vistrutah_mb_mgr* mgr);
+
+// Offload engine (vistrutah_offload.c): `workers` crypto threads serve
+// `producers` application threads. Where the platform allows it, worker t
+// is pinned to cpus[t]; with cpus NULL, the workers take the CPUs of the
+// process affinity mask from the highest-numbered one down, away from the
+// low-numbered cores applications tend to start on. Producer p
+// (0 <= p < producers) submits jobs on its own lock-free request ring and
+// polls its own completion ring; each ring must only be used from one
+// thread at a time. Workers batch whatever their rings hold through the
+// multi-buffer job manager. A producer gets its jobs back in submission
+// order. ring_size is rounded up to a power of two;
+// vistrutah_offload_submit() returns -1 when the request ring is full.
+// vistrutah_offload_destroy() lets the workers finish the queued jobs.
+typedef struct vistrutah_offload vistrutah_offload;
+
+vistrutah_offload* vistrutah_offload_create(int workers, int producers, size_t ring_size,
+                                            const int* cpus);
+void               vistrutah_offload_destroy(vistrutah_offload* engine);
+int                vistrutah_offload_submit(vistrutah_offload* engine, int producer,
+                                            vistrutah_mb_job* job);
+vistrutah_mb_job*  vistrutah_offload_poll(vistrutah_offload* engine, int producer);
+
+// Bulk encryption and decryption with non-temporal stores (vistrutah_stream.c).
+// Meant for outputs larger than the last-level cache, where skipping the
+// read-for-ownership of each output line saves memory bandwidth; smaller
+// outputs are faster with the regular calls. Streaming stores are used when
+// out is 64-byte aligned. in and out may be the same buffer.
+void vistrutah_256_encrypt_blocks_stream(const vistrutah_256_ctx* ctx, const uint8_t* in,
+                                         uint8_t* out, size_t blocks);
+void vistrutah_256_decrypt_blocks_stream(const vistrutah_256_ctx* ctx, const uint8_t* in,
+                                         uint8_t* out, size_t blocks);
+void vistrutah_512_encrypt_blocks_stream(const vistrutah_512_ctx* ctx, const uint8_t* in,
+                                         uint8_t* out, size_t blocks);
+void vistrutah_512_decrypt_blocks_stream(const vistrutah_512_ctx* ctx, const uint8_t* in,
+                                         uint8_t* out, size_t blocks);
+
+// Multi-block encryption and decryption with a fused CRC32C (vistrutah_crc.c).
+// crc_in and crc_out, when not NULL, hold running CRC32C values (start from
+// 0) that are updated over the input and the output respectively, so a
+// buffer can be processed in several calls. vistrutah_crc32c() computes the
+// same checksum on its own.
+uint32_t vistrutah_crc32c(uint32_t crc, const uint8_t* data, size_t len);
+
+void vistrutah_256_encrypt_blocks_crc32c(const vistrutah_256_ctx* ctx, const uint8_t* in,
+                                         uint8_t* out, size_t blocks, uint32_t* crc_in,
+                                         uint32_t* crc_out);
+void vistrutah_256_decrypt_blocks_crc32c(const vistrutah_256_ctx* ctx, const uint8_t* in,
+                                         uint8_t* out, size_t blocks, uint32_t* crc_in,
+                                         uint32_t* crc_out);
+void vistrutah_512_encrypt_blocks_crc32c(const vistrutah_512_ctx* ctx, const uint8_t* in,
+                                         uint8_t* out, size_t blocks, uint32_t* crc_in,
+                                         uint32_t* crc_out);
+void vistrutah_512_decrypt_blocks_crc32c(const vistrutah_512_ctx* ctx, const uint8_t* in,
+                                         uint8_t* out, size_t blocks, uint32_t* crc_in,
+                                         uint32_t* crc_out);
+
+// Counter mode over Vistrutah-512 (vistrutah_ctr.c) with random access:
+// vistrutah_ctr_xor() encrypts or decrypts len bytes starting at any byte
+// offset of the stream, computing the counter for that offset directly.
+// vistrutah_ctr_xor_parallel() splits a large range across threads.
+// vistrutah_ctr_init() returns -1 for a bad key size, like
+// vistrutah_512_init().
+#define VISTRUTAH_CTR_NONCE_BYTES 56
+
+typedef struct {
+    vistrutah_512_ctx cipher;
+    uint8_t           nonce[VISTRUTAH_CTR_NONCE_BYTES];
+} vistrutah_ctr_ctx;
+
+int  vistrutah_ctr_init(vistrutah_ctr_ctx* ctx, const uint8_t* key, int key_size, int rounds,
+                        const uint8_t* nonce);
+void vistrutah_ctr_xor(const vistrutah_ctr_ctx* ctx, uint64_t offset, const uint8_t* in,
+                       uint8_t* out, size_t len);
+void vistrutah_ctr_xor_parallel(const vistrutah_ctr_ctx* ctx, uint64_t offset, const uint8_t* in,
+                                uint8_t* out, size_t len, int threads);
+
+// Key rotation (vistrutah_reencrypt.c): data encrypted under one key is
+// re-encrypted under another in a single pass, without writing the
+// plaintext back to the buffer. The VAES backend keeps it in registers;
+// elsewhere a group at a time passes through a stack buffer, which is
+// cleared before returning. vistrutah_512_reencrypt_blocks() re-encrypts
+// raw Vistrutah-512 blocks; vistrutah_ctr_reencrypt() moves a CTR range to
+// a new key and nonce. The parallel variants split the work across threads.
+void vistrutah_512_reencrypt_blocks(const vistrutah_512_ctx* from, const vistrutah_512_ctx* to,
+                                    const uint8_t* in, uint8_t* out, size_t blocks);
+void vistrutah_512_reencrypt_blocks_parallel(const vistrutah_512_ctx* from,
+                                             const vistrutah_512_ctx* to, const uint8_t* in,
+                                             uint8_t* out, size_t blocks, int threads);
+void vistrutah_ctr_reencrypt(const vistrutah_ctr_ctx* from, const vistrutah_ctr_ctx* to,
+                             uint64_t offset, const uint8_t* in, uint8_t* out, size_t len);
+void vistrutah_ctr_reencrypt_parallel(const vistrutah_ctr_ctx* from, const vistrutah_ctr_ctx* to,
+                                      uint64_t offset, const uint8_t* in, uint8_t* out,
+                                      size_t len, int threads);
+
+// OCB-style authenticated encryption over Vistrutah-512 (vistrutah_ocb.c).
+// Offsets live in GF(2^512); the L table is precomputed by vistrutah_ocb_init()
+// and covers messages and associated data of up to 2^VISTRUTAH_OCB_L_COUNT
+// blocks. All three functions return 0 on success and -1 on error (a key
+// size other than 32 or 64 bytes for init); on a tag mismatch, decryption
+// also zeroes the plaintext.
+#define VISTRUTAH_OCB_NONCE_BYTES 32
+#define VISTRUTAH_OCB_TAG_BYTES   32
+#define VISTRUTAH_OCB_L_COUNT     32
+
+typedef struct {
+    uint8_t key[64];
+    int     key_size;
+    int     rounds;
+    uint8_t L_star[64];
+    uint8_t L_dollar[64];
+    uint8_t L[VISTRUTAH_OCB_L_COUNT][64];
+} vistrutah_ocb_ctx;
+
+int  vistrutah_ocb_init(vistrutah_ocb_ctx* ctx, const uint8_t* key, int key_size, int rounds);
+int  vistrutah_ocb_encrypt(const vistrutah_ocb_ctx* ctx, const uint8_t* plaintext,
+                           uint8_t* ciphertext, size_t len, const uint8_t* ad, size_t ad_len,
+                           const uint8_t* nonce, uint8_t* tag);
+int  vistrutah_ocb_decrypt(const vistrutah_ocb_ctx* ctx, const uint8_t* ciphertext,
+                           uint8_t* plaintext, size_t len, const uint8_t* ad, size_t ad_len,
+                           const uint8_t* nonce, const uint8_t* tag);
+
+// Deterministic (SIV-style) authenticated encryption over Vistrutah-512
+// (vistrutah_siv.c). A parallel PMAC-like PRF over the associated data and
+// the message yields a 512-bit synthetic IV, which then drives CTR mode.
+// MAC and encryption subkeys are derived from the key by vistrutah_siv_init().
+// Functions returning int return 0 on success and -1 on error (a key size
+// other than 32 or 64 bytes for init); on an SIV mismatch, decryption also
+// zeroes the plaintext.
+//
+// For inputs that do not fit in cache, the two passes can be streamed:
+// vistrutah_siv_mac_*() over the plaintext produces the SIV, and
+// vistrutah_siv_ctr_*() then encrypts (or decrypts) the data in chunks.
+#define VISTRUTAH_SIV_BYTES   64
+#define VISTRUTAH_SIV_L_COUNT 32
+#define VISTRUTAH_SIV_BATCH   8
+
+typedef struct {
+    uint8_t mac_key[64];
+    uint8_t enc_key[64];
+    int     key_size;
+    int     rounds;
+    uint8_t L_star[64];
+    uint8_t L_dollar[64];
+    uint8_t L[VISTRUTAH_SIV_L_COUNT][64];
+} vistrutah_siv_ctx;
+
+typedef struct {
+    const vistrutah_siv_ctx* ctx;
+    uint8_t                  ad_hash[64];
+    uint8_t                  offset[64];
+    uint8_t                  sum[64];
+    uint8_t                  buf[VISTRUTAH_SIV_BATCH * 64];
+    size_t                   buf_len;
+    uint64_t                 blocks;
+} vistrutah_siv_mac_state;
+
+typedef struct {
+    const vistrutah_siv_ctx* ctx;
+    uint8_t                  iv[64];
+    uint64_t                 counter;
+    uint8_t                  keystream[VISTRUTAH_SIV_BATCH * 64];
+    size_t                   keystream_pos;
+    size_t                   keystream_len;
+} vistrutah_siv_ctr_state;
+
+int  vistrutah_siv_init(vistrutah_siv_ctx* ctx, const uint8_t* key, int key_size, int rounds);
+int  vistrutah_siv_encrypt(const vistrutah_siv_ctx* ctx, const uint8_t* plaintext,
+                           uint8_t* ciphertext, size_t len, const uint8_t* ad, size_t ad_len,
+                           uint8_t* siv);
+int  vistrutah_siv_decrypt(const vistrutah_siv_ctx* ctx, const uint8_t* ciphertext,
+                           uint8_t* plaintext, size_t len, const uint8_t* ad, size_t ad_len,
+                           const uint8_t* siv);
+
+void vistrutah_siv_mac_init(vistrutah_siv_mac_state* st, const vistrutah_siv_ctx* ctx,
+                            const uint8_t* ad, size_t ad_len);
+void vistrutah_siv_mac_update(vistrutah_siv_mac_state* st, const uint8_t* data, size_t len);
+int  vistrutah_siv_mac_final(vistrutah_siv_mac_state* st, uint8_t* siv);
+int  vistrutah_siv_mac_verify(vistrutah_siv_mac_state* st, const uint8_t* siv);
+void vistrutah_siv_ctr_init(vistrutah_siv_ctr_state* st, const vistrutah_siv_ctx* ctx,
+                            const uint8_t* siv);
+void vistrutah_siv_ctr_update(vistrutah_siv_ctr_state* st, const uint8_t* in, uint8_t* out,
+                              size_t len);
+
+// Hashing with Vistrutah-512 (vistrutah_hash.c). vistrutah_512_compress() is
+// a 1024-to-512-bit compression function built from three fixed-key
+// Vistrutah-512 instances in MMO (E_K(x) ^ x) form, so that many compressions
+// share a key and run through the multi-block kernel. Messages are split
+// into VISTRUTAH_HASH_CHUNK_BYTES chunks, hashed independently and combined
+// in a binary tree; all interfaces below produce the same digest.
+//
+// vistrutah_hash_parallel() spreads the chunks across threads and returns -1
+// if it cannot allocate memory or start a thread. vistrutah_hash_many()
+// hashes several independent messages at once, which pays off for short ones.
+#define VISTRUTAH_HASH_BYTES       64
+#define VISTRUTAH_HASH_CHUNK_BYTES 1024
+#define VISTRUTAH_HASH_MAX_DEPTH   54
+
+typedef struct {
+    uint8_t  cv_stack[VISTRUTAH_HASH_MAX_DEPTH][64];
+    size_t   stack_len;
+    uint8_t  chunk_cv[64];
+    uint64_t chunk_counter;
+    size_t   chunk_len;
+    uint8_t  buf[64];
+    size_t   buf_len;
+} vistrutah_hash_state;
+
+void vistrutah_512_compress(uint8_t* out, const uint8_t* cv, const uint8_t* block);
+
+void vistrutah_hash(const uint8_t* in, size_t len, uint8_t* out);
+void vistrutah_hash_init(vistrutah_hash_state* st);
+void vistrutah_hash_update(vistrutah_hash_state* st, const uint8_t* in, size_t len);
+void vistrutah_hash_final(vistrutah_hash_state* st, uint8_t* out);
+int  vistrutah_hash_parallel(const uint8_t* in, size_t len, uint8_t* out, int threads);
+void vistrutah_hash_many(const uint8_t* const* in, const size_t* lens, size_t count,
+                         uint8_t* out);
+
+// Keyless 512-bit permutation (vistrutah_permutation.c): Vistrutah-512 under
+// a fixed public key, with its round keys precomputed at compile time.
+#define VISTRUTAH_PERMUTATION_KEY    (ROUND_CONSTANTS + 16 * 36)
+#define VISTRUTAH_PERMUTATION_ROUNDS VISTRUTAH_512_ROUNDS_LONG_512KEY
+
+void vistrutah_512_permute(uint8_t* state);
+
+// Sponge XOF over vistrutah_512_permute() (vistrutah_xof.c). The rate is in
+// bytes, between 1 and 63; the remaining bytes are the capacity, so the
+// default rate leaves a 256-bit capacity. Absorbing is only allowed before
+// the first squeeze. vistrutah_xof_init() and vistrutah_xof() return -1 on
+// an invalid rate.
+#define VISTRUTAH_XOF_DEFAULT_RATE 32
+
+typedef struct {
+    uint8_t state[64];
+    size_t  rate;
+    size_t  pos;
+    bool    squeezing;
+} vistrutah_xof_state;
+
+int  vistrutah_xof_init(vistrutah_xof_state* st, size_t rate);
+void vistrutah_xof_absorb(vistrutah_xof_state* st, const uint8_t* in, size_t len);
+void vistrutah_xof_squeeze(vistrutah_xof_state* st, uint8_t* out, size_t len);
+int  vistrutah_xof(const uint8_t* in, size_t len, uint8_t* out, size_t out_len, size_t rate);
+
+// Farfalle-style deck function (vistrutah_deck.c): a keyed PRF that takes a
+// sequence of strings and produces output of any length. Input blocks under
+// a rolling mask are compressed independently, and output blocks are
+// expanded independently, so both phases go through the multi-block kernel.
+// Keys are 1 to 63 bytes; vistrutah_deck_init() returns -1 otherwise.
+// vistrutah_deck_squeeze() returns bytes [offset, offset + len) of the output
+// for all strings absorbed so far, and does not change the context.
+typedef struct {
+    uint8_t  key_mask[64];
+    uint8_t  mask[64];
+    uint8_t  acc[64];
+} vistrutah_deck_ctx;
+
+int  vistrutah_deck_init(vistrutah_deck_ctx* ctx, const uint8_t* key, size_t key_len);
+void vistrutah_deck_absorb(vistrutah_deck_ctx* ctx, const uint8_t* in, size_t len);
+void vistrutah_deck_squeeze(const vistrutah_deck_ctx* ctx, uint64_t offset, uint8_t* out,
+                            size_t len);
+
+// Key derivation (vistrutah_kdf.c): Vistrutah-512 used as a PRF under a
+// master key. The context fixes the master key and a label of up to
+// VISTRUTAH_KDF_MAX_LABEL bytes; each 64-bit counter then yields one derived
+// key of 32 or 64 bytes from a single block encryption. Keys are written
+// back to back, key_bytes apart. vistrutah_kdf_init() returns -1 for a bad
+// key size or label, the derive functions for a bad key_bytes.
+#define VISTRUTAH_KDF_MAX_LABEL 54
+
+typedef struct {
+    uint8_t key[64];
+    int     key_size;
+    int     rounds;
+    uint8_t block[64];
+} vistrutah_kdf_ctx;
+
+int vistrutah_kdf_init(vistrutah_kdf_ctx* ctx, const uint8_t* master_key, int key_size,
+                       int rounds, const uint8_t* label, size_t label_len);
+int vistrutah_kdf_derive(const vistrutah_kdf_ctx* ctx, const uint64_t* counters, size_t n,
+                         uint8_t* out, size_t key_bytes);
+int vistrutah_kdf_derive_parallel(const vistrutah_kdf_ctx* ctx, const uint64_t* counters,
+                                  size_t n, uint8_t* out, size_t key_bytes, int threads);
+
+// Key wrapping (vistrutah_keywrap.c): each 256-bit key and a 256-bit
+// integrity header form one Vistrutah-512 block, so wrapping or unwrapping
+// a key costs one block call. Keys are VISTRUTAH_KEYWRAP_KEY_BYTES apart,
+// wrapped keys VISTRUTAH_KEYWRAP_WRAPPED_BYTES apart. vistrutah_keywrap_unwrap()
+// checks every header in constant time, zeroes the keys that fail, and
+// returns -1 if any did; valid, if not NULL, receives 1 or 0 per key.
+// vistrutah_keywrap_init() returns -1 for a KEK that is not 32 or 64 bytes.
+#define VISTRUTAH_KEYWRAP_KEY_BYTES     32
+#define VISTRUTAH_KEYWRAP_WRAPPED_BYTES 64
+
+typedef struct {
+    uint8_t kek[64];
+    int     key_size;
+    int     rounds;
+} vistrutah_keywrap_ctx;
+
+int  vistrutah_keywrap_init(vistrutah_keywrap_ctx* ctx, const uint8_t* kek, int key_size,
+                            int rounds);
+void vistrutah_keywrap_wrap(const vistrutah_keywrap_ctx* ctx, const uint8_t* keys,
+                            uint8_t* wrapped, size_t n);
+int  vistrutah_keywrap_unwrap(const vistrutah_keywrap_ctx* ctx, const uint8_t* wrapped,
+                              uint8_t* keys, size_t n, uint8_t* valid);
+
 // CPU capability detection
 bool        vistrutah_has_aes_accel(void);
 const char* vistrutah_get_impl_name(void);
 
+// Startup autotuning (vistrutah_tune.c). For each variant, the backend may
+// offer several batch kernels: different numbers of blocks in flight and,
+// for Vistrutah-512 on CPUs with AVX-512 and VAES, AES-NI or VAES. The
+// autotuner times each candidate for a few milliseconds and keeps the
+// fastest. With a cache_path, the decision is stored in that file keyed by
+// CPU model and implementation, and later runs reuse it without timing
+// anything. The model is the brand string on x86 and, on Linux, MIDR_EL1
+// on AArch64 and mvendorid/marchid/mimpid on RISC-V; where it cannot be
+// read, the cache is not used and every call times the candidates again.
+// Without a call, the built-in defaults are used. Call it before other
+// threads use the library. Returns -1 if the cache could not be written;
+// the tuned configuration is applied either way.
+typedef enum {
+    VISTRUTAH_256_ENCRYPT,
+    VISTRUTAH_256_DECRYPT,
+    VISTRUTAH_512_ENCRYPT,
+    VISTRUTAH_512_DECRYPT,
+    VISTRUTAH_VARIANTS
+} vistrutah_variant;
+
+typedef struct {
+    const char* kernel;
+    int         blocks_in_flight;
+} vistrutah_kernel_config;
+
+int                     vistrutah_autotune(const char* cache_path);
+vistrutah_kernel_config vistrutah_get_kernel_config(vistrutah_variant variant);
+
+// Per-entry-point statistics (vistrutah_stats.c), compiled in with
+// -DVISTRUTAH_STATS and absent otherwise. Each thread counts calls, bytes
+// and cycles into its own block, with the timed calls split by message
+// size class and a log2 histogram of cycles per call. Calls of at least
+// VISTRUTAH_STATS_TIME_BYTES are always timed; smaller ones are timed one
+// in VISTRUTAH_STATS_SAMPLE, and "timed" says how many were. Calls and
+// bytes are always exact; an untimed call updates only those two, which
+// costs about 1 ns, or 3-4% of a single Vistrutah-256 block.
+// Only the outermost instrumented call is recorded, so e.g. the blocks that
+// OCB encrypts are not counted again under 512_encrypt_blocks. The threads
+// started by the _parallel functions each record their share as one call
+// of the same entry. Multi-buffer and offload work is recorded as
+// mb_dispatch, by the thread that runs the dispatch. Cycles are TSC ticks
+// on x86, generic timer ticks (cntvct_el0) on AArch64, and nanoseconds
+// elsewhere.
+//
+// A snapshot sums every thread, including exited ones, and is approximate
+// while other threads are inside the library. A reset takes effect in each
+// thread at its next recorded call; a call in progress during the reset
+// may be dropped, but is never half counted.
+#ifdef VISTRUTAH_STATS
+#    include <stdio.h>
+
+#    define VISTRUTAH_STATS_BUCKETS    40
+#    define VISTRUTAH_STATS_SIZES      8
+#    define VISTRUTAH_STATS_SAMPLE     64
+#    define VISTRUTAH_STATS_TIME_BYTES 4096
+
+typedef enum {
+    VISTRUTAH_STAT_256_ENCRYPT,
+    VISTRUTAH_STAT_256_DECRYPT,
+    VISTRUTAH_STAT_512_ENCRYPT,
+    VISTRUTAH_STAT_512_DECRYPT,
+    VISTRUTAH_STAT_256_ENCRYPT_BLOCKS,
+    VISTRUTAH_STAT_256_DECRYPT_BLOCKS,
+    VISTRUTAH_STAT_512_ENCRYPT_BLOCKS,
+    VISTRUTAH_STAT_512_DECRYPT_BLOCKS,
+    VISTRUTAH_STAT_256_ENCRYPT_STRIDED,
+    VISTRUTAH_STAT_256_DECRYPT_STRIDED,
+    VISTRUTAH_STAT_512_ENCRYPT_STRIDED,
+    VISTRUTAH_STAT_512_DECRYPT_STRIDED,
+    VISTRUTAH_STAT_256_ENCRYPT_PTRS,
+    VISTRUTAH_STAT_256_DECRYPT_PTRS,
+    VISTRUTAH_STAT_512_ENCRYPT_PTRS,
+    VISTRUTAH_STAT_512_DECRYPT_PTRS,
+    VISTRUTAH_STAT_256_ENCRYPT_STREAM,
+    VISTRUTAH_STAT_256_DECRYPT_STREAM,
+    VISTRUTAH_STAT_512_ENCRYPT_STREAM,
+    VISTRUTAH_STAT_512_DECRYPT_STREAM,
+    VISTRUTAH_STAT_256_ENCRYPT_CRC32C,
+    VISTRUTAH_STAT_256_DECRYPT_CRC32C,
+    VISTRUTAH_STAT_512_ENCRYPT_CRC32C,
+    VISTRUTAH_STAT_512_DECRYPT_CRC32C,
+    VISTRUTAH_STAT_512_REENCRYPT,
+    VISTRUTAH_STAT_CTR_XOR,
+    VISTRUTAH_STAT_CTR_REENCRYPT,
+    VISTRUTAH_STAT_OCB_ENCRYPT,
+    VISTRUTAH_STAT_OCB_DECRYPT,
+    VISTRUTAH_STAT_SIV_ENCRYPT,
+    VISTRUTAH_STAT_SIV_DECRYPT,
+    VISTRUTAH_STAT_HASH,
+    VISTRUTAH_STAT_HASH_UPDATE,
+    VISTRUTAH_STAT_HASH_FINAL,
+    VISTRUTAH_STAT_HASH_MANY,
+    VISTRUTAH_STAT_XOF,
+    VISTRUTAH_STAT_XOF_ABSORB,
+    VISTRUTAH_STAT_XOF_SQUEEZE,
+    VISTRUTAH_STAT_512_PERMUTE,
+    VISTRUTAH_STAT_DECK_ABSORB,
+    VISTRUTAH_STAT_DECK_SQUEEZE,
+    VISTRUTAH_STAT_KDF_DERIVE,
+    VISTRUTAH_STAT_KEYWRAP_WRAP,
+    VISTRUTAH_STAT_KEYWRAP_UNWRAP,
+    VISTRUTAH_STAT_MB_DISPATCH,
+    VISTRUTAH_STAT_ENTRIES
+} vistrutah_stat_entry;
+
+// Size class i holds messages of up to 64 << 2i bytes; the last one is
+// unbounded. Size classes and histogram bucket i, which counts calls of
+// [2^i, 2^(i+1)) cycles, cover timed calls only.
+typedef struct {
+    uint64_t calls;
+    uint64_t bytes;
+    uint64_t timed;
+    uint64_t cycles;
+    uint64_t size_timed[VISTRUTAH_STATS_SIZES];
+    uint64_t size_cycles[VISTRUTAH_STATS_SIZES];
+    uint64_t histogram[VISTRUTAH_STATS_BUCKETS];
+} vistrutah_stat;
+
+typedef struct {
+    vistrutah_stat entries[VISTRUTAH_STAT_ENTRIES];
+} vistrutah_stats;
+
+void        vistrutah_stats_snapshot(vistrutah_stats* stats);
+void        vistrutah_stats_merge(vistrutah_stats* into, const vistrutah_stats* from);
+void        vistrutah_stats_reset(void);
+int         vistrutah_stats_write_json(const vistrutah_stats* stats, FILE* out);
+const char* vistrutah_stats_entry_name(vistrutah_stat_entry entry);
+
+// Recording hooks used by the instrumented entry points
+uint64_t vistrutah_stats_begin(size_t bytes);
+void     vistrutah_stats_end(uint64_t start, vistrutah_stat_entry entry);
+
+void vistrutah_256_encrypt_raw(const uint8_t* plaintext, uint8_t* ciphertext, const uint8_t* key,
+                               int key_size, int rounds);
+void vistrutah_256_decrypt_raw(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key,
+                               int key_size, int rounds);
+void vistrutah_512_encrypt_raw(const uint8_t* plaintext, uint8_t* ciphertext, const uint8_t* key,
+                               int key_size, int rounds);
+void vistrutah_512_decrypt_raw(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key,
+                               int key_size, int rounds);
+
+#    define VISTRUTAH_STATS_BEGIN(t, bytes) uint64_t t = vistrutah_stats_begin(bytes)
+#    define VISTRUTAH_STATS_END(t, id)      vistrutah_stats_end(t, VISTRUTAH_STAT_##id)
+#else
+#    define VISTRUTAH_STATS_BEGIN(t, bytes)
+#    define VISTRUTAH_STATS_END(t, id)
+#endif
+
+// Backend name passed to the probes, the same as vistrutah_get_impl_name()
+extern const char* const vistrutah_impl_name;
+
+#ifdef VISTRUTAH_USDT
+#    define VISTRUTAH_PROBE(name, id, n) DTRACE_PROBE3(vistrutah, name, #id, n, vistrutah_impl_name)
+#else
+#    define VISTRUTAH_PROBE(name, id, n)
+#endif
+
+// Hooks around a public entry point: statistics under VISTRUTAH_STAT_<id>
+// and the <kind>_start/<kind>_end probes. `n` is evaluated once, on entry.
+#ifdef VISTRUTAH_ENTRY_HOOKS
+#    define VISTRUTAH_ENTER(t, kind, id, n)      \
+        const size_t t = (n);                    \
+        VISTRUTAH_PROBE(kind##_start, id, t);    \
+        VISTRUTAH_STATS_BEGIN(t##_start, t)
+#    define VISTRUTAH_LEAVE(t, kind, id)         \
+        VISTRUTAH_STATS_END(t##_start, id);      \
+        VISTRUTAH_PROBE(kind##_end, id, t)
+
+void vistrutah_256_encrypt_blocks_raw(const uint8_t* plaintext, uint8_t* ciphertext,
+                                      size_t blocks, const uint8_t* key, int key_size, int rounds);
+void vistrutah_256_decrypt_blocks_raw(const uint8_t* ciphertext, uint8_t* plaintext,
+                                      size_t blocks, const uint8_t* key, int key_size, int rounds);
+void vistrutah_512_encrypt_blocks_raw(const uint8_t* plaintext, uint8_t* ciphertext,
+                                      size_t blocks, const uint8_t* key, int key_size, int rounds);
+void vistrutah_512_decrypt_blocks_raw(const uint8_t* ciphertext, uint8_t* plaintext,
+                                      size_t blocks, const uint8_t* key, int key_size, int rounds);
+#else
+#    define VISTRUTAH_ENTER(t, kind, id, n)
+#    define VISTRUTAH_LEAVE(t, kind, id)
+#endif
+
+// Library internals, not part of the API; see VISTRUTAH_INTERNAL above
+#ifdef VISTRUTAH_INTERNAL
+
+// Selected configuration per variant, read by the backends
+extern vistrutah_kernel_config vistrutah_kernel_configs[VISTRUTAH_VARIANTS];
+
+#    if defined(VISTRUTAH_512_VAES_KERNEL) && !defined(VISTRUTAH_512_VAES256)
+void vistrutah_512_vaes_blocks(const uint8_t* in, uint8_t* out, size_t blocks, const uint8_t* key,
+                               int key_size, int rounds, int decrypt);
+#    endif
+
+// Prefetches entries [first, first + count) of a pointer-array batch of n
+// (vistrutah_strided.c); the VAES backend looks VISTRUTAH_PREFETCH_AHEAD
+// entries ahead
+#    define VISTRUTAH_PREFETCH_AHEAD 8
+
+void vistrutah_prefetch_ptrs(const uint8_t* const* in, uint8_t* const* out, size_t first,
+                             size_t count, size_t n);
+
+// Helpers defined in vistrutah_common.c
+
+// Clears secrets from buffers that are about to go out of scope, where a
+// plain memset would be removed as a dead store
+void vistrutah_secure_zero(void* p, size_t len);
+
+// 64-byte block operations shared by OCB, SIV and the deck function: XOR,
+// and multiplication by x in GF(2^512) modulo x^512 + x^8 + x^5 + x^2 + 1
+void vistrutah_xor_block(uint8_t* out, const uint8_t* a, const uint8_t* b);
+void vistrutah_gf512_double(uint8_t* out, const uint8_t* in);
+
+// Runs fn(arg, first, count) over [0, len) split across up to `threads`
+// threads (at most 64), including the calling thread. Shares are whole
+// numbers of `unit` and at least min_units units long; the first share
+// also takes what does not divide evenly.
+typedef void (*vistrutah_range_fn)(void* arg, size_t first, size_t count);
+
+void vistrutah_parallel_for(size_t len, size_t unit, size_t min_units, int threads,
+                            vistrutah_range_fn fn, void* arg);
+
+#endif // VISTRUTAH_INTERNAL
+
 // External constants (defined in vistrutah_common.c)
 extern const uint8_t ROUND_CONSTANTS[16 * 48];
 extern const uint8_t VISTRUTAH_P4[16];
@@ -1,3 +1,5 @@
+#define VISTRUTAH_BACKEND
+
 #include "vistrutah.h"
 
 #ifdef VISTRUTAH_ARM
@@ -9,70 +11,51 @@ extern const uint8_t ROUND_CONSTANTS[16 * 48];
 extern const uint8_t VISTRUTAH_KEXP_SHUFFLE[32];
 extern const uint8_t VISTRUTAH_ZERO[16];
 
-#    define AES_ENC(A, B)      veorq_u8(vaesmcq_u8(vaeseq_u8(vmovq_n_u8(0), (A))), (B))
-#    define AES_ENC_LAST(A, B) veorq_u8(vaeseq_u8(vmovq_n_u8(0), (A)), (B))
-#    define AES_DEC(A, B)      veorq_u8(vaesimcq_u8(vaesdq_u8(vmovq_n_u8(0), (A))), (B))
-#    define AES_DEC_LAST(A, B) veorq_u8(vaesdq_u8(vmovq_n_u8(0), (A)), (B))
+// vaeseq_u8()/vaesdq_u8() XOR their key operand into the state before
+// SubBytes; the pending key of each round is fed into the next AESE/AESD.
+#    define AES_ENC(A, K)      vaesmcq_u8(vaeseq_u8((A), (K)))
+#    define AES_ENC_LAST(A, K) vaeseq_u8((A), (K))
+#    define AES_DEC(A, K)      vaesimcq_u8(vaesdq_u8((A), (K)))
+#    define AES_DEC_LAST(A, K) vaesdq_u8((A), (K))
 #    define INV_MIX_COLUMNS(A) vaesimcq_u8(A)
 
-static void
-rotate_bytes(uint8_t* data, int shift, int len __attribute__((unused)))
+static inline uint8x16_t
+rotate_bytes(uint8x16_t v, int shift)
 {
-    uint8x16_t v = vld1q_u8(data);
-
     switch (shift) {
-    case 0:
-        return;
     case 1:
-        v = vextq_u8(v, v, 1);
-        break;
+        return vextq_u8(v, v, 1);
     case 2:
-        v = vextq_u8(v, v, 2);
-        break;
+        return vextq_u8(v, v, 2);
     case 3:
-        v = vextq_u8(v, v, 3);
-        break;
+        return vextq_u8(v, v, 3);
     case 4:
-        v = vextq_u8(v, v, 4);
-        break;
+        return vextq_u8(v, v, 4);
     case 5:
-        v = vextq_u8(v, v, 5);
-        break;
+        return vextq_u8(v, v, 5);
     case 6:
-        v = vextq_u8(v, v, 6);
-        break;
+        return vextq_u8(v, v, 6);
     case 7:
-        v = vextq_u8(v, v, 7);
-        break;
+        return vextq_u8(v, v, 7);
     case 8:
-        v = vextq_u8(v, v, 8);
-        break;
+        return vextq_u8(v, v, 8);
     case 9:
-        v = vextq_u8(v, v, 9);
-        break;
+        return vextq_u8(v, v, 9);
     case 10:
-        v = vextq_u8(v, v, 10);
-        break;
+        return vextq_u8(v, v, 10);
     case 11:
-        v = vextq_u8(v, v, 11);
-        break;
+        return vextq_u8(v, v, 11);
     case 12:
-        v = vextq_u8(v, v, 12);
-        break;
+        return vextq_u8(v, v, 12);
     case 13:
-        v = vextq_u8(v, v, 13);
-        break;
+        return vextq_u8(v, v, 13);
     case 14:
-        v = vextq_u8(v, v, 14);
-        break;
+        return vextq_u8(v, v, 14);
     case 15:
-        v = vextq_u8(v, v, 15);
-        break;
+        return vextq_u8(v, v, 15);
     default:
-        return; // Invalid shift value
+        return v;
     }
-
-    vst1q_u8(data, v);
 }
 
 static void
@@ -124,7 +107,6 @@ vistrutah_512_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8
                       int key_size, int rounds)
 {
     uint8_t fixed_key[64];
-    uint8_t round_key[64];
     int     steps = rounds / ROUNDS_PER_STEP;
 
     uint8x16_t s0 = vld1q_u8(plaintext);
@@ -145,78 +127,51 @@ vistrutah_512_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8
         fixed_key[32 + i] = temp[VISTRUTAH_KEXP_SHUFFLE[i]];
     }
 
-    memcpy(round_key, fixed_key + 16, 16);
-    memcpy(round_key + 16, fixed_key, 16);
-    memcpy(round_key + 32, fixed_key + 48, 16);
-    memcpy(round_key + 48, fixed_key + 32, 16);
-
-    uint8x16_t fk0  = vld1q_u8(fixed_key);
-    uint8x16_t fk1  = vld1q_u8(fixed_key + 16);
-    uint8x16_t fk2  = vld1q_u8(fixed_key + 32);
-    uint8x16_t fk3  = vld1q_u8(fixed_key + 48);
-    uint8x16_t zero = vmovq_n_u8(0);
-
-    uint8x16_t rk0 = vld1q_u8(round_key);
-    uint8x16_t rk1 = vld1q_u8(round_key + 16);
-    uint8x16_t rk2 = vld1q_u8(round_key + 32);
-    uint8x16_t rk3 = vld1q_u8(round_key + 48);
+    uint8x16_t fk0 = vld1q_u8(fixed_key);
+    uint8x16_t fk1 = vld1q_u8(fixed_key + 16);
+    uint8x16_t fk2 = vld1q_u8(fixed_key + 32);
+    uint8x16_t fk3 = vld1q_u8(fixed_key + 48);
 
-    s0 = veorq_u8(s0, rk0);
-    s1 = veorq_u8(s1, rk1);
-    s2 = veorq_u8(s2, rk2);
-    s3 = veorq_u8(s3, rk3);
+    uint8x16_t rk0 = fk1;
+    uint8x16_t rk1 = fk0;
+    uint8x16_t rk2 = fk3;
+    uint8x16_t rk3 = fk2;
 
-    s0 = AES_ENC(s0, fk0);
-    s1 = AES_ENC(s1, fk1);
-    s2 = AES_ENC(s2, fk2);
-    s3 = AES_ENC(s3, fk3);
+    s0 = AES_ENC(s0, rk0);
+    s1 = AES_ENC(s1, rk1);
+    s2 = AES_ENC(s2, rk2);
+    s3 = AES_ENC(s3, rk3);
 
     for (int i = 1; i < steps; i++) {
-        s0 = AES_ENC(s0, zero);
-        s1 = AES_ENC(s1, zero);
-        s2 = AES_ENC(s2, zero);
-        s3 = AES_ENC(s3, zero);
+        s0 = AES_ENC(s0, fk0);
+        s1 = AES_ENC(s1, fk1);
+        s2 = AES_ENC(s2, fk2);
+        s3 = AES_ENC(s3, fk3);
 
         mixing_layer_512(&s0, &s1, &s2, &s3);
 
-        rotate_bytes(round_key, 5, 16);
-        rotate_bytes(round_key + 16, 10, 16);
-        rotate_bytes(round_key + 32, 5, 16);
-        rotate_bytes(round_key + 48, 10, 16);
-
-        rk0 = vld1q_u8(round_key);
-        rk1 = vld1q_u8(round_key + 16);
-        rk2 = vld1q_u8(round_key + 32);
-        rk3 = vld1q_u8(round_key + 48);
-
-        s0 = veorq_u8(s0, rk0);
-        s1 = veorq_u8(s1, rk1);
-        s2 = veorq_u8(s2, rk2);
-        s3 = veorq_u8(s3, rk3);
+        rk0 = rotate_bytes(rk0, 5);
+        rk1 = rotate_bytes(rk1, 10);
+        rk2 = rotate_bytes(rk2, 5);
+        rk3 = rotate_bytes(rk3, 10);
 
         uint8x16_t rc = vld1q_u8(&ROUND_CONSTANTS[16 * (i - 1)]);
-        s0            = veorq_u8(s0, rc);
 
-        s0 = AES_ENC(s0, fk0);
-        s1 = AES_ENC(s1, fk1);
-        s2 = AES_ENC(s2, fk2);
-        s3 = AES_ENC(s3, fk3);
+        s0 = AES_ENC(s0, veorq_u8(rk0, rc));
+        s1 = AES_ENC(s1, rk1);
+        s2 = AES_ENC(s2, rk2);
+        s3 = AES_ENC(s3, rk3);
     }
 
-    rotate_bytes(round_key, 5, 16);
-    rotate_bytes(round_key + 16, 10, 16);
-    rotate_bytes(round_key + 32, 5, 16);
-    rotate_bytes(round_key + 48, 10, 16);
+    rk0 = rotate_bytes(rk0, 5);
+    rk1 = rotate_bytes(rk1, 10);
+    rk2 = rotate_bytes(rk2, 5);
+    rk3 = rotate_bytes(rk3, 10);
 
-    rk0 = vld1q_u8(round_key);
-    rk1 = vld1q_u8(round_key + 16);
-    rk2 = vld1q_u8(round_key + 32);
-    rk3 = vld1q_u8(round_key + 48);
-
-    s0 = AES_ENC_LAST(s0, rk0);
-    s1 = AES_ENC_LAST(s1, rk1);
-    s2 = AES_ENC_LAST(s2, rk2);
-    s3 = AES_ENC_LAST(s3, rk3);
+    s0 = veorq_u8(AES_ENC_LAST(s0, fk0), rk0);
+    s1 = veorq_u8(AES_ENC_LAST(s1, fk1), rk1);
+    s2 = veorq_u8(AES_ENC_LAST(s2, fk2), rk2);
+    s3 = veorq_u8(AES_ENC_LAST(s3, fk3), rk3);
 
     vst1q_u8(ciphertext, s0);
     vst1q_u8(ciphertext + 16, s1);
@@ -229,7 +184,6 @@ vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8
                       int key_size, int rounds)
 {
     uint8_t fixed_key[64];
-    uint8_t round_key[64];
     int     steps = rounds / ROUNDS_PER_STEP;
 
     uint8x16_t s0 = vld1q_u8(ciphertext);
@@ -250,59 +204,40 @@ vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8
         fixed_key[32 + i] = temp[VISTRUTAH_KEXP_SHUFFLE[i]];
     }
 
-    memcpy(round_key, fixed_key + 16, 16);
-    memcpy(round_key + 16, fixed_key, 16);
-    memcpy(round_key + 32, fixed_key + 48, 16);
-    memcpy(round_key + 48, fixed_key + 32, 16);
-
-    rotate_bytes(round_key, (5 * steps) % 16, 16);
-    rotate_bytes(round_key + 16, (10 * steps) % 16, 16);
-    rotate_bytes(round_key + 32, (5 * steps) % 16, 16);
-    rotate_bytes(round_key + 48, (10 * steps) % 16, 16);
-
     uint8x16_t fk0 = vld1q_u8(fixed_key);
     uint8x16_t fk1 = vld1q_u8(fixed_key + 16);
     uint8x16_t fk2 = vld1q_u8(fixed_key + 32);
     uint8x16_t fk3 = vld1q_u8(fixed_key + 48);
 
+    uint8x16_t rk0 = rotate_bytes(fk1, (5 * steps) % 16);
+    uint8x16_t rk1 = rotate_bytes(fk0, (10 * steps) % 16);
+    uint8x16_t rk2 = rotate_bytes(fk3, (5 * steps) % 16);
+    uint8x16_t rk3 = rotate_bytes(fk2, (10 * steps) % 16);
+
+    uint8x16_t zero = vmovq_n_u8(0);
+
     fk0 = INV_MIX_COLUMNS(fk0);
     fk1 = INV_MIX_COLUMNS(fk1);
     fk2 = INV_MIX_COLUMNS(fk2);
     fk3 = INV_MIX_COLUMNS(fk3);
 
-    uint8x16_t rk0 = vld1q_u8(round_key);
-    uint8x16_t rk1 = vld1q_u8(round_key + 16);
-    uint8x16_t rk2 = vld1q_u8(round_key + 32);
-    uint8x16_t rk3 = vld1q_u8(round_key + 48);
-
-    s0 = veorq_u8(s0, rk0);
-    s1 = veorq_u8(s1, rk1);
-    s2 = veorq_u8(s2, rk2);
-    s3 = veorq_u8(s3, rk3);
-
-    s0 = AES_DEC(s0, fk0);
-    s1 = AES_DEC(s1, fk1);
-    s2 = AES_DEC(s2, fk2);
-    s3 = AES_DEC(s3, fk3);
+    s0 = AES_DEC(s0, rk0);
+    s1 = AES_DEC(s1, rk1);
+    s2 = AES_DEC(s2, rk2);
+    s3 = AES_DEC(s3, rk3);
 
     for (int i = 1; i < steps; i++) {
-        rotate_bytes(round_key, 11, 16);
-        rotate_bytes(round_key + 16, 6, 16);
-        rotate_bytes(round_key + 32, 11, 16);
-        rotate_bytes(round_key + 48, 6, 16);
-
-        rk0 = vld1q_u8(round_key);
-        rk1 = vld1q_u8(round_key + 16);
-        rk2 = vld1q_u8(round_key + 32);
-        rk3 = vld1q_u8(round_key + 48);
-
-        s0 = AES_DEC_LAST(s0, rk0);
-        s1 = AES_DEC_LAST(s1, rk1);
-        s2 = AES_DEC_LAST(s2, rk2);
-        s3 = AES_DEC_LAST(s3, rk3);
+        rk0 = rotate_bytes(rk0, 11);
+        rk1 = rotate_bytes(rk1, 6);
+        rk2 = rotate_bytes(rk2, 11);
+        rk3 = rotate_bytes(rk3, 6);
 
         uint8x16_t rc = vld1q_u8(&ROUND_CONSTANTS[16 * (steps - i - 1)]);
-        s0            = veorq_u8(s0, rc);
+
+        s0 = veorq_u8(AES_DEC_LAST(s0, fk0), veorq_u8(rk0, rc));
+        s1 = veorq_u8(AES_DEC_LAST(s1, fk1), rk1);
+        s2 = veorq_u8(AES_DEC_LAST(s2, fk2), rk2);
+        s3 = veorq_u8(AES_DEC_LAST(s3, fk3), rk3);
 
         inv_mixing_layer_512(&s0, &s1, &s2, &s3);
 
@@ -311,26 +246,21 @@ vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8
         s2 = INV_MIX_COLUMNS(s2);
         s3 = INV_MIX_COLUMNS(s3);
 
-        s0 = AES_DEC(s0, fk0);
-        s1 = AES_DEC(s1, fk1);
-        s2 = AES_DEC(s2, fk2);
-        s3 = AES_DEC(s3, fk3);
+        s0 = AES_DEC(s0, zero);
+        s1 = AES_DEC(s1, zero);
+        s2 = AES_DEC(s2, zero);
+        s3 = AES_DEC(s3, zero);
     }
 
-    rotate_bytes(round_key, 11, 16);
-    rotate_bytes(round_key + 16, 6, 16);
-    rotate_bytes(round_key + 32, 11, 16);
-    rotate_bytes(round_key + 48, 6, 16);
-
-    rk0 = vld1q_u8(round_key);
-    rk1 = vld1q_u8(round_key + 16);
-    rk2 = vld1q_u8(round_key + 32);
-    rk3 = vld1q_u8(round_key + 48);
+    rk0 = rotate_bytes(rk0, 11);
+    rk1 = rotate_bytes(rk1, 6);
+    rk2 = rotate_bytes(rk2, 11);
+    rk3 = rotate_bytes(rk3, 6);
 
-    s0 = AES_DEC_LAST(s0, rk0);
-    s1 = AES_DEC_LAST(s1, rk1);
-    s2 = AES_DEC_LAST(s2, rk2);
-    s3 = AES_DEC_LAST(s3, rk3);
+    s0 = veorq_u8(AES_DEC_LAST(s0, fk0), rk0);
+    s1 = veorq_u8(AES_DEC_LAST(s1, fk1), rk1);
+    s2 = veorq_u8(AES_DEC_LAST(s2, fk2), rk2);
+    s3 = veorq_u8(AES_DEC_LAST(s3, fk3), rk3);
 
     vst1q_u8(plaintext, s0);
     vst1q_u8(plaintext + 16, s1);
@@ -338,4 +268,44 @@ vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8
     vst1q_u8(plaintext + 48, s3);
 }
 
+#    ifdef VISTRUTAH_SVE2
+bool vistrutah_sve2_available(void);
+void vistrutah_512_encrypt_blocks_sve2(const uint8_t* plaintext, uint8_t* ciphertext,
+                                       size_t blocks, const uint8_t* key, int key_size,
+                                       int rounds);
+void vistrutah_512_decrypt_blocks_sve2(const uint8_t* ciphertext, uint8_t* plaintext,
+                                       size_t blocks, const uint8_t* key, int key_size,
+                                       int rounds);
+#    endif
+
+void
+vistrutah_512_encrypt_blocks(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+#    ifdef VISTRUTAH_SVE2
+    if (vistrutah_sve2_available()) {
+        vistrutah_512_encrypt_blocks_sve2(plaintext, ciphertext, blocks, key, key_size, rounds);
+        return;
+    }
+#    endif
+    for (size_t i = 0; i < blocks; i++) {
+        vistrutah_512_encrypt(plaintext + 64 * i, ciphertext + 64 * i, key, key_size, rounds);
+    }
+}
+
+void
+vistrutah_512_decrypt_blocks(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+#    ifdef VISTRUTAH_SVE2
+    if (vistrutah_sve2_available()) {
+        vistrutah_512_decrypt_blocks_sve2(ciphertext, plaintext, blocks, key, key_size, rounds);
+        return;
+    }
+#    endif
+    for (size_t i = 0; i < blocks; i++) {
+        vistrutah_512_decrypt(ciphertext + 64 * i, plaintext + 64 * i, key, key_size, rounds);
+    }
+}
+
 #endif
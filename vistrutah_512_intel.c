@@ -1,6 +1,9 @@
+#define VISTRUTAH_BACKEND
+
 #include "vistrutah.h"
 
-#ifdef VISTRUTAH_INTEL
+// Superseded by vistrutah_512_vaes.c on VAES+AVX2 CPUs without AVX-512
+#if defined(VISTRUTAH_INTEL) && !defined(VISTRUTAH_512_VAES256)
 
 #    include <immintrin.h>
 #    include <string.h>
@@ -241,12 +244,15 @@ vistrutah_512_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8
     _mm_storeu_si128((__m128i*) (ciphertext + 48), s3);
 }
 
-// Helper to rotate backward (used for reverse key schedule)
-// Rotate backward is equivalent to rotate forward by (16 - shift)
-static inline void
-rotate_bytes_backward(uint8_t* data, int shift, int len)
+// Rotate left by a runtime byte count, for the starting point of the
+// decryption key schedule
+static inline __m128i
+rotate_bytes_var(__m128i v, int shift)
 {
-    rotate_bytes(data, len - shift, len);
+    const __m128i iota = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m128i       idx  = _mm_add_epi8(iota, _mm_set1_epi8((char) shift));
+
+    return _mm_shuffle_epi8(v, _mm_and_si128(idx, _mm_set1_epi8(15)));
 }
 
 void
@@ -254,7 +260,6 @@ vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8
                       int key_size, int rounds)
 {
     uint8_t fixed_key[64];
-    uint8_t round_key[64];
     int     steps = rounds / ROUNDS_PER_STEP;
 
     __m128i s0 = _mm_loadu_si128((const __m128i*) ciphertext);
@@ -275,33 +280,23 @@ vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8
         fixed_key[32 + i] = temp[VISTRUTAH_KEXP_SHUFFLE[i]];
     }
 
-    memcpy(round_key, fixed_key + 16, 16);
-    memcpy(round_key + 16, fixed_key, 16);
-    memcpy(round_key + 32, fixed_key + 48, 16);
-    memcpy(round_key + 48, fixed_key + 32, 16);
-
-    for (int i = 0; i < steps; i++) {
-        rotate_bytes(round_key, 5, 16);
-        rotate_bytes(round_key + 16, 10, 16);
-        rotate_bytes(round_key + 32, 5, 16);
-        rotate_bytes(round_key + 48, 10, 16);
-    }
-
     __m128i fk0 = _mm_loadu_si128((const __m128i*) fixed_key);
     __m128i fk1 = _mm_loadu_si128((const __m128i*) (fixed_key + 16));
     __m128i fk2 = _mm_loadu_si128((const __m128i*) (fixed_key + 32));
     __m128i fk3 = _mm_loadu_si128((const __m128i*) (fixed_key + 48));
 
+    // Last round key, computed directly; the loop below walks the schedule
+    // backwards in registers (rotations by 16 - 5 and 16 - 10).
+    __m128i rk0 = rotate_bytes_var(fk1, (5 * steps) % 16);
+    __m128i rk1 = rotate_bytes_var(fk0, (10 * steps) % 16);
+    __m128i rk2 = rotate_bytes_var(fk3, (5 * steps) % 16);
+    __m128i rk3 = rotate_bytes_var(fk2, (10 * steps) % 16);
+
     __m128i fk0_imc = _mm_aesimc_si128(fk0);
     __m128i fk1_imc = _mm_aesimc_si128(fk1);
     __m128i fk2_imc = _mm_aesimc_si128(fk2);
     __m128i fk3_imc = _mm_aesimc_si128(fk3);
 
-    __m128i rk0 = _mm_loadu_si128((const __m128i*) round_key);
-    __m128i rk1 = _mm_loadu_si128((const __m128i*) (round_key + 16));
-    __m128i rk2 = _mm_loadu_si128((const __m128i*) (round_key + 32));
-    __m128i rk3 = _mm_loadu_si128((const __m128i*) (round_key + 48));
-
     s0 = _mm_xor_si128(s0, rk0);
     s1 = _mm_xor_si128(s1, rk1);
     s2 = _mm_xor_si128(s2, rk2);
@@ -312,26 +307,21 @@ vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8
     s3 = aes_inv_round(s3, fk3_imc);
 
     for (int i = steps - 1; i >= 1; i--) {
-        rotate_bytes_backward(round_key, 5, 16);
-        rotate_bytes_backward(round_key + 16, 10, 16);
-        rotate_bytes_backward(round_key + 32, 5, 16);
-        rotate_bytes_backward(round_key + 48, 10, 16);
+        rk0 = _mm_alignr_epi8(rk0, rk0, 11);
+        rk1 = _mm_alignr_epi8(rk1, rk1, 6);
+        rk2 = _mm_alignr_epi8(rk2, rk2, 11);
+        rk3 = _mm_alignr_epi8(rk3, rk3, 6);
 
-        rk0 = _mm_loadu_si128((const __m128i*) round_key);
-        rk1 = _mm_loadu_si128((const __m128i*) (round_key + 16));
-        rk2 = _mm_loadu_si128((const __m128i*) (round_key + 32));
-        rk3 = _mm_loadu_si128((const __m128i*) (round_key + 48));
+        __m128i rc = _mm_loadu_si128((const __m128i*) &ROUND_CONSTANTS[16 * (i - 1)]);
 
-        s0 = aes_inv_final_round(s0, rk0);
+        s0 = aes_inv_final_round(s0, _mm_xor_si128(rk0, rc));
         s1 = aes_inv_final_round(s1, rk1);
         s2 = aes_inv_final_round(s2, rk2);
         s3 = aes_inv_final_round(s3, rk3);
 
-        __m128i rc = _mm_loadu_si128((const __m128i*) &ROUND_CONSTANTS[16 * (i - 1)]);
-        s0         = _mm_xor_si128(s0, rc);
-
         inv_mixing_layer_512_sse(&s0, &s1, &s2, &s3);
 
+        // Not foldable into the keys: the transpose mixes columns
         s0 = _mm_aesimc_si128(s0);
         s1 = _mm_aesimc_si128(s1);
         s2 = _mm_aesimc_si128(s2);
@@ -343,15 +333,10 @@ vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8
         s3 = aes_inv_round(s3, fk3_imc);
     }
 
-    rotate_bytes_backward(round_key, 5, 16);
-    rotate_bytes_backward(round_key + 16, 10, 16);
-    rotate_bytes_backward(round_key + 32, 5, 16);
-    rotate_bytes_backward(round_key + 48, 10, 16);
-
-    rk0 = _mm_loadu_si128((const __m128i*) round_key);
-    rk1 = _mm_loadu_si128((const __m128i*) (round_key + 16));
-    rk2 = _mm_loadu_si128((const __m128i*) (round_key + 32));
-    rk3 = _mm_loadu_si128((const __m128i*) (round_key + 48));
+    rk0 = _mm_alignr_epi8(rk0, rk0, 11);
+    rk1 = _mm_alignr_epi8(rk1, rk1, 6);
+    rk2 = _mm_alignr_epi8(rk2, rk2, 11);
+    rk3 = _mm_alignr_epi8(rk3, rk3, 6);
 
     s0 = aes_inv_final_round(s0, rk0);
     s1 = aes_inv_final_round(s1, rk1);
@@ -364,4 +349,34 @@ vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8
     _mm_storeu_si128((__m128i*) (plaintext + 48), s3);
 }
 
+void
+vistrutah_512_encrypt_blocks(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+#    ifdef VISTRUTAH_512_VAES_KERNEL
+    if (vistrutah_kernel_configs[VISTRUTAH_512_ENCRYPT].blocks_in_flight > 1) {
+        vistrutah_512_vaes_blocks(plaintext, ciphertext, blocks, key, key_size, rounds, 0);
+        return;
+    }
+#    endif
+    for (size_t i = 0; i < blocks; i++) {
+        vistrutah_512_encrypt(plaintext + 64 * i, ciphertext + 64 * i, key, key_size, rounds);
+    }
+}
+
+void
+vistrutah_512_decrypt_blocks(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+#    ifdef VISTRUTAH_512_VAES_KERNEL
+    if (vistrutah_kernel_configs[VISTRUTAH_512_DECRYPT].blocks_in_flight > 1) {
+        vistrutah_512_vaes_blocks(ciphertext, plaintext, blocks, key, key_size, rounds, 1);
+        return;
+    }
+#    endif
+    for (size_t i = 0; i < blocks; i++) {
+        vistrutah_512_decrypt(ciphertext + 64 * i, plaintext + 64 * i, key, key_size, rounds);
+    }
+}
+
 #endif
@@ -0,0 +1,603 @@
+#define VISTRUTAH_BACKEND
+
+#include "vistrutah.h"
+
+#if defined(VISTRUTAH_INTEL) && defined(VISTRUTAH_512_VAES_KERNEL)
+
+#    include <immintrin.h>
+#    include <string.h>
+
+extern const uint8_t ROUND_CONSTANTS[16 * 48];
+extern const uint8_t VISTRUTAH_KEXP_SHUFFLE[32];
+
+// Vistrutah-512 on VAES with 256-bit vectors. On CPUs without AVX-512 this
+// replaces vistrutah_512_intel.c; with AVX-512 only the batch kernel is
+// built, as an alternative the autotuner can select.
+//
+// A block is held in two ymm registers as a = [s0|s2], b = [s1|s3]. With
+// this layout the first half of the transpose is an in-lane unpack of a and
+// b, and each output register then only needs one vpermq and one vpshufb.
+// Round keys are stored in the same layout.
+
+#    define PARALLEL_BLOCKS     4
+#    define MAX_PARALLEL_BLOCKS 8
+
+// Every step but the last adds one of the 48 round constants, so key
+// schedules are sized for the longest round count they support (98), not
+// just the named round counts
+#    define MAX_STEPS (48 + 1)
+
+#    define ALWAYS_INLINE inline __attribute__((always_inline))
+
+static ALWAYS_INLINE __m256i
+load_pair(const uint8_t* lo, const uint8_t* hi)
+{
+    __m128i l = _mm_loadu_si128((const __m128i*) lo);
+    __m128i h = _mm_loadu_si128((const __m128i*) hi);
+
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(l), h, 1);
+}
+
+static ALWAYS_INLINE void
+store_pair(uint8_t* lo, uint8_t* hi, __m256i v)
+{
+    _mm_storeu_si128((__m128i*) lo, _mm256_castsi256_si128(v));
+    _mm_storeu_si128((__m128i*) hi, _mm256_extracti128_si256(v, 1));
+}
+
+static ALWAYS_INLINE void
+mixing_layer_512(__m256i* a, __m256i* b)
+{
+    // [x|y] -> [unpacklo_epi16(x, y)|unpackhi_epi16(x, y)]
+    const __m256i interleave_words =
+        _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15, 0, 1, 8, 9, 2, 3,
+                         10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+
+    __m256i lo = _mm256_unpacklo_epi8(*a, *b);  // [lo(s0,s1)|lo(s2,s3)]
+    __m256i hi = _mm256_unpackhi_epi8(*a, *b);  // [hi(s0,s1)|hi(s2,s3)]
+
+    *a = _mm256_shuffle_epi8(_mm256_permute4x64_epi64(lo, 0xd8), interleave_words);
+    *b = _mm256_shuffle_epi8(_mm256_permute4x64_epi64(hi, 0xd8), interleave_words);
+}
+
+static ALWAYS_INLINE void
+inv_mixing_layer_512(__m256i* a, __m256i* b)
+{
+    const __m256i deinterleave_words =
+        _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15, 0, 1, 4, 5, 8, 9,
+                         12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+    const __m256i split_bytes =
+        _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15, 0, 2, 4, 6, 8, 10,
+                         12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+
+    __m256i lo = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(*a, deinterleave_words), 0xd8);
+    __m256i hi = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(*b, deinterleave_words), 0xd8);
+
+    lo = _mm256_shuffle_epi8(lo, split_bytes);
+    hi = _mm256_shuffle_epi8(hi, split_bytes);
+
+    *a = _mm256_unpacklo_epi64(lo, hi);
+    *b = _mm256_unpackhi_epi64(lo, hi);
+}
+
+// rk[2 * i], rk[2 * i + 1]: round key of step i, round constant included.
+// fk[0], fk[1]: fixed key.
+static void
+expand_key(__m256i* fk, __m256i* rk, const uint8_t* key, int key_size, int steps)
+{
+    uint8_t fixed_key[64];
+    uint8_t temp[32];
+
+    if (key_size == 32) {
+        memcpy(fixed_key, key, 32);
+        memcpy(fixed_key + 32, key, 32);
+    } else {
+        memcpy(fixed_key, key, 64);
+    }
+
+    memcpy(temp, fixed_key + 32, 32);
+    for (int i = 0; i < 32; i++) {
+        fixed_key[32 + i] = temp[VISTRUTAH_KEXP_SHUFFLE[i]];
+    }
+
+    fk[0] = load_pair(fixed_key, fixed_key + 32);
+    fk[1] = load_pair(fixed_key + 16, fixed_key + 48);
+
+    __m128i rk0 = _mm_loadu_si128((const __m128i*) (fixed_key + 16));
+    __m128i rk1 = _mm_loadu_si128((const __m128i*) fixed_key);
+    __m128i rk2 = _mm_loadu_si128((const __m128i*) (fixed_key + 48));
+    __m128i rk3 = _mm_loadu_si128((const __m128i*) (fixed_key + 32));
+
+    for (int i = 0; i <= steps; i++) {
+        __m128i k0 = rk0;
+
+        if (i > 0 && i < steps) {
+            k0 = _mm_xor_si128(k0, _mm_loadu_si128((const __m128i*) &ROUND_CONSTANTS[16 * (i - 1)]));
+        }
+        rk[2 * i]     = _mm256_inserti128_si256(_mm256_castsi128_si256(k0), rk2, 1);
+        rk[2 * i + 1] = _mm256_inserti128_si256(_mm256_castsi128_si256(rk1), rk3, 1);
+
+        rk0 = _mm_alignr_epi8(rk0, rk0, 5);
+        rk1 = _mm_alignr_epi8(rk1, rk1, 10);
+        rk2 = _mm_alignr_epi8(rk2, rk2, 5);
+        rk3 = _mm_alignr_epi8(rk3, rk3, 10);
+    }
+}
+
+static ALWAYS_INLINE void
+load_n(const uint8_t* const* in, __m256i* a, __m256i* b, const int n)
+{
+    for (int j = 0; j < n; j++) {
+        const uint8_t* p = in[j];
+
+        a[j] = load_pair(p, p + 32);
+        b[j] = load_pair(p + 16, p + 48);
+    }
+}
+
+static ALWAYS_INLINE void
+store_n(uint8_t* const* out, const __m256i* a, const __m256i* b, const int n)
+{
+    for (int j = 0; j < n; j++) {
+        uint8_t* q = out[j];
+
+        store_pair(q, q + 32, a[j]);
+        store_pair(q + 16, q + 48, b[j]);
+    }
+}
+
+static ALWAYS_INLINE void
+encrypt_regs(__m256i* a, __m256i* b, const __m256i* fk, const __m256i* rk, int steps, const int n)
+{
+    for (int j = 0; j < n; j++) {
+        a[j] = _mm256_aesenc_epi128(_mm256_xor_si256(a[j], rk[0]), fk[0]);
+        b[j] = _mm256_aesenc_epi128(_mm256_xor_si256(b[j], rk[1]), fk[1]);
+    }
+
+    for (int i = 1; i < steps; i++) {
+        // rk[] of the inner steps is stored through the inverse mixing layer
+        // so that it can be added by the AES round in front of the layer.
+        for (int j = 0; j < n; j++) {
+            a[j] = _mm256_aesenc_epi128(a[j], rk[2 * i]);
+            b[j] = _mm256_aesenc_epi128(b[j], rk[2 * i + 1]);
+            mixing_layer_512(&a[j], &b[j]);
+            a[j] = _mm256_aesenc_epi128(a[j], fk[0]);
+            b[j] = _mm256_aesenc_epi128(b[j], fk[1]);
+        }
+    }
+
+    for (int j = 0; j < n; j++) {
+        a[j] = _mm256_aesenclast_epi128(a[j], rk[2 * steps]);
+        b[j] = _mm256_aesenclast_epi128(b[j], rk[2 * steps + 1]);
+    }
+}
+
+static ALWAYS_INLINE void
+decrypt_regs(__m256i* a, __m256i* b, const __m256i* fk_imc, const __m256i* rk, int steps,
+             const int n)
+{
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (int j = 0; j < n; j++) {
+        a[j] = _mm256_aesdec_epi128(_mm256_xor_si256(a[j], rk[2 * steps]), fk_imc[0]);
+        b[j] = _mm256_aesdec_epi128(_mm256_xor_si256(b[j], rk[2 * steps + 1]), fk_imc[1]);
+    }
+
+    for (int i = steps - 1; i > 0; i--) {
+        for (int j = 0; j < n; j++) {
+            a[j] = _mm256_aesdeclast_epi128(a[j], rk[2 * i]);
+            b[j] = _mm256_aesdeclast_epi128(b[j], rk[2 * i + 1]);
+            inv_mixing_layer_512(&a[j], &b[j]);
+            // There is no 256-bit AESIMC; InvMixColumns(x) is computed as
+            // AESDEC(AESENCLAST(x, 0), 0) instead.
+            a[j] = _mm256_aesdec_epi128(_mm256_aesenclast_epi128(a[j], zero), zero);
+            b[j] = _mm256_aesdec_epi128(_mm256_aesenclast_epi128(b[j], zero), zero);
+            a[j] = _mm256_aesdec_epi128(a[j], fk_imc[0]);
+            b[j] = _mm256_aesdec_epi128(b[j], fk_imc[1]);
+        }
+    }
+
+    for (int j = 0; j < n; j++) {
+        a[j] = _mm256_aesdeclast_epi128(a[j], rk[0]);
+        b[j] = _mm256_aesdeclast_epi128(b[j], rk[1]);
+    }
+}
+
+static ALWAYS_INLINE void
+encrypt_n(const uint8_t* const* in, uint8_t* const* out, const __m256i* fk, const __m256i* rk,
+          int steps, const int n)
+{
+    __m256i a[MAX_PARALLEL_BLOCKS], b[MAX_PARALLEL_BLOCKS];
+
+    load_n(in, a, b, n);
+    encrypt_regs(a, b, fk, rk, steps, n);
+    store_n(out, a, b, n);
+}
+
+static ALWAYS_INLINE void
+decrypt_n(const uint8_t* const* in, uint8_t* const* out, const __m256i* fk_imc,
+          const __m256i* rk, int steps, const int n)
+{
+    __m256i a[MAX_PARALLEL_BLOCKS], b[MAX_PARALLEL_BLOCKS];
+
+    load_n(in, a, b, n);
+    decrypt_regs(a, b, fk_imc, rk, steps, n);
+    store_n(out, a, b, n);
+}
+
+static int
+encrypt_schedule(__m256i* fk, __m256i* rk, const uint8_t* key, int key_size, int rounds)
+{
+    int steps = rounds / ROUNDS_PER_STEP;
+
+    expand_key(fk, rk, key, key_size, steps);
+    for (int s = 1; s < steps; s++) {
+        inv_mixing_layer_512(&rk[2 * s], &rk[2 * s + 1]);
+    }
+    return steps;
+}
+
+static int
+decrypt_schedule(__m256i* fk, __m256i* rk, const uint8_t* key, int key_size, int rounds)
+{
+    int steps = rounds / ROUNDS_PER_STEP;
+
+    expand_key(fk, rk, key, key_size, steps);
+    for (int k = 0; k < 2; k++) {
+        __m128i lo = _mm_aesimc_si128(_mm256_castsi256_si128(fk[k]));
+        __m128i hi = _mm_aesimc_si128(_mm256_extracti128_si256(fk[k], 1));
+
+        fk[k] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    }
+    return steps;
+}
+
+static ALWAYS_INLINE void
+crypt_strided_w(const uint8_t* in, size_t in_stride, uint8_t* out, size_t out_stride, size_t n,
+                const uint8_t* key, int key_size, int rounds, int decrypt, const int width)
+{
+    __m256i        fk[2];
+    __m256i        rk[2 * (MAX_STEPS + 1)];
+    const uint8_t* ip[MAX_PARALLEL_BLOCKS];
+    uint8_t*       op[MAX_PARALLEL_BLOCKS];
+    size_t         i = 0;
+    int            steps;
+
+    steps = decrypt ? decrypt_schedule(fk, rk, key, key_size, rounds)
+                    : encrypt_schedule(fk, rk, key, key_size, rounds);
+
+    for (; i < n; i += width) {
+        int m = n - i < (size_t) width ? (int) (n - i) : width;
+
+        for (int j = 0; j < m; j++) {
+            ip[j] = in + in_stride * (i + j);
+            op[j] = out + out_stride * (i + j);
+        }
+        if (m == width) {
+            if (decrypt) {
+                decrypt_n(ip, op, fk, rk, steps, width);
+            } else {
+                encrypt_n(ip, op, fk, rk, steps, width);
+            }
+            continue;
+        }
+        for (int j = 0; j < m; j++) {
+            if (decrypt) {
+                decrypt_n(ip + j, op + j, fk, rk, steps, 1);
+            } else {
+                encrypt_n(ip + j, op + j, fk, rk, steps, 1);
+            }
+        }
+    }
+}
+
+// The number of blocks in flight is the one chosen for the direction by the
+// autotuner (vistrutah_tune.c); PARALLEL_BLOCKS unless tuned
+static void
+crypt_strided(const uint8_t* in, size_t in_stride, uint8_t* out, size_t out_stride, size_t n,
+              const uint8_t* key, int key_size, int rounds, int decrypt)
+{
+    vistrutah_variant v = decrypt ? VISTRUTAH_512_DECRYPT : VISTRUTAH_512_ENCRYPT;
+
+    switch (vistrutah_kernel_configs[v].blocks_in_flight) {
+    case 2:
+        crypt_strided_w(in, in_stride, out, out_stride, n, key, key_size, rounds, decrypt, 2);
+        break;
+    case 6:
+        crypt_strided_w(in, in_stride, out, out_stride, n, key, key_size, rounds, decrypt, 6);
+        break;
+    case 8:
+        crypt_strided_w(in, in_stride, out, out_stride, n, key, key_size, rounds, decrypt, 8);
+        break;
+    default:
+        crypt_strided_w(in, in_stride, out, out_stride, n, key, key_size, rounds, decrypt,
+                        PARALLEL_BLOCKS);
+        break;
+    }
+}
+
+#    ifdef VISTRUTAH_512_VAES256
+void
+vistrutah_512_encrypt_blocks(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    crypt_strided(plaintext, 64, ciphertext, 64, blocks, key, key_size, rounds, 0);
+}
+
+void
+vistrutah_512_decrypt_blocks(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    crypt_strided(ciphertext, 64, plaintext, 64, blocks, key, key_size, rounds, 1);
+}
+
+// Records are loaded and stored in place, so the kernel needs no gather buffer
+void
+vistrutah_512_encrypt_strided(const vistrutah_512_ctx* ctx, const uint8_t* in, size_t in_stride,
+                              uint8_t* out, size_t out_stride, size_t n)
+{
+    VISTRUTAH_ENTER(t0, batch, 512_ENCRYPT_STRIDED, 64 * n);
+    crypt_strided(in, in_stride, out, out_stride, n, ctx->key, ctx->key_size, ctx->rounds, 0);
+    VISTRUTAH_LEAVE(t0, batch, 512_ENCRYPT_STRIDED);
+}
+
+void
+vistrutah_512_decrypt_strided(const vistrutah_512_ctx* ctx, const uint8_t* in, size_t in_stride,
+                              uint8_t* out, size_t out_stride, size_t n)
+{
+    VISTRUTAH_ENTER(t0, batch, 512_DECRYPT_STRIDED, 64 * n);
+    crypt_strided(in, in_stride, out, out_stride, n, ctx->key, ctx->key_size, ctx->rounds, 1);
+    VISTRUTAH_LEAVE(t0, batch, 512_DECRYPT_STRIDED);
+}
+
+// Per-lane variants of encrypt_regs/decrypt_regs: block j uses the key
+// schedule at fk[j], rk[j]. All lanes must have the same number of steps.
+static ALWAYS_INLINE void
+encrypt_lanes(__m256i* a, __m256i* b, const __m256i* const* fk, const __m256i* const* rk,
+              int steps)
+{
+    for (int j = 0; j < PARALLEL_BLOCKS; j++) {
+        a[j] = _mm256_aesenc_epi128(_mm256_xor_si256(a[j], rk[j][0]), fk[j][0]);
+        b[j] = _mm256_aesenc_epi128(_mm256_xor_si256(b[j], rk[j][1]), fk[j][1]);
+    }
+
+    for (int i = 1; i < steps; i++) {
+        for (int j = 0; j < PARALLEL_BLOCKS; j++) {
+            a[j] = _mm256_aesenc_epi128(a[j], rk[j][2 * i]);
+            b[j] = _mm256_aesenc_epi128(b[j], rk[j][2 * i + 1]);
+            mixing_layer_512(&a[j], &b[j]);
+            a[j] = _mm256_aesenc_epi128(a[j], fk[j][0]);
+            b[j] = _mm256_aesenc_epi128(b[j], fk[j][1]);
+        }
+    }
+
+    for (int j = 0; j < PARALLEL_BLOCKS; j++) {
+        a[j] = _mm256_aesenclast_epi128(a[j], rk[j][2 * steps]);
+        b[j] = _mm256_aesenclast_epi128(b[j], rk[j][2 * steps + 1]);
+    }
+}
+
+static ALWAYS_INLINE void
+decrypt_lanes(__m256i* a, __m256i* b, const __m256i* const* fk_imc, const __m256i* const* rk,
+              int steps)
+{
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (int j = 0; j < PARALLEL_BLOCKS; j++) {
+        a[j] = _mm256_aesdec_epi128(_mm256_xor_si256(a[j], rk[j][2 * steps]), fk_imc[j][0]);
+        b[j] = _mm256_aesdec_epi128(_mm256_xor_si256(b[j], rk[j][2 * steps + 1]), fk_imc[j][1]);
+    }
+
+    for (int i = steps - 1; i > 0; i--) {
+        for (int j = 0; j < PARALLEL_BLOCKS; j++) {
+            a[j] = _mm256_aesdeclast_epi128(a[j], rk[j][2 * i]);
+            b[j] = _mm256_aesdeclast_epi128(b[j], rk[j][2 * i + 1]);
+            inv_mixing_layer_512(&a[j], &b[j]);
+            a[j] = _mm256_aesdec_epi128(_mm256_aesenclast_epi128(a[j], zero), zero);
+            b[j] = _mm256_aesdec_epi128(_mm256_aesenclast_epi128(b[j], zero), zero);
+            a[j] = _mm256_aesdec_epi128(a[j], fk_imc[j][0]);
+            b[j] = _mm256_aesdec_epi128(b[j], fk_imc[j][1]);
+        }
+    }
+
+    for (int j = 0; j < PARALLEL_BLOCKS; j++) {
+        a[j] = _mm256_aesdeclast_epi128(a[j], rk[j][0]);
+        b[j] = _mm256_aesdeclast_epi128(b[j], rk[j][1]);
+    }
+}
+
+// Key schedules of the contexts seen most recently by crypt_ptrs
+typedef struct {
+    const vistrutah_512_ctx* ctx;
+    int                      steps;
+    __m256i                  fk[2];
+    __m256i                  rk[2 * (MAX_STEPS + 1)];
+} lane_schedule;
+
+// Returns the schedule of c, computing it into a slot that no lane of the
+// current group (used) refers to if it is not cached
+static const lane_schedule*
+schedule_for(lane_schedule* cache, const vistrutah_512_ctx* c, unsigned used, int* victim,
+             int decrypt)
+{
+    for (int k = 0; k < PARALLEL_BLOCKS; k++) {
+        if (cache[k].ctx == c) {
+            return &cache[k];
+        }
+    }
+
+    int k = *victim;
+
+    while (used & (1u << k)) {
+        k = (k + 1) % PARALLEL_BLOCKS;
+    }
+    *victim = (k + 1) % PARALLEL_BLOCKS;
+
+    lane_schedule* s = &cache[k];
+
+    s->ctx   = c;
+    s->steps = decrypt ? decrypt_schedule(s->fk, s->rk, c->key, c->key_size, c->rounds)
+                       : encrypt_schedule(s->fk, s->rk, c->key, c->key_size, c->rounds);
+    return s;
+}
+
+// Groups of PARALLEL_BLOCKS entries go through the kernel straight from the
+// caller's pointers while the entries VISTRUTAH_PREFETCH_AHEAD ahead are
+// prefetched. A group whose entries use different contexts is still
+// processed in one pass, with a key schedule per lane, as long as the round
+// counts match; schedules are cached so runs of one context compute theirs
+// once.
+static void
+crypt_ptrs(const vistrutah_512_ctx* ctx, const vistrutah_512_ctx* const* ctxs,
+           const uint8_t* const* in, uint8_t* const* out, size_t n, int decrypt)
+{
+    lane_schedule cache[PARALLEL_BLOCKS];
+    int           victim = 0;
+    size_t        i      = 0;
+
+    for (int k = 0; k < PARALLEL_BLOCKS; k++) {
+        cache[k].ctx = NULL;
+    }
+
+    for (; i + PARALLEL_BLOCKS <= n; i += PARALLEL_BLOCKS) {
+        const lane_schedule* s[PARALLEL_BLOCKS];
+        const __m256i*       fk[PARALLEL_BLOCKS];
+        const __m256i*       rk[PARALLEL_BLOCKS];
+        __m256i              a[PARALLEL_BLOCKS], b[PARALLEL_BLOCKS];
+        unsigned             used   = 0;
+        bool                 shared = true, lanes = true;
+
+        for (int j = 0; j < PARALLEL_BLOCKS; j++) {
+            s[j] = schedule_for(cache, ctxs != NULL ? ctxs[i + j] : ctx, used, &victim, decrypt);
+            used |= 1u << (s[j] - cache);
+            fk[j] = s[j]->fk;
+            rk[j] = s[j]->rk;
+            shared &= s[j] == s[0];
+            lanes &= s[j]->steps == s[0]->steps;
+        }
+
+        vistrutah_prefetch_ptrs(in, out, i + VISTRUTAH_PREFETCH_AHEAD, PARALLEL_BLOCKS, n);
+        if (shared) {
+            if (decrypt) {
+                decrypt_n(in + i, out + i, s[0]->fk, s[0]->rk, s[0]->steps, PARALLEL_BLOCKS);
+            } else {
+                encrypt_n(in + i, out + i, s[0]->fk, s[0]->rk, s[0]->steps, PARALLEL_BLOCKS);
+            }
+        } else if (lanes) {
+            load_n(in + i, a, b, PARALLEL_BLOCKS);
+            if (decrypt) {
+                decrypt_lanes(a, b, fk, rk, s[0]->steps);
+            } else {
+                encrypt_lanes(a, b, fk, rk, s[0]->steps);
+            }
+            store_n(out + i, a, b, PARALLEL_BLOCKS);
+        } else {
+            for (int j = 0; j < PARALLEL_BLOCKS; j++) {
+                if (decrypt) {
+                    decrypt_n(in + i + j, out + i + j, fk[j], rk[j], s[j]->steps, 1);
+                } else {
+                    encrypt_n(in + i + j, out + i + j, fk[j], rk[j], s[j]->steps, 1);
+                }
+            }
+        }
+    }
+
+    for (; i < n; i++) {
+        const lane_schedule* s =
+            schedule_for(cache, ctxs != NULL ? ctxs[i] : ctx, 0, &victim, decrypt);
+
+        if (decrypt) {
+            decrypt_n(in + i, out + i, s->fk, s->rk, s->steps, 1);
+        } else {
+            encrypt_n(in + i, out + i, s->fk, s->rk, s->steps, 1);
+        }
+    }
+}
+
+void
+vistrutah_512_encrypt_ptrs(const vistrutah_512_ctx* ctx, const vistrutah_512_ctx* const* ctxs,
+                           const uint8_t* const* in, uint8_t* const* out, size_t n)
+{
+    VISTRUTAH_ENTER(t0, batch, 512_ENCRYPT_PTRS, 64 * n);
+    crypt_ptrs(ctx, ctxs, in, out, n, 0);
+    VISTRUTAH_LEAVE(t0, batch, 512_ENCRYPT_PTRS);
+}
+
+void
+vistrutah_512_decrypt_ptrs(const vistrutah_512_ctx* ctx, const vistrutah_512_ctx* const* ctxs,
+                           const uint8_t* const* in, uint8_t* const* out, size_t n)
+{
+    VISTRUTAH_ENTER(t0, batch, 512_DECRYPT_PTRS, 64 * n);
+    crypt_ptrs(ctx, ctxs, in, out, n, 1);
+    VISTRUTAH_LEAVE(t0, batch, 512_DECRYPT_PTRS);
+}
+
+// Decryption under the old key feeds encryption under the new one without
+// leaving the registers
+void
+vistrutah_512_reencrypt_blocks(const vistrutah_512_ctx* from, const vistrutah_512_ctx* to,
+                               const uint8_t* in, uint8_t* out, size_t blocks)
+{
+    __m256i fk_from[2], fk_to[2];
+    __m256i rk_from[2 * (MAX_STEPS + 1)], rk_to[2 * (MAX_STEPS + 1)];
+    __m256i a[PARALLEL_BLOCKS], b[PARALLEL_BLOCKS];
+    int     steps_from, steps_to;
+
+    VISTRUTAH_ENTER(t0, batch, 512_REENCRYPT, 64 * blocks);
+
+    steps_from = decrypt_schedule(fk_from, rk_from, from->key, from->key_size, from->rounds);
+    steps_to   = encrypt_schedule(fk_to, rk_to, to->key, to->key_size, to->rounds);
+
+    for (size_t i = 0; i < blocks; i += PARALLEL_BLOCKS) {
+        const uint8_t* ip[PARALLEL_BLOCKS];
+        uint8_t*       op[PARALLEL_BLOCKS];
+        int            m = blocks - i < PARALLEL_BLOCKS ? (int) (blocks - i) : PARALLEL_BLOCKS;
+
+        for (int j = 0; j < m; j++) {
+            ip[j] = in + 64 * (i + j);
+            op[j] = out + 64 * (i + j);
+        }
+        if (m == PARALLEL_BLOCKS) {
+            load_n(ip, a, b, PARALLEL_BLOCKS);
+            decrypt_regs(a, b, fk_from, rk_from, steps_from, PARALLEL_BLOCKS);
+            encrypt_regs(a, b, fk_to, rk_to, steps_to, PARALLEL_BLOCKS);
+            store_n(op, a, b, PARALLEL_BLOCKS);
+            continue;
+        }
+        for (int j = 0; j < m; j++) {
+            load_n(ip + j, a, b, 1);
+            decrypt_regs(a, b, fk_from, rk_from, steps_from, 1);
+            encrypt_regs(a, b, fk_to, rk_to, steps_to, 1);
+            store_n(op + j, a, b, 1);
+        }
+    }
+    VISTRUTAH_LEAVE(t0, batch, 512_REENCRYPT);
+}
+
+void
+vistrutah_512_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8_t* key,
+                      int key_size, int rounds)
+{
+    vistrutah_512_encrypt_blocks(plaintext, ciphertext, 1, key, key_size, rounds);
+}
+
+void
+vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key,
+                      int key_size, int rounds)
+{
+    vistrutah_512_decrypt_blocks(ciphertext, plaintext, 1, key, key_size, rounds);
+}
+
+#    else
+
+// With AVX-512 the AES-NI code in vistrutah_512_intel.c is the default and
+// this kernel is an alternative for batches
+void
+vistrutah_512_vaes_blocks(const uint8_t* in, uint8_t* out, size_t blocks, const uint8_t* key,
+                          int key_size, int rounds, int decrypt)
+{
+    crypt_strided(in, 64, out, 64, blocks, key, key_size, rounds, decrypt);
+}
+
+#    endif
+#endif
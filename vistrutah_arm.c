@@ -1,3 +1,5 @@
+#define VISTRUTAH_BACKEND
+
 #include "vistrutah.h"
 
 #ifdef VISTRUTAH_ARM
@@ -12,10 +14,14 @@ extern const uint8_t VISTRUTAH_P4_INV[16];
 extern const uint8_t VISTRUTAH_P5_INV[16];
 extern const uint8_t VISTRUTAH_ZERO[16];
 
-#    define AES_ENC(A, B)      veorq_u8(vaesmcq_u8(vaeseq_u8(vmovq_n_u8(0), (A))), (B))
-#    define AES_ENC_LAST(A, B) veorq_u8(vaeseq_u8(vmovq_n_u8(0), (A)), (B))
-#    define AES_DEC(A, B)      veorq_u8(vaesimcq_u8(vaesdq_u8(vmovq_n_u8(0), (A))), (B))
-#    define AES_DEC_LAST(A, B) veorq_u8(vaesdq_u8(vmovq_n_u8(0), (A)), (B))
+// vaeseq_u8()/vaesdq_u8() XOR their key operand into the state before
+// SubBytes, so the data paths below keep the key of the next round pending
+// and feed it into the following AESE/AESD instead of applying it with a
+// separate EOR after (Inv)MixColumns.
+#    define AES_ENC(A, K)      vaesmcq_u8(vaeseq_u8((A), (K)))
+#    define AES_ENC_LAST(A, K) vaeseq_u8((A), (K))
+#    define AES_DEC(A, K)      vaesimcq_u8(vaesdq_u8((A), (K)))
+#    define AES_DEC_LAST(A, K) vaesdq_u8((A), (K))
 #    define INV_MIX_COLUMNS(A) vaesimcq_u8(A)
 
 bool
@@ -24,10 +30,12 @@ vistrutah_has_aes_accel(void)
     return true;
 }
 
+const char* const vistrutah_impl_name = "ARM64 NEON+Crypto";
+
 const char*
 vistrutah_get_impl_name(void)
 {
-    return "ARM64 NEON+Crypto";
+    return vistrutah_impl_name;
 }
 
 static void
@@ -48,77 +56,46 @@ inv_mixing_layer_256(uint8x16_t* s0, uint8x16_t* s1)
     *s1           = vzip2q_u8(t0, t1);
 }
 
-static void
-apply_permutation(const uint8_t* perm, uint8_t* data, int len __attribute__((unused)))
-{
-    uint8x16_t d      = vld1q_u8(data);
-    uint8x16_t p      = vld1q_u8(perm);
-    uint8x16_t result = vqtbl1q_u8(d, p);
-    vst1q_u8(data, result);
-}
-
 void
 vistrutah_256_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8_t* key,
                       int key_size, int rounds)
 {
-    uint8_t fixed_key[32];
-    uint8_t round_key[32];
-    int     steps = rounds / ROUNDS_PER_STEP;
+    int steps = rounds / ROUNDS_PER_STEP;
 
     uint8x16_t s0 = vld1q_u8(plaintext);
     uint8x16_t s1 = vld1q_u8(plaintext + 16);
 
-    if (key_size == 16) {
-        uint8x16_t k = vld1q_u8(key);
-        vst1q_u8(fixed_key, k);
-        vst1q_u8(fixed_key + 16, k);
-    } else {
-        memcpy(fixed_key, key, 32);
-    }
-
-    memcpy(round_key, fixed_key + 16, 16);
-    memcpy(round_key + 16, fixed_key, 16);
+    uint8x16_t fk0 = vld1q_u8(key);
+    uint8x16_t fk1 = key_size == 16 ? fk0 : vld1q_u8(key + 16);
+    uint8x16_t rk0 = fk1;
+    uint8x16_t rk1 = fk0;
+    uint8x16_t p4  = vld1q_u8(VISTRUTAH_P4);
+    uint8x16_t p5  = vld1q_u8(VISTRUTAH_P5);
 
-    uint8x16_t fk0  = vld1q_u8(fixed_key);
-    uint8x16_t fk1  = vld1q_u8(fixed_key + 16);
-    uint8x16_t rk0  = vld1q_u8(round_key);
-    uint8x16_t rk1  = vld1q_u8(round_key + 16);
-    uint8x16_t zero = vmovq_n_u8(0);
-
-    s0 = veorq_u8(s0, rk0);
-    s1 = veorq_u8(s1, rk1);
-    s0 = AES_ENC(s0, fk0);
-    s1 = AES_ENC(s1, fk1);
+    // The initial round key is folded into the first AESE; every AES round
+    // below leaves the fixed key pending for the AESE that follows it.
+    s0 = AES_ENC(s0, rk0);
+    s1 = AES_ENC(s1, rk1);
 
     for (int i = 1; i < steps; i++) {
-        s0 = AES_ENC(s0, zero);
-        s1 = AES_ENC(s1, zero);
+        s0 = AES_ENC(s0, fk0);
+        s1 = AES_ENC(s1, fk1);
         mixing_layer_256(&s0, &s1);
 
-        apply_permutation(VISTRUTAH_P4, round_key, 16);
-        apply_permutation(VISTRUTAH_P5, round_key + 16, 16);
-
-        rk0 = vld1q_u8(round_key);
-        rk1 = vld1q_u8(round_key + 16);
-
-        s0 = veorq_u8(s0, rk0);
-        s1 = veorq_u8(s1, rk1);
+        rk0 = vqtbl1q_u8(rk0, p4);
+        rk1 = vqtbl1q_u8(rk1, p5);
 
         uint8x16_t rc = vld1q_u8(&ROUND_CONSTANTS[16 * (i - 1)]);
-        s0            = veorq_u8(s0, rc);
 
-        s0 = AES_ENC(s0, fk0);
-        s1 = AES_ENC(s1, fk1);
+        s0 = AES_ENC(s0, veorq_u8(rk0, rc));
+        s1 = AES_ENC(s1, rk1);
     }
 
-    apply_permutation(VISTRUTAH_P4, round_key, 16);
-    apply_permutation(VISTRUTAH_P5, round_key + 16, 16);
+    rk0 = vqtbl1q_u8(rk0, p4);
+    rk1 = vqtbl1q_u8(rk1, p5);
 
-    rk0 = vld1q_u8(round_key);
-    rk1 = vld1q_u8(round_key + 16);
-
-    s0 = AES_ENC_LAST(s0, rk0);
-    s1 = AES_ENC_LAST(s1, rk1);
+    s0 = veorq_u8(AES_ENC_LAST(s0, fk0), rk0);
+    s1 = veorq_u8(AES_ENC_LAST(s1, fk1), rk1);
 
     vst1q_u8(ciphertext, s0);
     vst1q_u8(ciphertext + 16, s1);
@@ -128,77 +105,101 @@ void
 vistrutah_256_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key,
                       int key_size, int rounds)
 {
-    uint8_t fixed_key[32];
-    uint8_t round_key[32];
-    int     steps = rounds / ROUNDS_PER_STEP;
+    int steps = rounds / ROUNDS_PER_STEP;
 
     uint8x16_t s0 = vld1q_u8(ciphertext);
     uint8x16_t s1 = vld1q_u8(ciphertext + 16);
 
-    if (key_size == 16) {
-        uint8x16_t k = vld1q_u8(key);
-        vst1q_u8(fixed_key, k);
-        vst1q_u8(fixed_key + 16, k);
-    } else {
-        memcpy(fixed_key, key, 32);
-    }
-
-    memcpy(round_key, fixed_key + 16, 16);
-    memcpy(round_key + 16, fixed_key, 16);
+    uint8x16_t fk0 = vld1q_u8(key);
+    uint8x16_t fk1 = key_size == 16 ? fk0 : vld1q_u8(key + 16);
+    uint8x16_t rk0 = fk1;
+    uint8x16_t rk1 = fk0;
+    uint8x16_t p4  = vld1q_u8(VISTRUTAH_P4);
+    uint8x16_t p5  = vld1q_u8(VISTRUTAH_P5);
 
     for (int i = 0; i < steps; i++) {
-        apply_permutation(VISTRUTAH_P4, round_key, 16);
-        apply_permutation(VISTRUTAH_P5, round_key + 16, 16);
+        rk0 = vqtbl1q_u8(rk0, p4);
+        rk1 = vqtbl1q_u8(rk1, p5);
     }
 
-    uint8x16_t fk0 = vld1q_u8(fixed_key);
-    uint8x16_t fk1 = vld1q_u8(fixed_key + 16);
+    uint8x16_t p4_inv = vld1q_u8(VISTRUTAH_P4_INV);
+    uint8x16_t p5_inv = vld1q_u8(VISTRUTAH_P5_INV);
+    uint8x16_t zero   = vmovq_n_u8(0);
 
     fk0 = INV_MIX_COLUMNS(fk0);
     fk1 = INV_MIX_COLUMNS(fk1);
 
-    uint8x16_t rk0 = vld1q_u8(round_key);
-    uint8x16_t rk1 = vld1q_u8(round_key + 16);
-
-    s0 = veorq_u8(s0, rk0);
-    s1 = veorq_u8(s1, rk1);
-
-    s0 = AES_DEC(s0, fk0);
-    s1 = AES_DEC(s1, fk1);
+    // The last round key goes into the first AESD; the InvMixColumns'd fixed
+    // key stays pending and is consumed by the AESD of the next step.
+    s0 = AES_DEC(s0, rk0);
+    s1 = AES_DEC(s1, rk1);
 
     for (int i = steps - 1; i > 0; i--) {
-        apply_permutation(VISTRUTAH_P4_INV, round_key, 16);
-        apply_permutation(VISTRUTAH_P5_INV, round_key + 16, 16);
-
-        rk0 = vld1q_u8(round_key);
-        rk1 = vld1q_u8(round_key + 16);
-
-        s0 = AES_DEC_LAST(s0, rk0);
-        s1 = AES_DEC_LAST(s1, rk1);
+        rk0 = vqtbl1q_u8(rk0, p4_inv);
+        rk1 = vqtbl1q_u8(rk1, p5_inv);
 
         uint8x16_t rc = vld1q_u8(&ROUND_CONSTANTS[16 * (i - 1)]);
-        s0            = veorq_u8(s0, rc);
+
+        s0 = veorq_u8(AES_DEC_LAST(s0, fk0), veorq_u8(rk0, rc));
+        s1 = veorq_u8(AES_DEC_LAST(s1, fk1), rk1);
 
         inv_mixing_layer_256(&s0, &s1);
 
         s0 = INV_MIX_COLUMNS(s0);
         s1 = INV_MIX_COLUMNS(s1);
 
-        s0 = AES_DEC(s0, fk0);
-        s1 = AES_DEC(s1, fk1);
+        s0 = AES_DEC(s0, zero);
+        s1 = AES_DEC(s1, zero);
     }
 
-    apply_permutation(VISTRUTAH_P4_INV, round_key, 16);
-    apply_permutation(VISTRUTAH_P5_INV, round_key + 16, 16);
-
-    rk0 = vld1q_u8(round_key);
-    rk1 = vld1q_u8(round_key + 16);
+    rk0 = vqtbl1q_u8(rk0, p4_inv);
+    rk1 = vqtbl1q_u8(rk1, p5_inv);
 
-    s0 = AES_DEC_LAST(s0, rk0);
-    s1 = AES_DEC_LAST(s1, rk1);
+    s0 = veorq_u8(AES_DEC_LAST(s0, fk0), rk0);
+    s1 = veorq_u8(AES_DEC_LAST(s1, fk1), rk1);
 
     vst1q_u8(plaintext, s0);
     vst1q_u8(plaintext + 16, s1);
 }
 
+#    ifdef VISTRUTAH_SVE2
+bool vistrutah_sve2_available(void);
+void vistrutah_256_encrypt_blocks_sve2(const uint8_t* plaintext, uint8_t* ciphertext,
+                                       size_t blocks, const uint8_t* key, int key_size,
+                                       int rounds);
+void vistrutah_256_decrypt_blocks_sve2(const uint8_t* ciphertext, uint8_t* plaintext,
+                                       size_t blocks, const uint8_t* key, int key_size,
+                                       int rounds);
+#    endif
+
+void
+vistrutah_256_encrypt_blocks(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+#    ifdef VISTRUTAH_SVE2
+    if (vistrutah_sve2_available()) {
+        vistrutah_256_encrypt_blocks_sve2(plaintext, ciphertext, blocks, key, key_size, rounds);
+        return;
+    }
+#    endif
+    for (size_t i = 0; i < blocks; i++) {
+        vistrutah_256_encrypt(plaintext + 32 * i, ciphertext + 32 * i, key, key_size, rounds);
+    }
+}
+
+void
+vistrutah_256_decrypt_blocks(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+#    ifdef VISTRUTAH_SVE2
+    if (vistrutah_sve2_available()) {
+        vistrutah_256_decrypt_blocks_sve2(ciphertext, plaintext, blocks, key, key_size, rounds);
+        return;
+    }
+#    endif
+    for (size_t i = 0; i < blocks; i++) {
+        vistrutah_256_decrypt(ciphertext + 32 * i, plaintext + 32 * i, key, key_size, rounds);
+    }
+}
+
 #endif
@@ -1,5 +1,8 @@
+#define VISTRUTAH_INTERNAL
 #include "vistrutah.h"
 
+#include <pthread.h>
+
 // Round constants for Vistrutah (48 blocks of 16 bytes each, 768 bytes total)
 // Derived from mathematical constants (digits of pi, etc.)
 const uint8_t ROUND_CONSTANTS[16 * 48] = {
@@ -68,3 +71,98 @@ const uint8_t VISTRUTAH_KEXP_SHUFFLE[32] = { 30, 29, 8, 23, 10, 9,  20, 3,  22,
 
 // Zero constant for AES rounds
 const uint8_t VISTRUTAH_ZERO[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+void
+vistrutah_xor_block(uint8_t* out, const uint8_t* a, const uint8_t* b)
+{
+    for (int i = 0; i < 64; i++) {
+        out[i] = a[i] ^ b[i];
+    }
+}
+
+// Big-endian: the bit shifted out of in[0] folds back as x^8 + x^5 + x^2 + 1
+void
+vistrutah_gf512_double(uint8_t* out, const uint8_t* in)
+{
+    uint8_t mask = (uint8_t) - (in[0] >> 7);
+
+    for (int i = 0; i < 63; i++) {
+        out[i] = (uint8_t) (in[i] << 1 | in[i + 1] >> 7);
+    }
+    out[63] = (uint8_t) (in[63] << 1);
+    out[62] ^= mask & 0x01;
+    out[63] ^= mask & 0x25;
+}
+
+// The compiler cannot see through a volatile function pointer, so it has
+// to assume the call is needed
+static void* (*const volatile secure_memset)(void*, int, size_t) = memset;
+
+void
+vistrutah_secure_zero(void* p, size_t len)
+{
+    secure_memset(p, 0, len);
+}
+
+#define PARALLEL_MAX_THREADS 64
+
+typedef struct {
+    vistrutah_range_fn fn;
+    void*              arg;
+    size_t             first;
+    size_t             count;
+} range_job;
+
+static void*
+range_worker(void* arg)
+{
+    range_job* job = arg;
+
+    job->fn(job->arg, job->first, job->count);
+    return NULL;
+}
+
+void
+vistrutah_parallel_for(size_t len, size_t unit, size_t min_units, int threads,
+                       vistrutah_range_fn fn, void* arg)
+{
+    size_t units = len / unit;
+
+    if (threads > PARALLEL_MAX_THREADS) {
+        threads = PARALLEL_MAX_THREADS;
+    }
+    if (threads > 1 && (size_t) threads > units / min_units) {
+        threads = (int) (units / min_units);
+    }
+    if (threads <= 1) {
+        fn(arg, 0, len);
+        return;
+    }
+
+    // Every share is a whole number of units, except that the calling
+    // thread's share, the first one, also takes the remainder. A worker that
+    // fails to start has its share done inline.
+    pthread_t tids[PARALLEL_MAX_THREADS];
+    range_job jobs[PARALLEL_MAX_THREADS];
+    bool      started[PARALLEL_MAX_THREADS];
+    size_t    share = unit * (units / threads);
+    size_t    pos   = 0;
+
+    for (int t = 0; t < threads; t++) {
+        jobs[t].fn    = fn;
+        jobs[t].arg   = arg;
+        jobs[t].first = pos;
+        jobs[t].count = t == 0 ? len - share * (threads - 1) : share;
+        started[t]    = t > 0 && pthread_create(&tids[t], NULL, range_worker, &jobs[t]) == 0;
+        pos += jobs[t].count;
+    }
+
+    range_worker(&jobs[0]);
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(tids[t], NULL);
+        } else {
+            range_worker(&jobs[t]);
+        }
+    }
+}
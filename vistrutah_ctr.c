@@ -0,0 +1,90 @@
+#define VISTRUTAH_INTERNAL
+#include "vistrutah.h"
+
+// Counter mode over Vistrutah-512. The counter block is the nonce followed
+// by the 64-bit block index, big-endian, so the keystream for any byte
+// offset is computed directly from offset / 64.
+
+#define CTR_BATCH 16
+
+int
+vistrutah_ctr_init(vistrutah_ctr_ctx* ctx, const uint8_t* key, int key_size, int rounds,
+                   const uint8_t* nonce)
+{
+    if (vistrutah_512_init(&ctx->cipher, key, key_size, rounds) != 0) {
+        return -1;
+    }
+    memcpy(ctx->nonce, nonce, VISTRUTAH_CTR_NONCE_BYTES);
+
+    return 0;
+}
+
+void
+vistrutah_ctr_xor(const vistrutah_ctr_ctx* ctx, uint64_t offset, const uint8_t* in, uint8_t* out,
+                  size_t len)
+{
+    const vistrutah_512_ctx* c = &ctx->cipher;
+    uint8_t                  ks[CTR_BATCH * 64];
+    uint64_t                 block = offset / 64;
+    size_t                   skip  = (size_t) (offset % 64);
+
+    VISTRUTAH_ENTER(t0, mode, CTR_XOR, len);
+
+    while (len > 0) {
+        size_t n = (skip + len + 63) / 64;
+
+        if (n > CTR_BATCH) {
+            n = CTR_BATCH;
+        }
+        for (size_t j = 0; j < n; j++) {
+            uint8_t* b = ks + 64 * j;
+
+            memcpy(b, ctx->nonce, VISTRUTAH_CTR_NONCE_BYTES);
+            for (int k = 0; k < 8; k++) {
+                b[63 - k] = (uint8_t) ((block + j) >> (8 * k));
+            }
+        }
+        vistrutah_512_encrypt_blocks(ks, ks, n, c->key, c->key_size, c->rounds);
+
+        size_t take = 64 * n - skip;
+
+        if (take > len) {
+            take = len;
+        }
+        for (size_t j = 0; j < take; j++) {
+            out[j] = in[j] ^ ks[skip + j];
+        }
+        block += n;
+        skip = 0;
+        in += take;
+        out += take;
+        len -= take;
+    }
+    VISTRUTAH_LEAVE(t0, mode, CTR_XOR);
+}
+
+// Multi-threaded interface
+
+typedef struct {
+    const vistrutah_ctr_ctx* ctx;
+    uint64_t                 offset;
+    const uint8_t*           in;
+    uint8_t*                 out;
+} ctr_range;
+
+static void
+ctr_share(void* arg, size_t first, size_t len)
+{
+    ctr_range* r = arg;
+
+    vistrutah_ctr_xor(r->ctx, r->offset + first, r->in + first, r->out + first, len);
+}
+
+void
+vistrutah_ctr_xor_parallel(const vistrutah_ctr_ctx* ctx, uint64_t offset, const uint8_t* in,
+                           uint8_t* out, size_t len, int threads)
+{
+    ctr_range r = { ctx, offset, in, out };
+
+    vistrutah_parallel_for(len, 64, CTR_BATCH, threads, ctr_share, &r);
+}
@@ -0,0 +1,143 @@
+#define VISTRUTAH_INTERNAL
+#include "vistrutah.h"
+
+// Farfalle over fixed-key Vistrutah-512 (the key of vistrutah_512_permute()):
+//
+//   k   = p_b(K || 0x01 || 0*)
+//   acc = sum_i p_c(b_i ^ k * x^i)        over the padded blocks of all strings
+//   y   = p_d(acc)
+//   z_j = p_e(roll_e^j(y)) ^ k * x^n      n = number of mask indices used
+//
+// Multiplication by x is in GF(2^512) modulo x^512 + x^8 + x^5 + x^2 + 1, so
+// the input masks form a linear rolling sequence; roll_e is a nonlinear
+// feedback shift over the eight 64-bit words of the state. Every string is
+// padded with 0x01 || 0* and followed by one unused mask index, which keeps
+// string boundaries unambiguous. p_c and p_e are the short variant, p_b and
+// p_d the long one, all run through vistrutah_512_encrypt_blocks().
+
+#define DECK_ROUNDS_INNER VISTRUTAH_512_ROUNDS_SHORT_512KEY
+#define DECK_ROUNDS_OUTER VISTRUTAH_512_ROUNDS_LONG_512KEY
+#define DECK_BATCH        8
+
+static inline uint64_t
+rotl64(uint64_t x, int n)
+{
+    return x << n | x >> (64 - n);
+}
+
+static void
+roll_e(uint8_t* state)
+{
+    uint64_t w[8];
+
+    memcpy(w, state, 64);
+
+    uint64_t next = rotl64(w[0], 7) ^ rotl64(w[1], 18) ^ (w[2] & (w[1] >> 1));
+
+    memmove(w, w + 1, 7 * sizeof w[0]);
+    w[7] = next;
+    memcpy(state, w, 64);
+}
+
+static inline void
+permute_blocks(uint8_t* blocks, size_t n, int rounds)
+{
+    vistrutah_512_encrypt_blocks(blocks, blocks, n, VISTRUTAH_PERMUTATION_KEY, 64, rounds);
+}
+
+int
+vistrutah_deck_init(vistrutah_deck_ctx* ctx, const uint8_t* key, size_t key_len)
+{
+    if (key_len == 0 || key_len >= 64) {
+        return -1;
+    }
+    memset(ctx, 0, sizeof *ctx);
+    memcpy(ctx->key_mask, key, key_len);
+    ctx->key_mask[key_len] = 0x01;
+    permute_blocks(ctx->key_mask, 1, DECK_ROUNDS_OUTER);
+    memcpy(ctx->mask, ctx->key_mask, 64);
+    VISTRUTAH_PROBE(key_init, DECK, key_len);
+
+    return 0;
+}
+
+void
+vistrutah_deck_absorb(vistrutah_deck_ctx* ctx, const uint8_t* in, size_t len)
+{
+    uint8_t buf[DECK_BATCH * 64];
+    size_t  blocks = len / 64 + 1;
+
+    VISTRUTAH_ENTER(t0, mode, DECK_ABSORB, len);
+
+    for (size_t i = 0; i < blocks;) {
+        size_t n = blocks - i < DECK_BATCH ? blocks - i : DECK_BATCH;
+
+        for (size_t j = 0; j < n; j++) {
+            uint8_t* b = buf + 64 * j;
+
+            if (i + j < blocks - 1) {
+                memcpy(b, in + 64 * (i + j), 64);
+            } else {
+                size_t rem = len % 64;
+
+                memset(b, 0, 64);
+                memcpy(b, in + 64 * (i + j), rem);
+                b[rem] = 0x01;
+            }
+            vistrutah_xor_block(b, b, ctx->mask);
+            vistrutah_gf512_double(ctx->mask, ctx->mask);
+        }
+        permute_blocks(buf, n, DECK_ROUNDS_INNER);
+        for (size_t j = 0; j < n; j++) {
+            vistrutah_xor_block(ctx->acc, ctx->acc, buf + 64 * j);
+        }
+        i += n;
+    }
+
+    // String separator
+    vistrutah_gf512_double(ctx->mask, ctx->mask);
+    VISTRUTAH_LEAVE(t0, mode, DECK_ABSORB);
+}
+
+void
+vistrutah_deck_squeeze(const vistrutah_deck_ctx* ctx, uint64_t offset, uint8_t* out,
+                       size_t len)
+{
+    uint8_t  y[64];
+    uint8_t  buf[DECK_BATCH * 64];
+    uint64_t first = offset / 64;
+    size_t   skip  = (size_t) (offset % 64);
+
+    VISTRUTAH_ENTER(t0, mode, DECK_SQUEEZE, len);
+
+    memcpy(y, ctx->acc, 64);
+    permute_blocks(y, 1, DECK_ROUNDS_OUTER);
+    for (uint64_t j = 0; j < first; j++) {
+        roll_e(y);
+    }
+
+    while (len > 0) {
+        size_t n = (skip + len + 63) / 64;
+
+        if (n > DECK_BATCH) {
+            n = DECK_BATCH;
+        }
+        for (size_t j = 0; j < n; j++) {
+            memcpy(buf + 64 * j, y, 64);
+            roll_e(y);
+        }
+        permute_blocks(buf, n, DECK_ROUNDS_INNER);
+        for (size_t j = 0; j < n; j++) {
+            vistrutah_xor_block(buf + 64 * j, buf + 64 * j, ctx->mask);
+        }
+
+        size_t avail = 64 * n - skip;
+        size_t take  = avail < len ? avail : len;
+
+        memcpy(out, buf + skip, take);
+        skip = 0;
+        out += take;
+        len -= take;
+    }
+    VISTRUTAH_LEAVE(t0, mode, DECK_SQUEEZE);
+}
@@ -0,0 +1,454 @@
+#include "vistrutah.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+extern const uint8_t ROUND_CONSTANTS[16 * 48];
+
+// Compression function (Shrimpton-Stam with fixed-key MMO components):
+//
+//   f_i(z)  = E_Ki(z) ^ z
+//   F(x, y) = f_3(f_1(x) ^ f_2(y)) ^ f_1(x)
+//
+// Davies-Meyer keyed by the message block would need a different key for
+// every block of every chunk; with fixed keys, the same f_i is applied to
+// many independent inputs, which is what the multi-block kernels are for.
+//
+// Mode (BLAKE3-like): a chunk is hashed as a chain cv = F(cv ^ T, m_j)
+// starting from zero, where T carries the chunk index, the number of bytes
+// in m_j and the CHUNK_START/CHUNK_END flags. Chunk values are combined as
+// parent = F(left ^ T, right) in a left-complete binary tree, and the final
+// compression carries the ROOT flag.
+
+#define HASH_ROUNDS  VISTRUTAH_512_ROUNDS_LONG_256KEY
+#define HASH_KEY_1   (ROUND_CONSTANTS + 16 * 42)
+#define HASH_KEY_2   (ROUND_CONSTANTS + 16 * 44)
+#define HASH_KEY_3   (ROUND_CONSTANTS + 16 * 46)
+#define HASH_BATCH   16
+#define CHUNK_BLOCKS (VISTRUTAH_HASH_CHUNK_BYTES / 64)
+#define CHUNK_LANES  8
+#define MAX_THREADS  64
+
+#define CHUNK_START 0x01
+#define CHUNK_END   0x02
+#define PARENT      0x04
+#define ROOT        0x08
+
+static void
+mmo_blocks(uint8_t* out, const uint8_t* in, size_t n, const uint8_t* key)
+{
+    vistrutah_512_encrypt_blocks(in, out, n, key, 32, HASH_ROUNDS);
+    for (size_t i = 0; i < 64 * n; i++) {
+        out[i] ^= in[i];
+    }
+}
+
+// n <= HASH_BATCH compressions; out may alias x or y
+static void
+compress_blocks(uint8_t* out, const uint8_t* x, const uint8_t* y, size_t n)
+{
+    uint8_t u[HASH_BATCH * 64];
+    uint8_t v[HASH_BATCH * 64];
+    uint8_t w[HASH_BATCH * 64];
+
+    mmo_blocks(u, x, n, HASH_KEY_1);
+    mmo_blocks(v, y, n, HASH_KEY_2);
+    for (size_t i = 0; i < 64 * n; i++) {
+        v[i] ^= u[i];
+    }
+    mmo_blocks(w, v, n, HASH_KEY_3);
+    for (size_t i = 0; i < 64 * n; i++) {
+        out[i] = w[i] ^ u[i];
+    }
+}
+
+void
+vistrutah_512_compress(uint8_t* out, const uint8_t* cv, const uint8_t* block)
+{
+    compress_blocks(out, cv, block, 1);
+}
+
+static void
+add_tweak(uint8_t* x, uint64_t counter, size_t block_len, unsigned flags)
+{
+    for (int i = 0; i < 8; i++) {
+        x[i] ^= (uint8_t) (counter >> (8 * i));
+    }
+    x[8] ^= (uint8_t) block_len;
+    x[9] ^= (uint8_t) flags;
+}
+
+static void
+parent_cv(uint8_t* out, const uint8_t* left, const uint8_t* right, unsigned flags)
+{
+    uint8_t x[64];
+
+    memcpy(x, left, 64);
+    add_tweak(x, 0, 64, PARENT | flags);
+    compress_blocks(out, x, right, 1);
+}
+
+// Full chunks that are never the root, CHUNK_LANES of them in lockstep
+static void
+hash_full_chunks(const uint8_t* in, size_t n, uint64_t counter, uint8_t* cvs)
+{
+    uint8_t x[CHUNK_LANES * 64];
+    uint8_t y[CHUNK_LANES * 64];
+
+    while (n > 0) {
+        size_t lanes = n < CHUNK_LANES ? n : CHUNK_LANES;
+
+        memset(cvs, 0, 64 * lanes);
+        for (int j = 0; j < CHUNK_BLOCKS; j++) {
+            unsigned flags = (j == 0 ? CHUNK_START : 0) | (j == CHUNK_BLOCKS - 1 ? CHUNK_END : 0);
+
+            for (size_t k = 0; k < lanes; k++) {
+                memcpy(x + 64 * k, cvs + 64 * k, 64);
+                add_tweak(x + 64 * k, counter + k, 64, flags);
+                memcpy(y + 64 * k, in + VISTRUTAH_HASH_CHUNK_BYTES * k + 64 * j, 64);
+            }
+            compress_blocks(cvs, x, y, lanes);
+        }
+        in += VISTRUTAH_HASH_CHUNK_BYTES * lanes;
+        cvs += 64 * lanes;
+        counter += lanes;
+        n -= lanes;
+    }
+}
+
+// Incremental interface
+
+static void
+chunk_compress(vistrutah_hash_state* st, unsigned flags)
+{
+    uint8_t x[64];
+    uint8_t y[64] = { 0 };
+
+    if (st->chunk_len == st->buf_len) {
+        flags |= CHUNK_START;
+    }
+    memcpy(x, st->chunk_cv, 64);
+    add_tweak(x, st->chunk_counter, st->buf_len, flags);
+    memcpy(y, st->buf, st->buf_len);
+    compress_blocks(st->chunk_cv, x, y, 1);
+}
+
+static void
+chunk_reset(vistrutah_hash_state* st)
+{
+    memset(st->chunk_cv, 0, 64);
+    st->chunk_len = 0;
+    st->buf_len   = 0;
+}
+
+static void
+push_chunk_cv(vistrutah_hash_state* st, uint8_t* cv)
+{
+    uint64_t total = ++st->chunk_counter;
+
+    // Merge every subtree completed by this chunk. More input follows, so
+    // none of these parents can be the root.
+    while ((total & 1) == 0) {
+        st->stack_len--;
+        parent_cv(cv, st->cv_stack[st->stack_len], cv, 0);
+        total >>= 1;
+    }
+    memcpy(st->cv_stack[st->stack_len++], cv, 64);
+}
+
+void
+vistrutah_hash_init(vistrutah_hash_state* st)
+{
+    memset(st, 0, sizeof *st);
+}
+
+void
+vistrutah_hash_update(vistrutah_hash_state* st, const uint8_t* in, size_t len)
+{
+    VISTRUTAH_ENTER(t0, mode, HASH_UPDATE, len);
+
+    while (len > 0) {
+        if (st->chunk_len == VISTRUTAH_HASH_CHUNK_BYTES) {
+            uint8_t cv[64];
+
+            chunk_compress(st, CHUNK_END);
+            memcpy(cv, st->chunk_cv, 64);
+            push_chunk_cv(st, cv);
+            chunk_reset(st);
+        }
+        if (st->chunk_len == 0 && len > VISTRUTAH_HASH_CHUNK_BYTES) {
+            uint8_t cvs[CHUNK_LANES * 64];
+            size_t  n = (len - 1) / VISTRUTAH_HASH_CHUNK_BYTES;
+
+            if (n > CHUNK_LANES) {
+                n = CHUNK_LANES;
+            }
+            hash_full_chunks(in, n, st->chunk_counter, cvs);
+            for (size_t k = 0; k < n; k++) {
+                push_chunk_cv(st, cvs + 64 * k);
+            }
+            in += VISTRUTAH_HASH_CHUNK_BYTES * n;
+            len -= VISTRUTAH_HASH_CHUNK_BYTES * n;
+            continue;
+        }
+        if (st->buf_len == 64) {
+            chunk_compress(st, 0);
+            st->buf_len = 0;
+        }
+
+        size_t n = 64 - st->buf_len;
+
+        if (n > len) {
+            n = len;
+        }
+        memcpy(st->buf + st->buf_len, in, n);
+        st->buf_len += n;
+        st->chunk_len += n;
+        in += n;
+        len -= n;
+    }
+    VISTRUTAH_LEAVE(t0, mode, HASH_UPDATE);
+}
+
+void
+vistrutah_hash_final(vistrutah_hash_state* st, uint8_t* out)
+{
+    uint8_t cv[64];
+
+    VISTRUTAH_ENTER(t0, mode, HASH_FINAL, st->buf_len);
+
+    if (st->stack_len == 0) {
+        chunk_compress(st, CHUNK_END | ROOT);
+        memcpy(out, st->chunk_cv, 64);
+        VISTRUTAH_LEAVE(t0, mode, HASH_FINAL);
+        return;
+    }
+    chunk_compress(st, CHUNK_END);
+    memcpy(cv, st->chunk_cv, 64);
+    while (st->stack_len > 1) {
+        st->stack_len--;
+        parent_cv(cv, st->cv_stack[st->stack_len], cv, 0);
+    }
+    parent_cv(out, st->cv_stack[0], cv, ROOT);
+    st->stack_len = 0;
+    VISTRUTAH_LEAVE(t0, mode, HASH_FINAL);
+}
+
+void
+vistrutah_hash(const uint8_t* in, size_t len, uint8_t* out)
+{
+    vistrutah_hash_state st;
+
+    VISTRUTAH_ENTER(t0, mode, HASH, len);
+    vistrutah_hash_init(&st);
+    vistrutah_hash_update(&st, in, len);
+    vistrutah_hash_final(&st, out);
+    VISTRUTAH_LEAVE(t0, mode, HASH);
+}
+
+// Multi-threaded one-shot interface
+
+typedef struct {
+    const uint8_t* in;
+    size_t         n;
+    uint64_t       counter;
+    uint8_t*       cvs;
+} chunk_job;
+
+static void*
+chunk_worker(void* arg)
+{
+    chunk_job* job = arg;
+
+    VISTRUTAH_ENTER(t0, mode, HASH, VISTRUTAH_HASH_CHUNK_BYTES * job->n);
+    hash_full_chunks(job->in, job->n, job->counter, job->cvs);
+    VISTRUTAH_LEAVE(t0, mode, HASH);
+    return NULL;
+}
+
+int
+vistrutah_hash_parallel(const uint8_t* in, size_t len, uint8_t* out, int threads)
+{
+    size_t chunks = (len + VISTRUTAH_HASH_CHUNK_BYTES - 1) / VISTRUTAH_HASH_CHUNK_BYTES;
+    size_t full   = chunks > 0 ? chunks - 1 : 0;
+
+    if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+    if (threads > 1 && (size_t) threads > full) {
+        threads = (int) full;
+    }
+    if (threads <= 1) {
+        vistrutah_hash(in, len, out);
+        return 0;
+    }
+
+    uint8_t* cvs = malloc(64 * chunks);
+
+    if (cvs == NULL) {
+        return -1;
+    }
+
+    // Each worker records its share; this thread records the rest
+    VISTRUTAH_ENTER(t0, mode, HASH, len - VISTRUTAH_HASH_CHUNK_BYTES * full);
+
+    // All chunks but the last are full; the last one is hashed here while
+    // the workers run
+    pthread_t tids[MAX_THREADS];
+    chunk_job jobs[MAX_THREADS];
+    bool      started[MAX_THREADS];
+    size_t    first = 0;
+
+    for (int t = 0; t < threads; t++) {
+        size_t n = full / threads + ((size_t) t < full % threads);
+
+        jobs[t].in      = in + VISTRUTAH_HASH_CHUNK_BYTES * first;
+        jobs[t].n       = n;
+        jobs[t].counter = first;
+        jobs[t].cvs     = cvs + 64 * first;
+        started[t]      = pthread_create(&tids[t], NULL, chunk_worker, &jobs[t]) == 0;
+        first += n;
+    }
+
+    vistrutah_hash_state st;
+
+    vistrutah_hash_init(&st);
+    st.chunk_counter = full;
+    vistrutah_hash_update(&st, in + VISTRUTAH_HASH_CHUNK_BYTES * full,
+                          len - VISTRUTAH_HASH_CHUNK_BYTES * full);
+    chunk_compress(&st, CHUNK_END);
+    memcpy(cvs + 64 * full, st.chunk_cv, 64);
+
+    for (int t = 0; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(tids[t], NULL);
+        } else {
+            chunk_worker(&jobs[t]);
+        }
+    }
+
+    // Pairing level by level, promoting an odd node, gives the same
+    // left-complete tree as the incremental stack
+    uint8_t x[HASH_BATCH * 64];
+    uint8_t y[HASH_BATCH * 64];
+    size_t  count = chunks;
+
+    while (count > 2) {
+        size_t pairs = count / 2;
+
+        for (size_t i = 0; i < pairs; i += HASH_BATCH) {
+            size_t n = pairs - i < HASH_BATCH ? pairs - i : HASH_BATCH;
+
+            for (size_t k = 0; k < n; k++) {
+                memcpy(x + 64 * k, cvs + 64 * (2 * (i + k)), 64);
+                memcpy(y + 64 * k, cvs + 64 * (2 * (i + k) + 1), 64);
+                add_tweak(x + 64 * k, 0, 64, PARENT);
+            }
+            compress_blocks(cvs + 64 * i, x, y, n);
+        }
+        if (count & 1) {
+            memcpy(cvs + 64 * pairs, cvs + 64 * (count - 1), 64);
+        }
+        count = pairs + (count & 1);
+    }
+    parent_cv(out, cvs, cvs + 64, ROOT);
+    VISTRUTAH_LEAVE(t0, mode, HASH);
+
+    free(cvs);
+    return 0;
+}
+
+// Multi-buffer interface: single-chunk messages are hashed HASH_BATCH at a
+// time, one block of each per step
+
+static void
+hash_short_messages(const uint8_t* const* in, const size_t* lens, size_t count, uint8_t* out)
+{
+    uint8_t x[HASH_BATCH * 64];
+    uint8_t y[HASH_BATCH * 64];
+    uint8_t cv[HASH_BATCH * 64];
+    size_t  lane[HASH_BATCH];
+    size_t  max_blocks = 1;
+
+    memset(out, 0, 64 * count);
+    for (size_t k = 0; k < count; k++) {
+        size_t blocks = (lens[k] + 63) / 64;
+
+        if (blocks > max_blocks) {
+            max_blocks = blocks;
+        }
+    }
+
+    for (size_t j = 0; j < max_blocks; j++) {
+        size_t n = 0;
+
+        for (size_t k = 0; k < count; k++) {
+            size_t blocks = lens[k] > 0 ? (lens[k] + 63) / 64 : 1;
+
+            if (j >= blocks) {
+                continue;
+            }
+
+            size_t   block_len = lens[k] - 64 * j < 64 ? lens[k] - 64 * j : 64;
+            unsigned flags =
+                (j == 0 ? CHUNK_START : 0) | (j == blocks - 1 ? CHUNK_END | ROOT : 0);
+
+            memcpy(x + 64 * n, out + 64 * k, 64);
+            add_tweak(x + 64 * n, 0, block_len, flags);
+            memset(y + 64 * n, 0, 64);
+            memcpy(y + 64 * n, in[k] + 64 * j, block_len);
+            lane[n++] = k;
+        }
+        compress_blocks(cv, x, y, n);
+        for (size_t i = 0; i < n; i++) {
+            memcpy(out + 64 * lane[i], cv + 64 * i, 64);
+        }
+    }
+}
+
+static inline size_t
+total_length(const size_t* lens, size_t count)
+{
+    size_t total = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        total += lens[i];
+    }
+    return total;
+}
+
+void
+vistrutah_hash_many(const uint8_t* const* in, const size_t* lens, size_t count, uint8_t* out)
+{
+    const uint8_t* group_in[HASH_BATCH];
+    size_t         group_len[HASH_BATCH];
+    size_t         group_index[HASH_BATCH];
+    uint8_t        group_out[HASH_BATCH * 64];
+    size_t         n = 0;
+
+    VISTRUTAH_ENTER(t0, mode, HASH_MANY, total_length(lens, count));
+
+    for (size_t i = 0; i < count; i++) {
+        if (lens[i] > VISTRUTAH_HASH_CHUNK_BYTES) {
+            vistrutah_hash(in[i], lens[i], out + 64 * i);
+            continue;
+        }
+        group_in[n]    = in[i];
+        group_len[n]   = lens[i];
+        group_index[n] = i;
+        if (++n == HASH_BATCH) {
+            hash_short_messages(group_in, group_len, n, group_out);
+            for (size_t k = 0; k < n; k++) {
+                memcpy(out + 64 * group_index[k], group_out + 64 * k, 64);
+            }
+            n = 0;
+        }
+    }
+    if (n > 0) {
+        hash_short_messages(group_in, group_len, n, group_out);
+        for (size_t k = 0; k < n; k++) {
+            memcpy(out + 64 * group_index[k], group_out + 64 * k, 64);
+        }
+    }
+    VISTRUTAH_LEAVE(t0, mode, HASH_MANY);
+}
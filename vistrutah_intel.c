@@ -1,3 +1,5 @@
+#define VISTRUTAH_BACKEND
+
 #include "vistrutah.h"
 
 #ifdef VISTRUTAH_INTEL
@@ -24,10 +26,16 @@ vistrutah_has_aes_accel(void)
     return false;
 }
 
+#    ifdef VISTRUTAH_512_VAES256
+const char* const vistrutah_impl_name = "Intel SSE+AES-NI, AVX2+VAES (Vistrutah-512)";
+#    else
+const char* const vistrutah_impl_name = "Intel SSE+AES-NI";
+#    endif
+
 const char*
 vistrutah_get_impl_name(void)
 {
-    return "Intel SSE+AES-NI";
+    return vistrutah_impl_name;
 }
 
 static inline __m128i
@@ -171,56 +179,49 @@ void
 vistrutah_256_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key,
                       int key_size, int rounds)
 {
-    uint8_t fixed_key[32];
-    uint8_t round_key[32];
-    int     steps = rounds / ROUNDS_PER_STEP;
+    int steps = rounds / ROUNDS_PER_STEP;
 
     __m128i s0 = _mm_loadu_si128((const __m128i*) ciphertext);
     __m128i s1 = _mm_loadu_si128((const __m128i*) (ciphertext + 16));
 
-    if (key_size == 16) {
-        __m128i k = _mm_loadu_si128((const __m128i*) key);
-        _mm_storeu_si128((__m128i*) fixed_key, k);
-        _mm_storeu_si128((__m128i*) (fixed_key + 16), k);
-    } else {
-        memcpy(fixed_key, key, 32);
-    }
-
-    memcpy(round_key, fixed_key + 16, 16);
-    memcpy(round_key + 16, fixed_key, 16);
+    __m128i fk0 = _mm_loadu_si128((const __m128i*) key);
+    __m128i fk1 = key_size == 16 ? fk0 : _mm_loadu_si128((const __m128i*) (key + 16));
+    __m128i rk0 = fk1;
+    __m128i rk1 = fk0;
+    __m128i p4  = _mm_loadu_si128((const __m128i*) VISTRUTAH_P4);
+    __m128i p5  = _mm_loadu_si128((const __m128i*) VISTRUTAH_P5);
 
+    // The key schedule stays in registers: it is run forward to the last
+    // round key, then backwards with the inverse permutations.
     for (int i = 0; i < steps; i++) {
-        apply_permutation(VISTRUTAH_P4, round_key, 16);
-        apply_permutation(VISTRUTAH_P5, round_key + 16, 16);
+        rk0 = _mm_shuffle_epi8(rk0, p4);
+        rk1 = _mm_shuffle_epi8(rk1, p5);
     }
 
-    __m128i fk0 = _mm_loadu_si128((const __m128i*) fixed_key);
-    __m128i fk1 = _mm_loadu_si128((const __m128i*) (fixed_key + 16));
+    __m128i p4_inv = _mm_loadu_si128((const __m128i*) VISTRUTAH_P4_INV);
+    __m128i p5_inv = _mm_loadu_si128((const __m128i*) VISTRUTAH_P5_INV);
 
     __m128i fk0_imc = _mm_aesimc_si128(fk0);
     __m128i fk1_imc = _mm_aesimc_si128(fk1);
 
-    __m128i rk0 = _mm_loadu_si128((const __m128i*) round_key);
-    __m128i rk1 = _mm_loadu_si128((const __m128i*) (round_key + 16));
-
     s0 = _mm_xor_si128(s0, rk0);
     s1 = _mm_xor_si128(s1, rk1);
     s0 = aes_inv_round(s0, fk0_imc);
     s1 = aes_inv_round(s1, fk1_imc);
 
     for (int i = steps - 1; i >= 1; i--) {
-        apply_permutation(VISTRUTAH_P4_INV, round_key, 16);
-        apply_permutation(VISTRUTAH_P5_INV, round_key + 16, 16);
+        rk0 = _mm_shuffle_epi8(rk0, p4_inv);
+        rk1 = _mm_shuffle_epi8(rk1, p5_inv);
 
-        rk0 = _mm_loadu_si128((const __m128i*) round_key);
-        rk1 = _mm_loadu_si128((const __m128i*) (round_key + 16));
+        // The round constant is added by AESDECLAST together with the round
+        // key. InvMixColumns of the state cannot be moved into the keys: the
+        // mixing layer moves bytes across columns, so it does not commute
+        // with AESIMC.
+        __m128i rc = _mm_loadu_si128((const __m128i*) &ROUND_CONSTANTS[16 * (i - 1)]);
 
-        s0 = aes_inv_final_round(s0, rk0);
+        s0 = aes_inv_final_round(s0, _mm_xor_si128(rk0, rc));
         s1 = aes_inv_final_round(s1, rk1);
 
-        __m128i rc = _mm_loadu_si128((const __m128i*) &ROUND_CONSTANTS[16 * (i - 1)]);
-        s0         = _mm_xor_si128(s0, rc);
-
         inv_mixing_layer_256(&s0, &s1);
 
         s0 = _mm_aesimc_si128(s0);
@@ -230,11 +231,8 @@ vistrutah_256_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8
         s1 = aes_inv_round(s1, fk1_imc);
     }
 
-    apply_permutation(VISTRUTAH_P4_INV, round_key, 16);
-    apply_permutation(VISTRUTAH_P5_INV, round_key + 16, 16);
-
-    rk0 = _mm_loadu_si128((const __m128i*) round_key);
-    rk1 = _mm_loadu_si128((const __m128i*) (round_key + 16));
+    rk0 = _mm_shuffle_epi8(rk0, p4_inv);
+    rk1 = _mm_shuffle_epi8(rk1, p5_inv);
 
     s0 = aes_inv_final_round(s0, rk0);
     s1 = aes_inv_final_round(s1, rk1);
@@ -243,4 +241,22 @@ vistrutah_256_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8
     _mm_storeu_si128((__m128i*) (plaintext + 16), s1);
 }
 
+void
+vistrutah_256_encrypt_blocks(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    for (size_t i = 0; i < blocks; i++) {
+        vistrutah_256_encrypt(plaintext + 32 * i, ciphertext + 32 * i, key, key_size, rounds);
+    }
+}
+
+void
+vistrutah_256_decrypt_blocks(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    for (size_t i = 0; i < blocks; i++) {
+        vistrutah_256_decrypt(ciphertext + 32 * i, plaintext + 32 * i, key, key_size, rounds);
+    }
+}
+
 #endif
@@ -0,0 +1,105 @@
+#define VISTRUTAH_INTERNAL
+#include "vistrutah.h"
+
+// Vistrutah-512 as a PRF: derived key i is the leading key_bytes of
+// E_master(label || label_len || key_bytes || counter_i), with the counter
+// big-endian in the last 8 bytes. The output length is part of the input,
+// so a 256-bit key is never a prefix of the 512-bit key for the same counter.
+
+#define KDF_BATCH 16
+
+int
+vistrutah_kdf_init(vistrutah_kdf_ctx* ctx, const uint8_t* master_key, int key_size, int rounds,
+                   const uint8_t* label, size_t label_len)
+{
+    if ((key_size != 32 && key_size != 64) || label_len > VISTRUTAH_KDF_MAX_LABEL) {
+        return -1;
+    }
+    memset(ctx, 0, sizeof *ctx);
+    memcpy(ctx->key, master_key, key_size);
+    ctx->key_size = key_size;
+    ctx->rounds   = rounds;
+    if (label_len > 0) {
+        memcpy(ctx->block, label, label_len);
+    }
+    ctx->block[VISTRUTAH_KDF_MAX_LABEL] = (uint8_t) label_len;
+    VISTRUTAH_PROBE(key_init, KDF, key_size);
+
+    return 0;
+}
+
+static void
+derive_range(const vistrutah_kdf_ctx* ctx, const uint64_t* counters, size_t n, uint8_t* out,
+             size_t key_bytes)
+{
+    uint8_t buf[KDF_BATCH * 64];
+
+    VISTRUTAH_ENTER(t0, mode, KDF_DERIVE, key_bytes * n);
+
+    for (size_t i = 0; i < n;) {
+        size_t   batch = n - i < KDF_BATCH ? n - i : KDF_BATCH;
+        uint8_t* dst   = key_bytes == 64 ? out + 64 * i : buf;
+
+        for (size_t j = 0; j < batch; j++) {
+            uint8_t* b = dst + 64 * j;
+            uint64_t c = counters[i + j];
+
+            memcpy(b, ctx->block, 56);
+            b[55] = (uint8_t) key_bytes;
+            for (int k = 0; k < 8; k++) {
+                b[63 - k] = (uint8_t) (c >> (8 * k));
+            }
+        }
+        vistrutah_512_encrypt_blocks(dst, dst, batch, ctx->key, ctx->key_size, ctx->rounds);
+        if (key_bytes != 64) {
+            for (size_t j = 0; j < batch; j++) {
+                memcpy(out + key_bytes * (i + j), buf + 64 * j, key_bytes);
+            }
+        }
+        i += batch;
+    }
+    VISTRUTAH_LEAVE(t0, mode, KDF_DERIVE);
+}
+
+int
+vistrutah_kdf_derive(const vistrutah_kdf_ctx* ctx, const uint64_t* counters, size_t n,
+                     uint8_t* out, size_t key_bytes)
+{
+    if (key_bytes != 32 && key_bytes != 64) {
+        return -1;
+    }
+    derive_range(ctx, counters, n, out, key_bytes);
+
+    return 0;
+}
+
+// Multi-threaded interface
+
+typedef struct {
+    const vistrutah_kdf_ctx* ctx;
+    const uint64_t*          counters;
+    uint8_t*                 out;
+    size_t                   key_bytes;
+} kdf_range;
+
+static void
+kdf_share(void* arg, size_t first, size_t n)
+{
+    kdf_range* r = arg;
+
+    derive_range(r->ctx, r->counters + first, n, r->out + r->key_bytes * first, r->key_bytes);
+}
+
+int
+vistrutah_kdf_derive_parallel(const vistrutah_kdf_ctx* ctx, const uint64_t* counters, size_t n,
+                              uint8_t* out, size_t key_bytes, int threads)
+{
+    kdf_range r = { ctx, counters, out, key_bytes };
+
+    if (key_bytes != 32 && key_bytes != 64) {
+        return -1;
+    }
+    vistrutah_parallel_for(n, 1, KDF_BATCH, threads, kdf_share, &r);
+
+    return 0;
+}
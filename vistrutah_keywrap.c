@@ -0,0 +1,92 @@
+#define VISTRUTAH_INTERNAL
+#include "vistrutah.h"
+
+// Wrapping a 256-bit key is a single Vistrutah-512 encryption of
+// ICV || key, where ICV is 32 bytes of 0xA6 (the default IV of RFC 3394).
+// Since every bit of the wide block depends on every bit of the input, a
+// modified wrapped key decrypts to a random header, which the check rejects
+// with probability 1 - 2^-256.
+
+#define KEYWRAP_BATCH 16
+#define KEYWRAP_ICV   0xa6
+
+int
+vistrutah_keywrap_init(vistrutah_keywrap_ctx* ctx, const uint8_t* kek, int key_size, int rounds)
+{
+    if (key_size != VISTRUTAH_KEY_SIZE_256 && key_size != VISTRUTAH_KEY_SIZE_512) {
+        return -1;
+    }
+    memset(ctx, 0, sizeof *ctx);
+    memcpy(ctx->kek, kek, key_size);
+    ctx->key_size = key_size;
+    ctx->rounds   = rounds;
+    VISTRUTAH_PROBE(key_init, KEYWRAP, key_size);
+
+    return 0;
+}
+
+void
+vistrutah_keywrap_wrap(const vistrutah_keywrap_ctx* ctx, const uint8_t* keys, uint8_t* wrapped,
+                       size_t n)
+{
+    uint8_t buf[KEYWRAP_BATCH * 64];
+
+    VISTRUTAH_ENTER(t0, mode, KEYWRAP_WRAP, 64 * n);
+
+    for (size_t i = 0; i < n;) {
+        size_t batch = n - i < KEYWRAP_BATCH ? n - i : KEYWRAP_BATCH;
+
+        for (size_t j = 0; j < batch; j++) {
+            memset(buf + 64 * j, KEYWRAP_ICV, 32);
+            memcpy(buf + 64 * j + 32, keys + 32 * (i + j), 32);
+        }
+        vistrutah_512_encrypt_blocks(buf, wrapped + 64 * i, batch, ctx->kek, ctx->key_size,
+                                     ctx->rounds);
+        i += batch;
+    }
+    vistrutah_secure_zero(buf, sizeof buf);
+    VISTRUTAH_LEAVE(t0, mode, KEYWRAP_WRAP);
+}
+
+int
+vistrutah_keywrap_unwrap(const vistrutah_keywrap_ctx* ctx, const uint8_t* wrapped, uint8_t* keys,
+                         size_t n, uint8_t* valid)
+{
+    uint8_t buf[KEYWRAP_BATCH * 64];
+    uint8_t all_ok = 1;
+
+    VISTRUTAH_ENTER(t0, mode, KEYWRAP_UNWRAP, 64 * n);
+
+    for (size_t i = 0; i < n;) {
+        size_t batch = n - i < KEYWRAP_BATCH ? n - i : KEYWRAP_BATCH;
+
+        vistrutah_512_decrypt_blocks(wrapped + 64 * i, buf, batch, ctx->kek, ctx->key_size,
+                                     ctx->rounds);
+        for (size_t j = 0; j < batch; j++) {
+            const uint8_t* b = buf + 64 * j;
+            uint8_t*       k = keys + 32 * (i + j);
+            unsigned       d = 0;
+
+            for (int t = 0; t < 32; t++) {
+                d |= b[t] ^ KEYWRAP_ICV;
+            }
+
+            // ok is 1 iff the header matched; mask is 0xff iff ok
+            uint8_t ok   = (uint8_t) (1 & ((d - 1) >> 8));
+            uint8_t mask = (uint8_t) -ok;
+
+            for (int t = 0; t < 32; t++) {
+                k[t] = b[32 + t] & mask;
+            }
+            if (valid != NULL) {
+                valid[i + j] = ok;
+            }
+            all_ok &= ok;
+        }
+        i += batch;
+    }
+    vistrutah_secure_zero(buf, sizeof buf);
+    VISTRUTAH_LEAVE(t0, mode, KEYWRAP_UNWRAP);
+
+    return (int) all_ok - 1;
+}
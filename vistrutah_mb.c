@@ -0,0 +1,161 @@
+#include "vistrutah.h"
+
+// Multi-buffer job manager. Pending jobs are queued in a ring in submission
+// order. A dispatch runs the whole groups of MB_DIRECT_BLOCKS blocks of each
+// job through the multi-block API, then turns the blocks left over into
+// pointer-array entries, one array per direction, and runs the arrays
+// through the pointer-array API in chunks, so that the tails of small
+// messages fill the kernel lanes together instead of each running alone.
+// Where MB_DIRECT_BLOCKS is 1 there are no leftover blocks and the
+// pointer-array API is not used at all. Completion order is the ring order,
+// whatever order the blocks were processed in.
+
+#define MB_CHUNK 64
+
+// Whole groups of MB_DIRECT_BLOCKS blocks fill the lanes of the batch
+// kernels by themselves and go straight through the multi-block API; only the
+// rest of each job is packed with blocks of other jobs. Backends without a
+// batch kernel process one block at a time anyway, so there every job runs
+// directly.
+#if defined(VISTRUTAH_512_VAES256) || defined(VISTRUTAH_SVE2) || defined(VISTRUTAH_RISCV)
+#    define MB_DIRECT_BLOCKS 4
+#else
+#    define MB_DIRECT_BLOCKS 1
+#endif
+
+typedef struct {
+    const uint8_t*           in[MB_CHUNK];
+    uint8_t*                 out[MB_CHUNK];
+    const vistrutah_512_ctx* ctxs[MB_CHUNK];
+    size_t                   n;
+    int                      decrypt;
+} lane_chunk;
+
+static void
+run_chunk(lane_chunk* c)
+{
+    if (c->n == 0) {
+        return;
+    }
+    if (c->decrypt) {
+        vistrutah_512_decrypt_ptrs(NULL, c->ctxs, c->in, c->out, c->n);
+    } else {
+        vistrutah_512_encrypt_ptrs(NULL, c->ctxs, c->in, c->out, c->n);
+    }
+    c->n = 0;
+}
+
+static void
+dispatch(vistrutah_mb_mgr* mgr)
+{
+    lane_chunk        chunks[2];
+    vistrutah_mb_job* order[VISTRUTAH_MB_MAX_JOBS];
+    size_t            first  = mgr->head + mgr->completed;
+    size_t            n      = mgr->count - mgr->completed;
+    size_t            packed = 0;
+
+    VISTRUTAH_ENTER(t0, batch, MB_DISPATCH, 64 * mgr->pending_blocks);
+
+    chunks[0].n       = 0;
+    chunks[0].decrypt = 0;
+    chunks[1].n       = 0;
+    chunks[1].decrypt = 1;
+
+    // Whole groups run in submission order. The remaining blocks are packed
+    // with jobs under the same context next to each other, so that they
+    // share key schedules and fill groups of lanes together.
+    for (size_t k = 0; k < n; k++) {
+        vistrutah_mb_job* job    = mgr->jobs[(first + k) % VISTRUTAH_MB_MAX_JOBS];
+        size_t            direct = job->blocks - job->blocks % MB_DIRECT_BLOCKS;
+        size_t            p      = packed;
+
+        if (direct > 0) {
+            const vistrutah_512_ctx* x = job->ctx;
+
+            if (job->decrypt) {
+                vistrutah_512_decrypt_blocks(job->in, job->out, direct, x->key, x->key_size,
+                                             x->rounds);
+            } else {
+                vistrutah_512_encrypt_blocks(job->in, job->out, direct, x->key, x->key_size,
+                                             x->rounds);
+            }
+        }
+        if (direct == job->blocks) {
+            continue;
+        }
+        packed++;
+        while (p > 0 && (uintptr_t) order[p - 1]->ctx > (uintptr_t) job->ctx) {
+            order[p] = order[p - 1];
+            p--;
+        }
+        order[p] = job;
+    }
+
+    for (size_t k = 0; k < packed; k++) {
+        vistrutah_mb_job* job = order[k];
+        lane_chunk*       c   = &chunks[job->decrypt != 0];
+
+        for (size_t b = job->blocks - job->blocks % MB_DIRECT_BLOCKS; b < job->blocks; b++) {
+            c->in[c->n]   = job->in + 64 * b;
+            c->out[c->n]  = job->out + 64 * b;
+            c->ctxs[c->n] = job->ctx;
+            if (++c->n == MB_CHUNK) {
+                run_chunk(c);
+            }
+        }
+    }
+    run_chunk(&chunks[0]);
+    run_chunk(&chunks[1]);
+
+    mgr->completed      = mgr->count;
+    mgr->pending_blocks = 0;
+    VISTRUTAH_LEAVE(t0, batch, MB_DISPATCH);
+}
+
+void
+vistrutah_mb_init(vistrutah_mb_mgr* mgr, size_t max_jobs, size_t max_blocks)
+{
+    memset(mgr, 0, sizeof *mgr);
+    mgr->max_jobs   = max_jobs == 0 || max_jobs > VISTRUTAH_MB_MAX_JOBS ? VISTRUTAH_MB_MAX_JOBS
+                                                                        : max_jobs;
+    mgr->max_blocks = max_blocks == 0 ? SIZE_MAX : max_blocks;
+}
+
+int
+vistrutah_mb_submit(vistrutah_mb_mgr* mgr, vistrutah_mb_job* job)
+{
+    if (mgr->count == VISTRUTAH_MB_MAX_JOBS) {
+        return -1;
+    }
+    mgr->jobs[(mgr->head + mgr->count) % VISTRUTAH_MB_MAX_JOBS] = job;
+    mgr->count++;
+    mgr->pending_blocks += job->blocks;
+
+    if (mgr->count - mgr->completed >= mgr->max_jobs || mgr->pending_blocks >= mgr->max_blocks) {
+        dispatch(mgr);
+    }
+    return 0;
+}
+
+void
+vistrutah_mb_flush(vistrutah_mb_mgr* mgr)
+{
+    if (mgr->count > mgr->completed) {
+        dispatch(mgr);
+    }
+}
+
+vistrutah_mb_job*
+vistrutah_mb_get_completed(vistrutah_mb_mgr* mgr)
+{
+    if (mgr->completed == 0) {
+        return NULL;
+    }
+
+    vistrutah_mb_job* job = mgr->jobs[mgr->head];
+
+    mgr->head = (mgr->head + 1) % VISTRUTAH_MB_MAX_JOBS;
+    mgr->completed--;
+    mgr->count--;
+    return job;
+}
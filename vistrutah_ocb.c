@@ -0,0 +1,243 @@
+#define VISTRUTAH_INTERNAL
+#include "vistrutah.h"
+
+// OCB3 (RFC 7253) over the 512-bit Vistrutah block, with these changes:
+// - offsets are doubled in GF(2^512) modulo x^512 + x^8 + x^5 + x^2 + 1
+// - the initial offset is the encryption of the formatted nonce; a 512-bit
+//   block holds the whole nonce, so there is no stretch-then-shift step
+// - the tag is the leading VISTRUTAH_OCB_TAG_BYTES of the final block
+//
+// Full blocks go through the multi-block API in batches, so that backends
+// with interleaved kernels keep several blocks in flight.
+
+#define OCB_BATCH 8
+
+static inline int
+ntz(uint64_t i)
+{
+    return __builtin_ctzll(i);
+}
+
+static inline void
+encrypt_block(const vistrutah_ocb_ctx* ctx, const uint8_t* in, uint8_t* out)
+{
+    vistrutah_512_encrypt(in, out, ctx->key, ctx->key_size, ctx->rounds);
+}
+
+static int
+verify_tag(const uint8_t* a, const uint8_t* b)
+{
+    volatile uint8_t d = 0;
+
+    for (int i = 0; i < VISTRUTAH_OCB_TAG_BYTES; i++) {
+        d |= a[i] ^ b[i];
+    }
+    return (int) ((1 & ((d - 1) >> 8)) - 1);
+}
+
+static int
+length_ok(size_t len)
+{
+    return (uint64_t) len / 64 < ((uint64_t) 1 << VISTRUTAH_OCB_L_COUNT);
+}
+
+int
+vistrutah_ocb_init(vistrutah_ocb_ctx* ctx, const uint8_t* key, int key_size, int rounds)
+{
+    uint8_t zero[64] = { 0 };
+
+    if (key_size != VISTRUTAH_KEY_SIZE_256 && key_size != VISTRUTAH_KEY_SIZE_512) {
+        return -1;
+    }
+    memset(ctx, 0, sizeof *ctx);
+    memcpy(ctx->key, key, key_size);
+    ctx->key_size = key_size;
+    ctx->rounds   = rounds;
+
+    encrypt_block(ctx, zero, ctx->L_star);
+    vistrutah_gf512_double(ctx->L_dollar, ctx->L_star);
+    vistrutah_gf512_double(ctx->L[0], ctx->L_dollar);
+    for (int i = 1; i < VISTRUTAH_OCB_L_COUNT; i++) {
+        vistrutah_gf512_double(ctx->L[i], ctx->L[i - 1]);
+    }
+    VISTRUTAH_PROBE(key_init, OCB, key_size);
+
+    return 0;
+}
+
+static void
+hash_ad(const vistrutah_ocb_ctx* ctx, const uint8_t* ad, size_t ad_len, uint8_t* sum)
+{
+    uint8_t offset[64] = { 0 };
+    uint8_t buf[OCB_BATCH * 64];
+    size_t  full = ad_len / 64;
+    size_t  rem  = ad_len % 64;
+
+    memset(sum, 0, 64);
+
+    for (size_t i = 0; i < full;) {
+        size_t n = full - i < OCB_BATCH ? full - i : OCB_BATCH;
+
+        for (size_t j = 0; j < n; j++) {
+            vistrutah_xor_block(offset, offset, ctx->L[ntz(i + j + 1)]);
+            vistrutah_xor_block(buf + 64 * j, ad + 64 * (i + j), offset);
+        }
+        vistrutah_512_encrypt_blocks(buf, buf, n, ctx->key, ctx->key_size, ctx->rounds);
+        for (size_t j = 0; j < n; j++) {
+            vistrutah_xor_block(sum, sum, buf + 64 * j);
+        }
+        i += n;
+    }
+
+    if (rem > 0) {
+        memset(buf, 0, 64);
+        memcpy(buf, ad + 64 * full, rem);
+        buf[rem] = 0x80;
+        vistrutah_xor_block(offset, offset, ctx->L_star);
+        vistrutah_xor_block(buf, buf, offset);
+        encrypt_block(ctx, buf, buf);
+        vistrutah_xor_block(sum, sum, buf);
+    }
+}
+
+static void
+initial_offset(const vistrutah_ocb_ctx* ctx, const uint8_t* nonce, uint8_t* offset)
+{
+    uint8_t block[64] = { 0 };
+
+    block[0] = VISTRUTAH_OCB_TAG_BYTES;
+    block[63 - VISTRUTAH_OCB_NONCE_BYTES] = 0x01;
+    memcpy(block + 64 - VISTRUTAH_OCB_NONCE_BYTES, nonce, VISTRUTAH_OCB_NONCE_BYTES);
+    encrypt_block(ctx, block, offset);
+}
+
+static void
+final_tag(const vistrutah_ocb_ctx* ctx, uint8_t* checksum, const uint8_t* offset,
+          const uint8_t* ad, size_t ad_len, uint8_t* tag)
+{
+    uint8_t sum[64];
+
+    vistrutah_xor_block(checksum, checksum, offset);
+    vistrutah_xor_block(checksum, checksum, ctx->L_dollar);
+    encrypt_block(ctx, checksum, checksum);
+    hash_ad(ctx, ad, ad_len, sum);
+    vistrutah_xor_block(checksum, checksum, sum);
+    memcpy(tag, checksum, VISTRUTAH_OCB_TAG_BYTES);
+}
+
+int
+vistrutah_ocb_encrypt(const vistrutah_ocb_ctx* ctx, const uint8_t* plaintext, uint8_t* ciphertext,
+                      size_t len, const uint8_t* ad, size_t ad_len, const uint8_t* nonce,
+                      uint8_t* tag)
+{
+    uint8_t offset[64];
+    uint8_t checksum[64] = { 0 };
+    uint8_t offsets[OCB_BATCH * 64];
+    uint8_t buf[OCB_BATCH * 64];
+    size_t  full = len / 64;
+    size_t  rem  = len % 64;
+
+    if (!length_ok(len) || !length_ok(ad_len)) {
+        return -1;
+    }
+    VISTRUTAH_ENTER(t0, mode, OCB_ENCRYPT, len);
+    initial_offset(ctx, nonce, offset);
+
+    for (size_t i = 0; i < full;) {
+        size_t n = full - i < OCB_BATCH ? full - i : OCB_BATCH;
+
+        for (size_t j = 0; j < n; j++) {
+            const uint8_t* p = plaintext + 64 * (i + j);
+
+            vistrutah_xor_block(offset, offset, ctx->L[ntz(i + j + 1)]);
+            memcpy(offsets + 64 * j, offset, 64);
+            vistrutah_xor_block(checksum, checksum, p);
+            vistrutah_xor_block(buf + 64 * j, p, offset);
+        }
+        vistrutah_512_encrypt_blocks(buf, buf, n, ctx->key, ctx->key_size, ctx->rounds);
+        for (size_t j = 0; j < n; j++) {
+            vistrutah_xor_block(ciphertext + 64 * (i + j), buf + 64 * j, offsets + 64 * j);
+        }
+        i += n;
+    }
+
+    if (rem > 0) {
+        uint8_t pad[64];
+
+        vistrutah_xor_block(offset, offset, ctx->L_star);
+        encrypt_block(ctx, offset, pad);
+        memset(buf, 0, 64);
+        memcpy(buf, plaintext + 64 * full, rem);
+        buf[rem] = 0x80;
+        vistrutah_xor_block(checksum, checksum, buf);
+        for (size_t j = 0; j < rem; j++) {
+            ciphertext[64 * full + j] = buf[j] ^ pad[j];
+        }
+    }
+
+    final_tag(ctx, checksum, offset, ad, ad_len, tag);
+    VISTRUTAH_LEAVE(t0, mode, OCB_ENCRYPT);
+
+    return 0;
+}
+
+int
+vistrutah_ocb_decrypt(const vistrutah_ocb_ctx* ctx, const uint8_t* ciphertext, uint8_t* plaintext,
+                      size_t len, const uint8_t* ad, size_t ad_len, const uint8_t* nonce,
+                      const uint8_t* tag)
+{
+    uint8_t offset[64];
+    uint8_t checksum[64] = { 0 };
+    uint8_t offsets[OCB_BATCH * 64];
+    uint8_t buf[OCB_BATCH * 64];
+    uint8_t computed_tag[VISTRUTAH_OCB_TAG_BYTES];
+    size_t  full = len / 64;
+    size_t  rem  = len % 64;
+
+    if (!length_ok(len) || !length_ok(ad_len)) {
+        return -1;
+    }
+    VISTRUTAH_ENTER(t0, mode, OCB_DECRYPT, len);
+    initial_offset(ctx, nonce, offset);
+
+    for (size_t i = 0; i < full;) {
+        size_t n = full - i < OCB_BATCH ? full - i : OCB_BATCH;
+
+        for (size_t j = 0; j < n; j++) {
+            vistrutah_xor_block(offset, offset, ctx->L[ntz(i + j + 1)]);
+            memcpy(offsets + 64 * j, offset, 64);
+            vistrutah_xor_block(buf + 64 * j, ciphertext + 64 * (i + j), offset);
+        }
+        vistrutah_512_decrypt_blocks(buf, buf, n, ctx->key, ctx->key_size, ctx->rounds);
+        for (size_t j = 0; j < n; j++) {
+            uint8_t* p = plaintext + 64 * (i + j);
+
+            vistrutah_xor_block(p, buf + 64 * j, offsets + 64 * j);
+            vistrutah_xor_block(checksum, checksum, p);
+        }
+        i += n;
+    }
+
+    if (rem > 0) {
+        uint8_t pad[64];
+
+        vistrutah_xor_block(offset, offset, ctx->L_star);
+        encrypt_block(ctx, offset, pad);
+        memset(buf, 0, 64);
+        for (size_t j = 0; j < rem; j++) {
+            buf[j] = ciphertext[64 * full + j] ^ pad[j];
+        }
+        buf[rem] = 0x80;
+        vistrutah_xor_block(checksum, checksum, buf);
+        memcpy(plaintext + 64 * full, buf, rem);
+    }
+
+    final_tag(ctx, checksum, offset, ad, ad_len, computed_tag);
+    VISTRUTAH_LEAVE(t0, mode, OCB_DECRYPT);
+
+    if (verify_tag(computed_tag, tag) != 0) {
+        memset(plaintext, 0, len);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,273 @@
+#if defined(__linux__)
+#    define _GNU_SOURCE
+#endif
+
+#include "vistrutah.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// Offload engine: application threads (producers) hand jobs to a set of
+// crypto threads through lock-free single-producer/single-consumer rings.
+// Producer p owns one request ring and one completion ring and is served by
+// worker p % workers. A worker drains the request rings of its producers
+// into a multi-buffer job manager, dispatches the whole batch at once and
+// pushes the completed jobs back to each producer's completion ring, in the
+// order that producer submitted them.
+
+typedef struct {
+    _Atomic size_t     head __attribute__((aligned(64))); // next slot to read
+    _Atomic size_t     tail __attribute__((aligned(64))); // next slot to write
+    vistrutah_mb_job** slots __attribute__((aligned(64)));
+    size_t             mask;
+} spsc_ring;
+
+typedef struct {
+    spsc_ring requests;
+    spsc_ring completions;
+} producer_rings;
+
+typedef struct {
+    vistrutah_offload* engine;
+    int                index;
+    pthread_t          tid;
+    bool               started;
+} worker;
+
+struct vistrutah_offload {
+    producer_rings* producers;
+    worker*         workers;
+    int             num_producers;
+    int             num_workers;
+    atomic_bool     stop;
+};
+
+static int
+ring_init(spsc_ring* r, size_t size)
+{
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    r->mask  = size - 1;
+    r->slots = malloc(size * sizeof *r->slots);
+    return r->slots != NULL ? 0 : -1;
+}
+
+static bool
+ring_push(spsc_ring* r, vistrutah_mb_job* job)
+{
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+
+    if (tail - atomic_load_explicit(&r->head, memory_order_acquire) > r->mask) {
+        return false;
+    }
+    r->slots[tail & r->mask] = job;
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+static vistrutah_mb_job*
+ring_pop(spsc_ring* r)
+{
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+
+    if (head == atomic_load_explicit(&r->tail, memory_order_acquire)) {
+        return NULL;
+    }
+
+    vistrutah_mb_job* job = r->slots[head & r->mask];
+
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return job;
+}
+
+// Free slots as seen by the producer side of the ring
+static size_t
+ring_space(spsc_ring* r)
+{
+    size_t used = atomic_load_explicit(&r->tail, memory_order_relaxed) -
+                  atomic_load_explicit(&r->head, memory_order_acquire);
+
+    return r->mask + 1 - used;
+}
+
+static void*
+offload_worker(void* arg)
+{
+    worker*            w = arg;
+    vistrutah_offload* e = w->engine;
+    vistrutah_mb_mgr   mgr;
+    int                owner[VISTRUTAH_MB_MAX_JOBS];
+
+    vistrutah_mb_init(&mgr, VISTRUTAH_MB_MAX_JOBS, 0);
+
+    for (;;) {
+        size_t queued = 0;
+        bool   stop   = atomic_load_explicit(&e->stop, memory_order_acquire);
+
+        // Take no more jobs from a producer than its completion ring can
+        // hold, so that completions never have to wait for the producer
+        for (int p = w->index; p < e->num_producers; p += e->num_workers) {
+            producer_rings*   pr    = &e->producers[p];
+            size_t            space = ring_space(&pr->completions);
+            vistrutah_mb_job* job;
+
+            while (space > 0 && queued < VISTRUTAH_MB_MAX_JOBS &&
+                   (job = ring_pop(&pr->requests)) != NULL) {
+                vistrutah_mb_submit(&mgr, job);
+                owner[queued++] = p;
+                space--;
+            }
+        }
+
+        if (queued == 0) {
+            if (stop) {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+
+        vistrutah_mb_flush(&mgr);
+        for (size_t k = 0; k < queued; k++) {
+            ring_push(&e->producers[owner[k]].completions, vistrutah_mb_get_completed(&mgr));
+        }
+    }
+    return NULL;
+}
+
+// CPU for worker t: cpus[t] if given, otherwise the t-th highest CPU the
+// process may run on. Returns -1 when the worker should not be pinned.
+static int
+worker_cpu(const int* cpus, int t)
+{
+    if (cpus != NULL) {
+        return cpus[t];
+    }
+#if defined(__linux__)
+    cpu_set_t allowed;
+    int       allowed_count;
+
+    if (sched_getaffinity(0, sizeof allowed, &allowed) != 0 ||
+        (allowed_count = CPU_COUNT(&allowed)) == 0) {
+        return -1;
+    }
+    t %= allowed_count;
+    for (int cpu = CPU_SETSIZE - 1; cpu >= 0; cpu--) {
+        if (CPU_ISSET(cpu, &allowed) && t-- == 0) {
+            return cpu;
+        }
+    }
+#endif
+    return -1;
+}
+
+static void
+pin_to_cpu(pthread_t tid, int cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return;
+    }
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    // Best effort: an engine that cannot be pinned still works
+    (void) pthread_setaffinity_np(tid, sizeof set, &set);
+#else
+    (void) tid;
+    (void) cpu;
+#endif
+}
+
+vistrutah_offload*
+vistrutah_offload_create(int workers, int producers, size_t ring_size, const int* cpus)
+{
+    vistrutah_offload* e;
+    size_t             size = 1;
+    size_t             producers_bytes;
+
+    if (workers < 1 || producers < 1 || ring_size == 0) {
+        return NULL;
+    }
+    while (size < ring_size) {
+        size <<= 1;
+    }
+    if ((e = calloc(1, sizeof *e)) == NULL) {
+        return NULL;
+    }
+    e->num_workers   = workers < producers ? workers : producers;
+    e->num_producers = producers;
+    atomic_init(&e->stop, false);
+    // The rings keep head and tail on separate cache lines, which needs the
+    // array itself to be cache-line aligned
+    producers_bytes = ((size_t) producers * sizeof *e->producers + 63) & ~(size_t) 63;
+    e->producers    = aligned_alloc(64, producers_bytes);
+    if (e->producers != NULL) {
+        memset(e->producers, 0, producers_bytes);
+    }
+    e->workers   = calloc((size_t) e->num_workers, sizeof *e->workers);
+    if (e->producers == NULL || e->workers == NULL) {
+        vistrutah_offload_destroy(e);
+        return NULL;
+    }
+    for (int p = 0; p < producers; p++) {
+        if (ring_init(&e->producers[p].requests, size) != 0 ||
+            ring_init(&e->producers[p].completions, size) != 0) {
+            vistrutah_offload_destroy(e);
+            return NULL;
+        }
+    }
+    for (int t = 0; t < e->num_workers; t++) {
+        worker* w = &e->workers[t];
+
+        w->engine  = e;
+        w->index   = t;
+        w->started = pthread_create(&w->tid, NULL, offload_worker, w) == 0;
+        if (!w->started) {
+            vistrutah_offload_destroy(e);
+            return NULL;
+        }
+        pin_to_cpu(w->tid, worker_cpu(cpus, t));
+    }
+    return e;
+}
+
+void
+vistrutah_offload_destroy(vistrutah_offload* engine)
+{
+    if (engine == NULL) {
+        return;
+    }
+    atomic_store_explicit(&engine->stop, true, memory_order_release);
+    if (engine->workers != NULL) {
+        for (int t = 0; t < engine->num_workers; t++) {
+            if (engine->workers[t].started) {
+                pthread_join(engine->workers[t].tid, NULL);
+            }
+        }
+    }
+    if (engine->producers != NULL) {
+        for (int p = 0; p < engine->num_producers; p++) {
+            free(engine->producers[p].requests.slots);
+            free(engine->producers[p].completions.slots);
+        }
+    }
+    free(engine->producers);
+    free(engine->workers);
+    free(engine);
+}
+
+int
+vistrutah_offload_submit(vistrutah_offload* engine, int producer, vistrutah_mb_job* job)
+{
+    return ring_push(&engine->producers[producer].requests, job) ? 0 : -1;
+}
+
+vistrutah_mb_job*
+vistrutah_offload_poll(vistrutah_offload* engine, int producer)
+{
+    return ring_pop(&engine->producers[producer].completions);
+}
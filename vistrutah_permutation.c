@@ -0,0 +1,256 @@
+#include "vistrutah.h"
+
+// Keyless 512-bit permutation: Vistrutah-512 under the fixed key
+// VISTRUTAH_PERMUTATION_KEY (ROUND_CONSTANTS[576..639]) with
+// VISTRUTAH_PERMUTATION_ROUNDS rounds. The key schedule of that key is
+// expanded into the tables below, so a call does no key setup at all; the
+// tests check the result against vistrutah_512_encrypt().
+
+extern const uint8_t ROUND_CONSTANTS[16 * 48];
+
+#define PERM_STEPS (VISTRUTAH_PERMUTATION_ROUNDS / ROUNDS_PER_STEP)
+
+// The table-driven versions need the AES instructions, which portable
+// builds do not enable even where the header detects the architecture
+#if defined(VISTRUTAH_ARM) && (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO))
+#    define PERM_NEON
+#elif defined(VISTRUTAH_INTEL) && defined(__AES__)
+#    define PERM_AESNI
+#endif
+
+#if defined(PERM_NEON) || defined(PERM_AESNI)
+// Fixed key after the key expansion shuffle
+static const uint8_t PERM_FIXED_KEY[64] = {
+    0xCC, 0x81, 0x45, 0x44, 0xAF, 0x5E, 0xBD, 0x09, 0xBE, 0xE3, 0xD0, 0x04, 0xDE, 0x33, 0x4A, 0xFD,
+    0x66, 0x0F, 0x28, 0x07, 0x19, 0x2E, 0x4B, 0xB3, 0xC0, 0xCB, 0xA8, 0x57, 0x45, 0xC8, 0x74, 0x0F,
+    0xA3, 0x1F, 0x55, 0x79, 0xC0, 0x79, 0x40, 0x39, 0x72, 0x2C, 0xD2, 0xCC, 0x5F, 0x0B, 0xFB, 0xBD,
+    0x32, 0x60, 0x67, 0xDB, 0x25, 0x9F, 0xB9, 0xC6, 0xFB, 0xD3, 0xD6, 0x0A, 0x00, 0xA1, 0x1A, 0xFE,
+};
+#endif
+
+#if defined(PERM_AESNI)
+
+#    include <immintrin.h>
+
+// Round keys of steps 0 to PERM_STEPS, with the round constants folded in.
+// The inner ones are pre-permuted by the inverse mixing layer, so that the
+// AES round in front of the mixing layer adds them.
+static const uint8_t PERM_ROUND_KEYS[(PERM_STEPS + 1) * 64] = {
+    0x66, 0x0F, 0x28, 0x07, 0x19, 0x2E, 0x4B, 0xB3, 0xC0, 0xCB, 0xA8, 0x57, 0x45, 0xC8, 0x74, 0x0F,
+    0xCC, 0x81, 0x45, 0x44, 0xAF, 0x5E, 0xBD, 0x09, 0xBE, 0xE3, 0xD0, 0x04, 0xDE, 0x33, 0x4A, 0xFD,
+    0x32, 0x60, 0x67, 0xDB, 0x25, 0x9F, 0xB9, 0xC6, 0xFB, 0xD3, 0xD6, 0x0A, 0x00, 0xA1, 0x1A, 0xFE,
+    0xA3, 0x1F, 0x55, 0x79, 0xC0, 0x79, 0x40, 0x39, 0x72, 0x2C, 0xD2, 0xCC, 0x5F, 0x0B, 0xFB, 0xBD,
+    0x0A, 0x4E, 0xDB, 0x0C, 0x9F, 0xD3, 0xA1, 0x60, 0xD0, 0x4A, 0x45, 0xBD, 0xD2, 0xFB, 0x55, 0x40,
+    0x74, 0x0B, 0x6D, 0x58, 0xB9, 0xD6, 0x1A, 0x67, 0x04, 0xFD, 0x44, 0x09, 0xCC, 0xBD, 0x79, 0x39,
+    0xD9, 0x5F, 0x85, 0x74, 0xC6, 0x0A, 0xFE, 0xDB, 0xDE, 0xCC, 0xAF, 0xBE, 0x5F, 0xA3, 0xC0, 0x72,
+    0x48, 0x96, 0x48, 0x5D, 0xFB, 0x00, 0x32, 0x25, 0x33, 0x81, 0x5E, 0xE3, 0x0B, 0x1F, 0x79, 0x2C,
+    0x0C, 0x5D, 0x20, 0xA7, 0xD6, 0x1A, 0x67, 0xB9, 0xAF, 0xBE, 0xDE, 0xCC, 0xC0, 0x72, 0x5F, 0xA3,
+    0x5E, 0x90, 0x29, 0xFD, 0x0A, 0xFE, 0xDB, 0xC6, 0x5E, 0xE3, 0x33, 0x81, 0x79, 0x2C, 0x0B, 0x1F,
+    0x7D, 0x57, 0xE3, 0xAC, 0x00, 0x32, 0x25, 0xFB, 0xBD, 0xD0, 0x4A, 0x45, 0x40, 0xD2, 0xFB, 0x55,
+    0xEA, 0xDF, 0xB6, 0x42, 0xA1, 0x60, 0x9F, 0xD3, 0x09, 0x04, 0xFD, 0x44, 0x39, 0xCC, 0xBD, 0x79,
+    0x4A, 0x3F, 0x0D, 0x63, 0xFE, 0xDB, 0xC6, 0x0A, 0x4A, 0x45, 0xBD, 0xD0, 0xFB, 0x55, 0x40, 0xD2,
+    0x4E, 0xC9, 0x94, 0xAC, 0x32, 0x25, 0xFB, 0x00, 0xFD, 0x44, 0x09, 0x04, 0xBD, 0x79, 0x39, 0xCC,
+    0x2E, 0x3D, 0xAD, 0xC4, 0x60, 0x9F, 0xD3, 0xA1, 0xCC, 0xAF, 0xBE, 0xDE, 0xA3, 0xC0, 0x72, 0x5F,
+    0xCE, 0x3C, 0x67, 0x18, 0x67, 0xB9, 0xD6, 0x1A, 0x81, 0x5E, 0xE3, 0x33, 0x1F, 0x79, 0x2C, 0x0B,
+    0xD9, 0x09, 0x7A, 0xD3, 0x25, 0xFB, 0x00, 0x32, 0xBE, 0xDE, 0xCC, 0xAF, 0x72, 0x5F, 0xA3, 0xC0,
+    0x82, 0xB7, 0x4C, 0x48, 0x9F, 0xD3, 0xA1, 0x60, 0xE3, 0x33, 0x81, 0x5E, 0x2C, 0x0B, 0x1F, 0x79,
+    0x62, 0xF8, 0xA1, 0x21, 0xB9, 0xD6, 0x1A, 0x67, 0xD0, 0x4A, 0x45, 0xBD, 0xD2, 0xFB, 0x55, 0x40,
+    0x04, 0x8A, 0xBA, 0x10, 0xC6, 0x0A, 0xFE, 0xDB, 0x04, 0xFD, 0x44, 0x09, 0xCC, 0xBD, 0x79, 0x39,
+    0x59, 0x41, 0xDE, 0xB6, 0xD3, 0xA1, 0x60, 0x9F, 0x45, 0xBD, 0xD0, 0x4A, 0x55, 0x40, 0xD2, 0xFB,
+    0xBE, 0x0D, 0x19, 0x94, 0xD6, 0x1A, 0x67, 0xB9, 0x44, 0x09, 0x04, 0xFD, 0x79, 0x39, 0xCC, 0xBD,
+    0x82, 0xF4, 0x0C, 0x06, 0x0A, 0xFE, 0xDB, 0xC6, 0xAF, 0xBE, 0xDE, 0xCC, 0xC0, 0x72, 0x5F, 0xA3,
+    0x9C, 0x7D, 0xBF, 0x6C, 0x00, 0x32, 0x25, 0xFB, 0x5E, 0xE3, 0x33, 0x81, 0x79, 0x2C, 0x0B, 0x1F,
+    0x5B, 0xF8, 0xF3, 0xC2, 0x1A, 0x67, 0xB9, 0xD6, 0xDE, 0xCC, 0xAF, 0xBE, 0x5F, 0xA3, 0xC0, 0x72,
+    0xF2, 0x1D, 0x52, 0x71, 0xFE, 0xDB, 0xC6, 0x0A, 0x33, 0x81, 0x5E, 0xE3, 0x0B, 0x1F, 0x79, 0x2C,
+    0x14, 0xC6, 0x6F, 0x3B, 0x32, 0x25, 0xFB, 0x00, 0x4A, 0x45, 0xBD, 0xD0, 0xFB, 0x55, 0x40, 0xD2,
+    0xD4, 0x99, 0x26, 0x5E, 0x60, 0x9F, 0xD3, 0xA1, 0xFD, 0x44, 0x09, 0x04, 0xBD, 0x79, 0x39, 0xCC,
+    0xBD, 0x42, 0x73, 0xBC, 0xDB, 0xC6, 0x0A, 0xFE, 0xBD, 0xD0, 0x4A, 0x45, 0x40, 0xD2, 0xFB, 0x55,
+    0x65, 0xEC, 0xE4, 0xF7, 0x25, 0xFB, 0x00, 0x32, 0x09, 0x04, 0xFD, 0x44, 0x39, 0xCC, 0xBD, 0x79,
+    0xBE, 0xB4, 0x51, 0x63, 0x9F, 0xD3, 0xA1, 0x60, 0xBE, 0xDE, 0xCC, 0xAF, 0x72, 0x5F, 0xA3, 0xC0,
+    0x0E, 0x31, 0x33, 0xDF, 0xB9, 0xD6, 0x1A, 0x67, 0xE3, 0x33, 0x81, 0x5E, 0x2C, 0x0B, 0x1F, 0x79,
+    0xC8, 0xC0, 0x05, 0x68, 0xFB, 0x00, 0x32, 0x25, 0xCC, 0xAF, 0xBE, 0xDE, 0xA3, 0xC0, 0x72, 0x5F,
+    0xCA, 0x46, 0x66, 0x79, 0xD3, 0xA1, 0x60, 0x9F, 0x81, 0x5E, 0xE3, 0x33, 0x1F, 0x79, 0x2C, 0x0B,
+    0x5A, 0x88, 0x08, 0x05, 0xD6, 0x1A, 0x67, 0xB9, 0x45, 0xBD, 0xD0, 0x4A, 0x55, 0x40, 0xD2, 0xFB,
+    0xB5, 0x19, 0xDF, 0xDA, 0x0A, 0xFE, 0xDB, 0xC6, 0x44, 0x09, 0x04, 0xFD, 0x79, 0x39, 0xCC, 0xBD,
+    0xC8, 0x74, 0x0F, 0x66, 0x0F, 0x28, 0x07, 0x19, 0x2E, 0x4B, 0xB3, 0xC0, 0xCB, 0xA8, 0x57, 0x45,
+    0xD0, 0x04, 0xDE, 0x33, 0x4A, 0xFD, 0xCC, 0x81, 0x45, 0x44, 0xAF, 0x5E, 0xBD, 0x09, 0xBE, 0xE3,
+    0xA1, 0x1A, 0xFE, 0x32, 0x60, 0x67, 0xDB, 0x25, 0x9F, 0xB9, 0xC6, 0xFB, 0xD3, 0xD6, 0x0A, 0x00,
+    0xD2, 0xCC, 0x5F, 0x0B, 0xFB, 0xBD, 0xA3, 0x1F, 0x55, 0x79, 0xC0, 0x79, 0x40, 0x39, 0x72, 0x2C,
+};
+
+static inline void
+mixing_layer_512(__m128i* s0, __m128i* s1, __m128i* s2, __m128i* s3)
+{
+    __m128i lo01 = _mm_unpacklo_epi8(*s0, *s1);
+    __m128i hi01 = _mm_unpackhi_epi8(*s0, *s1);
+    __m128i lo23 = _mm_unpacklo_epi8(*s2, *s3);
+    __m128i hi23 = _mm_unpackhi_epi8(*s2, *s3);
+
+    *s0 = _mm_unpacklo_epi16(lo01, lo23);
+    *s2 = _mm_unpackhi_epi16(lo01, lo23);
+    *s1 = _mm_unpacklo_epi16(hi01, hi23);
+    *s3 = _mm_unpackhi_epi16(hi01, hi23);
+}
+
+static inline void
+permute_state(uint8_t* state)
+{
+    const __m128i* fk = (const __m128i*) PERM_FIXED_KEY;
+    const __m128i* rk = (const __m128i*) PERM_ROUND_KEYS;
+    __m128i        fk0 = _mm_loadu_si128(fk);
+    __m128i        fk1 = _mm_loadu_si128(fk + 1);
+    __m128i        fk2 = _mm_loadu_si128(fk + 2);
+    __m128i        fk3 = _mm_loadu_si128(fk + 3);
+
+    __m128i s0 = _mm_loadu_si128((const __m128i*) state);
+    __m128i s1 = _mm_loadu_si128((const __m128i*) (state + 16));
+    __m128i s2 = _mm_loadu_si128((const __m128i*) (state + 32));
+    __m128i s3 = _mm_loadu_si128((const __m128i*) (state + 48));
+
+    s0 = _mm_aesenc_si128(_mm_xor_si128(s0, _mm_loadu_si128(rk)), fk0);
+    s1 = _mm_aesenc_si128(_mm_xor_si128(s1, _mm_loadu_si128(rk + 1)), fk1);
+    s2 = _mm_aesenc_si128(_mm_xor_si128(s2, _mm_loadu_si128(rk + 2)), fk2);
+    s3 = _mm_aesenc_si128(_mm_xor_si128(s3, _mm_loadu_si128(rk + 3)), fk3);
+
+    for (int i = 1; i < PERM_STEPS; i++) {
+        s0 = _mm_aesenc_si128(s0, _mm_loadu_si128(rk + 4 * i));
+        s1 = _mm_aesenc_si128(s1, _mm_loadu_si128(rk + 4 * i + 1));
+        s2 = _mm_aesenc_si128(s2, _mm_loadu_si128(rk + 4 * i + 2));
+        s3 = _mm_aesenc_si128(s3, _mm_loadu_si128(rk + 4 * i + 3));
+
+        mixing_layer_512(&s0, &s1, &s2, &s3);
+
+        s0 = _mm_aesenc_si128(s0, fk0);
+        s1 = _mm_aesenc_si128(s1, fk1);
+        s2 = _mm_aesenc_si128(s2, fk2);
+        s3 = _mm_aesenc_si128(s3, fk3);
+    }
+
+    s0 = _mm_aesenclast_si128(s0, _mm_loadu_si128(rk + 4 * PERM_STEPS));
+    s1 = _mm_aesenclast_si128(s1, _mm_loadu_si128(rk + 4 * PERM_STEPS + 1));
+    s2 = _mm_aesenclast_si128(s2, _mm_loadu_si128(rk + 4 * PERM_STEPS + 2));
+    s3 = _mm_aesenclast_si128(s3, _mm_loadu_si128(rk + 4 * PERM_STEPS + 3));
+
+    _mm_storeu_si128((__m128i*) state, s0);
+    _mm_storeu_si128((__m128i*) (state + 16), s1);
+    _mm_storeu_si128((__m128i*) (state + 32), s2);
+    _mm_storeu_si128((__m128i*) (state + 48), s3);
+}
+
+#elif defined(PERM_NEON)
+
+#    include <arm_neon.h>
+
+// Round keys of steps 0 to PERM_STEPS, with the round constants folded in
+static const uint8_t PERM_ROUND_KEYS[(PERM_STEPS + 1) * 64] = {
+    0x66, 0x0F, 0x28, 0x07, 0x19, 0x2E, 0x4B, 0xB3, 0xC0, 0xCB, 0xA8, 0x57, 0x45, 0xC8, 0x74, 0x0F,
+    0xCC, 0x81, 0x45, 0x44, 0xAF, 0x5E, 0xBD, 0x09, 0xBE, 0xE3, 0xD0, 0x04, 0xDE, 0x33, 0x4A, 0xFD,
+    0x32, 0x60, 0x67, 0xDB, 0x25, 0x9F, 0xB9, 0xC6, 0xFB, 0xD3, 0xD6, 0x0A, 0x00, 0xA1, 0x1A, 0xFE,
+    0xA3, 0x1F, 0x55, 0x79, 0xC0, 0x79, 0x40, 0x39, 0x72, 0x2C, 0xD2, 0xCC, 0x5F, 0x0B, 0xFB, 0xBD,
+    0x0A, 0x74, 0xD9, 0x48, 0x4E, 0x0B, 0x5F, 0x96, 0xDB, 0x6D, 0x85, 0x48, 0x0C, 0x58, 0x74, 0x5D,
+    0xD0, 0x04, 0xDE, 0x33, 0x4A, 0xFD, 0xCC, 0x81, 0x45, 0x44, 0xAF, 0x5E, 0xBD, 0x09, 0xBE, 0xE3,
+    0x9F, 0xB9, 0xC6, 0xFB, 0xD3, 0xD6, 0x0A, 0x00, 0xA1, 0x1A, 0xFE, 0x32, 0x60, 0x67, 0xDB, 0x25,
+    0xD2, 0xCC, 0x5F, 0x0B, 0xFB, 0xBD, 0xA3, 0x1F, 0x55, 0x79, 0xC0, 0x79, 0x40, 0x39, 0x72, 0x2C,
+    0x0C, 0x5E, 0x7D, 0xEA, 0x5D, 0x90, 0x57, 0xDF, 0x20, 0x29, 0xE3, 0xB6, 0xA7, 0xFD, 0xAC, 0x42,
+    0xAF, 0x5E, 0xBD, 0x09, 0xBE, 0xE3, 0xD0, 0x04, 0xDE, 0x33, 0x4A, 0xFD, 0xCC, 0x81, 0x45, 0x44,
+    0xD6, 0x0A, 0x00, 0xA1, 0x1A, 0xFE, 0x32, 0x60, 0x67, 0xDB, 0x25, 0x9F, 0xB9, 0xC6, 0xFB, 0xD3,
+    0xC0, 0x79, 0x40, 0x39, 0x72, 0x2C, 0xD2, 0xCC, 0x5F, 0x0B, 0xFB, 0xBD, 0xA3, 0x1F, 0x55, 0x79,
+    0x4A, 0x4E, 0x2E, 0xCE, 0x3F, 0xC9, 0x3D, 0x3C, 0x0D, 0x94, 0xAD, 0x67, 0x63, 0xAC, 0xC4, 0x18,
+    0x4A, 0xFD, 0xCC, 0x81, 0x45, 0x44, 0xAF, 0x5E, 0xBD, 0x09, 0xBE, 0xE3, 0xD0, 0x04, 0xDE, 0x33,
+    0xFE, 0x32, 0x60, 0x67, 0xDB, 0x25, 0x9F, 0xB9, 0xC6, 0xFB, 0xD3, 0xD6, 0x0A, 0x00, 0xA1, 0x1A,
+    0xFB, 0xBD, 0xA3, 0x1F, 0x55, 0x79, 0xC0, 0x79, 0x40, 0x39, 0x72, 0x2C, 0xD2, 0xCC, 0x5F, 0x0B,
+    0xD9, 0x82, 0x62, 0x04, 0x09, 0xB7, 0xF8, 0x8A, 0x7A, 0x4C, 0xA1, 0xBA, 0xD3, 0x48, 0x21, 0x10,
+    0xBE, 0xE3, 0xD0, 0x04, 0xDE, 0x33, 0x4A, 0xFD, 0xCC, 0x81, 0x45, 0x44, 0xAF, 0x5E, 0xBD, 0x09,
+    0x25, 0x9F, 0xB9, 0xC6, 0xFB, 0xD3, 0xD6, 0x0A, 0x00, 0xA1, 0x1A, 0xFE, 0x32, 0x60, 0x67, 0xDB,
+    0x72, 0x2C, 0xD2, 0xCC, 0x5F, 0x0B, 0xFB, 0xBD, 0xA3, 0x1F, 0x55, 0x79, 0xC0, 0x79, 0x40, 0x39,
+    0x59, 0xBE, 0x82, 0x9C, 0x41, 0x0D, 0xF4, 0x7D, 0xDE, 0x19, 0x0C, 0xBF, 0xB6, 0x94, 0x06, 0x6C,
+    0x45, 0x44, 0xAF, 0x5E, 0xBD, 0x09, 0xBE, 0xE3, 0xD0, 0x04, 0xDE, 0x33, 0x4A, 0xFD, 0xCC, 0x81,
+    0xD3, 0xD6, 0x0A, 0x00, 0xA1, 0x1A, 0xFE, 0x32, 0x60, 0x67, 0xDB, 0x25, 0x9F, 0xB9, 0xC6, 0xFB,
+    0x55, 0x79, 0xC0, 0x79, 0x40, 0x39, 0x72, 0x2C, 0xD2, 0xCC, 0x5F, 0x0B, 0xFB, 0xBD, 0xA3, 0x1F,
+    0x5B, 0xF2, 0x14, 0xD4, 0xF8, 0x1D, 0xC6, 0x99, 0xF3, 0x52, 0x6F, 0x26, 0xC2, 0x71, 0x3B, 0x5E,
+    0xDE, 0x33, 0x4A, 0xFD, 0xCC, 0x81, 0x45, 0x44, 0xAF, 0x5E, 0xBD, 0x09, 0xBE, 0xE3, 0xD0, 0x04,
+    0x1A, 0xFE, 0x32, 0x60, 0x67, 0xDB, 0x25, 0x9F, 0xB9, 0xC6, 0xFB, 0xD3, 0xD6, 0x0A, 0x00, 0xA1,
+    0x5F, 0x0B, 0xFB, 0xBD, 0xA3, 0x1F, 0x55, 0x79, 0xC0, 0x79, 0x40, 0x39, 0x72, 0x2C, 0xD2, 0xCC,
+    0xBD, 0x65, 0xBE, 0x0E, 0x42, 0xEC, 0xB4, 0x31, 0x73, 0xE4, 0x51, 0x33, 0xBC, 0xF7, 0x63, 0xDF,
+    0xBD, 0x09, 0xBE, 0xE3, 0xD0, 0x04, 0xDE, 0x33, 0x4A, 0xFD, 0xCC, 0x81, 0x45, 0x44, 0xAF, 0x5E,
+    0xDB, 0x25, 0x9F, 0xB9, 0xC6, 0xFB, 0xD3, 0xD6, 0x0A, 0x00, 0xA1, 0x1A, 0xFE, 0x32, 0x60, 0x67,
+    0x40, 0x39, 0x72, 0x2C, 0xD2, 0xCC, 0x5F, 0x0B, 0xFB, 0xBD, 0xA3, 0x1F, 0x55, 0x79, 0xC0, 0x79,
+    0xC8, 0xCA, 0x5A, 0xB5, 0xC0, 0x46, 0x88, 0x19, 0x05, 0x66, 0x08, 0xDF, 0x68, 0x79, 0x05, 0xDA,
+    0xCC, 0x81, 0x45, 0x44, 0xAF, 0x5E, 0xBD, 0x09, 0xBE, 0xE3, 0xD0, 0x04, 0xDE, 0x33, 0x4A, 0xFD,
+    0xFB, 0xD3, 0xD6, 0x0A, 0x00, 0xA1, 0x1A, 0xFE, 0x32, 0x60, 0x67, 0xDB, 0x25, 0x9F, 0xB9, 0xC6,
+    0xA3, 0x1F, 0x55, 0x79, 0xC0, 0x79, 0x40, 0x39, 0x72, 0x2C, 0xD2, 0xCC, 0x5F, 0x0B, 0xFB, 0xBD,
+    0xC8, 0x74, 0x0F, 0x66, 0x0F, 0x28, 0x07, 0x19, 0x2E, 0x4B, 0xB3, 0xC0, 0xCB, 0xA8, 0x57, 0x45,
+    0xD0, 0x04, 0xDE, 0x33, 0x4A, 0xFD, 0xCC, 0x81, 0x45, 0x44, 0xAF, 0x5E, 0xBD, 0x09, 0xBE, 0xE3,
+    0xA1, 0x1A, 0xFE, 0x32, 0x60, 0x67, 0xDB, 0x25, 0x9F, 0xB9, 0xC6, 0xFB, 0xD3, 0xD6, 0x0A, 0x00,
+    0xD2, 0xCC, 0x5F, 0x0B, 0xFB, 0xBD, 0xA3, 0x1F, 0x55, 0x79, 0xC0, 0x79, 0x40, 0x39, 0x72, 0x2C,
+};
+
+// AESE adds its key before SubBytes, so each round key is passed to the
+// AESE of the round that follows it
+#    define AES_ENC(A, K)      vaesmcq_u8(vaeseq_u8((A), (K)))
+#    define AES_ENC_LAST(A, K) vaeseq_u8((A), (K))
+
+static const uint8_t MIX_INDEX[64] = {
+    0,  16, 32, 48, 1,  17, 33, 49, 2,  18, 34, 50, 3,  19, 35, 51,
+    8,  24, 40, 56, 9,  25, 41, 57, 10, 26, 42, 58, 11, 27, 43, 59,
+    4,  20, 36, 52, 5,  21, 37, 53, 6,  22, 38, 54, 7,  23, 39, 55,
+    12, 28, 44, 60, 13, 29, 45, 61, 14, 30, 46, 62, 15, 31, 47, 63,
+};
+
+static inline void
+permute_state(uint8_t* state)
+{
+    uint8x16_t fk0  = vld1q_u8(PERM_FIXED_KEY);
+    uint8x16_t fk1  = vld1q_u8(PERM_FIXED_KEY + 16);
+    uint8x16_t fk2  = vld1q_u8(PERM_FIXED_KEY + 32);
+    uint8x16_t fk3  = vld1q_u8(PERM_FIXED_KEY + 48);
+    uint8x16_t idx0 = vld1q_u8(MIX_INDEX);
+    uint8x16_t idx1 = vld1q_u8(MIX_INDEX + 16);
+    uint8x16_t idx2 = vld1q_u8(MIX_INDEX + 32);
+    uint8x16_t idx3 = vld1q_u8(MIX_INDEX + 48);
+
+    uint8x16_t s0 = AES_ENC(vld1q_u8(state), vld1q_u8(PERM_ROUND_KEYS));
+    uint8x16_t s1 = AES_ENC(vld1q_u8(state + 16), vld1q_u8(PERM_ROUND_KEYS + 16));
+    uint8x16_t s2 = AES_ENC(vld1q_u8(state + 32), vld1q_u8(PERM_ROUND_KEYS + 32));
+    uint8x16_t s3 = AES_ENC(vld1q_u8(state + 48), vld1q_u8(PERM_ROUND_KEYS + 48));
+
+    for (int i = 1; i < PERM_STEPS; i++) {
+        const uint8_t* rk = PERM_ROUND_KEYS + 64 * i;
+
+        uint8x16x4_t t = { { AES_ENC(s0, fk0), AES_ENC(s1, fk1), AES_ENC(s2, fk2),
+                             AES_ENC(s3, fk3) } };
+
+        s0 = AES_ENC(vqtbl4q_u8(t, idx0), vld1q_u8(rk));
+        s1 = AES_ENC(vqtbl4q_u8(t, idx1), vld1q_u8(rk + 16));
+        s2 = AES_ENC(vqtbl4q_u8(t, idx2), vld1q_u8(rk + 32));
+        s3 = AES_ENC(vqtbl4q_u8(t, idx3), vld1q_u8(rk + 48));
+    }
+
+    const uint8_t* rk = PERM_ROUND_KEYS + 64 * PERM_STEPS;
+
+    vst1q_u8(state, veorq_u8(AES_ENC_LAST(s0, fk0), vld1q_u8(rk)));
+    vst1q_u8(state + 16, veorq_u8(AES_ENC_LAST(s1, fk1), vld1q_u8(rk + 16)));
+    vst1q_u8(state + 32, veorq_u8(AES_ENC_LAST(s2, fk2), vld1q_u8(rk + 32)));
+    vst1q_u8(state + 48, veorq_u8(AES_ENC_LAST(s3, fk3), vld1q_u8(rk + 48)));
+}
+
+#else
+
+// No table-driven version here: go through the block cipher, whose key
+// schedule is cheap to redo for the portable and RISC-V backends
+static inline void
+permute_state(uint8_t* state)
+{
+    vistrutah_512_encrypt(state, state, VISTRUTAH_PERMUTATION_KEY, 64,
+                          VISTRUTAH_PERMUTATION_ROUNDS);
+}
+
+#endif
+
+void
+vistrutah_512_permute(uint8_t* state)
+{
+    VISTRUTAH_ENTER(t0, batch, 512_PERMUTE, 64);
+    permute_state(state);
+    VISTRUTAH_LEAVE(t0, batch, 512_PERMUTE);
+}
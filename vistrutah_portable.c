@@ -1,3 +1,5 @@
+#define VISTRUTAH_BACKEND
+
 #include "vistrutah.h"
 
 static const uint8_t sbox[256] = {
@@ -80,10 +82,12 @@ vistrutah_has_aes_accel(void)
     return false;
 }
 
+const char* const vistrutah_impl_name = "Portable (no hardware acceleration)";
+
 const char*
 vistrutah_get_impl_name(void)
 {
-    return "Portable (no hardware acceleration)";
+    return vistrutah_impl_name;
 }
 
 static void
@@ -585,3 +589,39 @@ vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8
 
     memcpy(plaintext, state, 64);
 }
+
+void
+vistrutah_256_encrypt_blocks(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    for (size_t i = 0; i < blocks; i++) {
+        vistrutah_256_encrypt(plaintext + 32 * i, ciphertext + 32 * i, key, key_size, rounds);
+    }
+}
+
+void
+vistrutah_256_decrypt_blocks(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    for (size_t i = 0; i < blocks; i++) {
+        vistrutah_256_decrypt(ciphertext + 32 * i, plaintext + 32 * i, key, key_size, rounds);
+    }
+}
+
+void
+vistrutah_512_encrypt_blocks(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    for (size_t i = 0; i < blocks; i++) {
+        vistrutah_512_encrypt(plaintext + 64 * i, ciphertext + 64 * i, key, key_size, rounds);
+    }
+}
+
+void
+vistrutah_512_decrypt_blocks(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    for (size_t i = 0; i < blocks; i++) {
+        vistrutah_512_decrypt(ciphertext + 64 * i, plaintext + 64 * i, key, key_size, rounds);
+    }
+}
@@ -0,0 +1,136 @@
+#define VISTRUTAH_INTERNAL
+#include "vistrutah.h"
+
+// Re-encryption from one key to another in a single pass over memory. Each
+// group of blocks is decrypted and re-encrypted while it is still in L1 (in
+// registers on the VAES backend), so the data is read and written once.
+// CTR to CTR never forms the plaintext at all: both keystreams are produced
+// for a group and XORed into the data together.
+
+#define REENCRYPT_BATCH 16
+
+#if !defined(VISTRUTAH_INTEL) || !defined(VISTRUTAH_512_VAES256)
+void
+vistrutah_512_reencrypt_blocks(const vistrutah_512_ctx* from, const vistrutah_512_ctx* to,
+                               const uint8_t* in, uint8_t* out, size_t blocks)
+{
+    uint8_t buf[REENCRYPT_BATCH * 64];
+
+    VISTRUTAH_ENTER(t0, batch, 512_REENCRYPT, 64 * blocks);
+
+    for (size_t i = 0; i < blocks;) {
+        size_t n = blocks - i < REENCRYPT_BATCH ? blocks - i : REENCRYPT_BATCH;
+
+        vistrutah_512_decrypt_blocks(in + 64 * i, buf, n, from->key, from->key_size,
+                                     from->rounds);
+        vistrutah_512_encrypt_blocks(buf, out + 64 * i, n, to->key, to->key_size, to->rounds);
+        i += n;
+    }
+    vistrutah_secure_zero(buf, sizeof buf);
+    VISTRUTAH_LEAVE(t0, batch, 512_REENCRYPT);
+}
+#endif
+
+static void
+counter_blocks(uint8_t* blocks, const uint8_t* nonce, uint64_t first, size_t n)
+{
+    for (size_t j = 0; j < n; j++) {
+        uint8_t* b = blocks + 64 * j;
+
+        memcpy(b, nonce, VISTRUTAH_CTR_NONCE_BYTES);
+        for (int k = 0; k < 8; k++) {
+            b[63 - k] = (uint8_t) ((first + j) >> (8 * k));
+        }
+    }
+}
+
+void
+vistrutah_ctr_reencrypt(const vistrutah_ctr_ctx* from, const vistrutah_ctr_ctx* to,
+                        uint64_t offset, const uint8_t* in, uint8_t* out, size_t len)
+{
+    const vistrutah_512_ctx* a = &from->cipher;
+    const vistrutah_512_ctx* b = &to->cipher;
+    uint8_t                  ks_from[REENCRYPT_BATCH * 64];
+    uint8_t                  ks_to[REENCRYPT_BATCH * 64];
+    uint64_t                 block = offset / 64;
+    size_t                   skip  = (size_t) (offset % 64);
+
+    VISTRUTAH_ENTER(t0, mode, CTR_REENCRYPT, len);
+
+    while (len > 0) {
+        size_t n = (skip + len + 63) / 64;
+
+        if (n > REENCRYPT_BATCH) {
+            n = REENCRYPT_BATCH;
+        }
+        counter_blocks(ks_from, from->nonce, block, n);
+        counter_blocks(ks_to, to->nonce, block, n);
+        vistrutah_512_encrypt_blocks(ks_from, ks_from, n, a->key, a->key_size, a->rounds);
+        vistrutah_512_encrypt_blocks(ks_to, ks_to, n, b->key, b->key_size, b->rounds);
+
+        size_t take = 64 * n - skip;
+
+        if (take > len) {
+            take = len;
+        }
+        for (size_t j = 0; j < take; j++) {
+            out[j] = in[j] ^ ks_from[skip + j] ^ ks_to[skip + j];
+        }
+        block += n;
+        skip = 0;
+        in += take;
+        out += take;
+        len -= take;
+    }
+    VISTRUTAH_LEAVE(t0, mode, CTR_REENCRYPT);
+}
+
+// Multi-threaded interface. A share covers whole blocks of the data, and
+// blocks mode ignores the offset.
+
+typedef struct {
+    const void*    from;
+    const void*    to;
+    int            ctr;
+    uint64_t       offset;
+    const uint8_t* in;
+    uint8_t*       out;
+} reencrypt_range;
+
+static void
+reencrypt_share(void* arg, size_t first, size_t len)
+{
+    reencrypt_range* r = arg;
+
+    if (r->ctr) {
+        vistrutah_ctr_reencrypt(r->from, r->to, r->offset + first, r->in + first, r->out + first,
+                                len);
+    } else {
+        vistrutah_512_reencrypt_blocks(r->from, r->to, r->in + first, r->out + first, len / 64);
+    }
+}
+
+static void
+reencrypt_parallel(const void* from, const void* to, int ctr, uint64_t offset,
+                   const uint8_t* in, uint8_t* out, size_t len, int threads)
+{
+    reencrypt_range r = { from, to, ctr, offset, in, out };
+
+    vistrutah_parallel_for(len, 64, REENCRYPT_BATCH, threads, reencrypt_share, &r);
+}
+
+void
+vistrutah_512_reencrypt_blocks_parallel(const vistrutah_512_ctx* from, const vistrutah_512_ctx* to,
+                                        const uint8_t* in, uint8_t* out, size_t blocks,
+                                        int threads)
+{
+    reencrypt_parallel(from, to, 0, 0, in, out, 64 * blocks, threads);
+}
+
+void
+vistrutah_ctr_reencrypt_parallel(const vistrutah_ctr_ctx* from, const vistrutah_ctr_ctx* to,
+                                 uint64_t offset, const uint8_t* in, uint8_t* out, size_t len,
+                                 int threads)
+{
+    reencrypt_parallel(from, to, 1, offset, in, out, len, threads);
+}
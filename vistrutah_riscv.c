@@ -0,0 +1,348 @@
+#define VISTRUTAH_BACKEND
+
+#include "vistrutah.h"
+
+#ifdef VISTRUTAH_RISCV
+
+#    include <riscv_vector.h>
+#    include <string.h>
+
+extern const uint8_t ROUND_CONSTANTS[16 * 48];
+extern const uint8_t VISTRUTAH_P4[16];
+extern const uint8_t VISTRUTAH_P5[16];
+extern const uint8_t VISTRUTAH_KEXP_SHUFFLE[32];
+
+// Blocks are processed in memory order, as many as fit in an LMUL=4 register
+// group: every 128-bit element group is one AES lane, and the mixing layers
+// are a single vrgatherei16 over the whole group. VLEN >= 128 (required by
+// Zvkned) makes the group a multiple of 64 bytes, so a group never splits a
+// block.
+
+// Byte permutations of the mixing layers, as out[i] = in[perm[i]]
+static const uint8_t asura[32] = { 0,  2,  4,  6,  8,  10, 12, 14, 16, 18, 20,
+                                   22, 24, 26, 28, 30, 1,  3,  5,  7,  9,  11,
+                                   13, 15, 17, 19, 21, 23, 25, 27, 29, 31 };
+
+static const uint8_t asura_inv[32] = { 0, 16, 1, 17, 2,  18, 3,  19, 4,  20, 5,
+                                       21, 6, 22, 7, 23, 8, 24, 9, 25, 10, 26,
+                                       11, 27, 12, 28, 13, 29, 14, 30, 15, 31 };
+
+static const uint8_t vzip[64] = { 0,  16, 32, 48, 1,  17, 33, 49, 2,  18, 34, 50, 3,  19, 35, 51,
+                                  8,  24, 40, 56, 9,  25, 41, 57, 10, 26, 42, 58, 11, 27, 43, 59,
+                                  4,  20, 36, 52, 5,  21, 37, 53, 6,  22, 38, 54, 7,  23, 39, 55,
+                                  12, 28, 44, 60, 13, 29, 45, 61, 14, 30, 46, 62, 15, 31, 47, 63 };
+
+static const uint8_t vunzip[64] = { 0, 4, 8,  12, 32, 36, 40, 44, 16, 20, 24, 28, 48, 52, 56, 60,
+                                    1, 5, 9,  13, 33, 37, 41, 45, 17, 21, 25, 29, 49, 53, 57, 61,
+                                    2, 6, 10, 14, 34, 38, 42, 46, 18, 22, 26, 30, 50, 54, 58, 62,
+                                    3, 7, 11, 15, 35, 39, 43, 47, 19, 23, 27, 31, 51, 55, 59, 63 };
+
+bool
+vistrutah_has_aes_accel(void)
+{
+    return true;
+}
+
+const char* const vistrutah_impl_name = "RISC-V Vector+Zvkned";
+
+const char*
+vistrutah_get_impl_name(void)
+{
+    return vistrutah_impl_name;
+}
+
+// Key sets: fixed key, then the round key of each step 0..steps, with the
+// round constant already applied.
+static void
+round_keys_256(uint8_t* lane_keys, const uint8_t* key, int key_size, int steps)
+{
+    uint8_t fixed_key[32];
+    uint8_t round_key[32];
+    uint8_t temp[16];
+
+    if (key_size == 16) {
+        memcpy(fixed_key, key, 16);
+        memcpy(fixed_key + 16, key, 16);
+    } else {
+        memcpy(fixed_key, key, 32);
+    }
+
+    memcpy(round_key, fixed_key + 16, 16);
+    memcpy(round_key + 16, fixed_key, 16);
+    memcpy(lane_keys, fixed_key, 32);
+    memcpy(lane_keys + 32, round_key, 32);
+
+    for (int i = 1; i <= steps; i++) {
+        memcpy(temp, round_key, 16);
+        for (int j = 0; j < 16; j++) {
+            round_key[j] = temp[VISTRUTAH_P4[j]];
+        }
+        memcpy(temp, round_key + 16, 16);
+        for (int j = 0; j < 16; j++) {
+            round_key[16 + j] = temp[VISTRUTAH_P5[j]];
+        }
+
+        uint8_t* rk = lane_keys + 32 * (i + 1);
+        memcpy(rk, round_key, 32);
+        if (i < steps) {
+            for (int j = 0; j < 16; j++) {
+                rk[j] ^= ROUND_CONSTANTS[16 * (i - 1) + j];
+            }
+        }
+    }
+}
+
+static void
+round_keys_512(uint8_t* lane_keys, const uint8_t* key, int key_size, int steps)
+{
+    static const int shifts[4] = { 5, 10, 5, 10 };
+    uint8_t          fixed_key[64];
+    uint8_t          round_key[64];
+    uint8_t          temp[32];
+
+    if (key_size == 32) {
+        memcpy(fixed_key, key, 32);
+        memcpy(fixed_key + 32, key, 32);
+    } else {
+        memcpy(fixed_key, key, 64);
+    }
+
+    memcpy(temp, fixed_key + 32, 32);
+    for (int i = 0; i < 32; i++) {
+        fixed_key[32 + i] = temp[VISTRUTAH_KEXP_SHUFFLE[i]];
+    }
+
+    memcpy(round_key, fixed_key + 16, 16);
+    memcpy(round_key + 16, fixed_key, 16);
+    memcpy(round_key + 32, fixed_key + 48, 16);
+    memcpy(round_key + 48, fixed_key + 32, 16);
+    memcpy(lane_keys, fixed_key, 64);
+    memcpy(lane_keys + 64, round_key, 64);
+
+    for (int i = 1; i <= steps; i++) {
+        for (int l = 0; l < 4; l++) {
+            memcpy(temp, round_key + 16 * l, 16);
+            for (int j = 0; j < 16; j++) {
+                round_key[16 * l + j] = temp[(j + shifts[l]) % 16];
+            }
+        }
+
+        uint8_t* rk = lane_keys + 64 * (i + 1);
+        memcpy(rk, round_key, 64);
+        if (i < steps) {
+            for (int j = 0; j < 16; j++) {
+                rk[j] ^= ROUND_CONSTANTS[16 * (i - 1) + j];
+            }
+        }
+    }
+}
+
+// Replicate the per-block key sets and the mixing permutation over `span`
+// bytes, the largest register group a call will use.
+static void
+expand_tables(uint8_t* keys, uint16_t* idx, const uint8_t* lane_keys, int nkeys,
+              const uint8_t* perm, size_t block_size, size_t span)
+{
+    for (int k = 0; k < nkeys; k++) {
+        for (size_t p = 0; p < span; p++) {
+            keys[k * span + p] = lane_keys[k * block_size + p % block_size];
+        }
+    }
+    for (size_t p = 0; p < span; p++) {
+        idx[p] = (uint16_t) (p - p % block_size + perm[p % block_size]);
+    }
+}
+
+#    define KEY(k) __riscv_vle32_v_u32m4(keys + (k) * (span / 4), vl32)
+
+static inline vuint32m4_t
+mixing_layer(vuint32m4_t x, vuint16m8_t idx, size_t vl)
+{
+    vuint8m4_t b = __riscv_vreinterpret_v_u32m4_u8m4(x);
+
+    return __riscv_vreinterpret_v_u8m4_u32m4(__riscv_vrgatherei16_vv_u8m4(b, idx, vl));
+}
+
+// Vector length for the next group: whole blocks, at most one register
+// group. vsetvl itself may split an AVL between VLMAX and 2 * VLMAX evenly,
+// which would leave a block straddling two iterations.
+static inline size_t
+group_vl(size_t remaining, size_t vlmax, size_t block_size)
+{
+    size_t avl = remaining < vlmax ? remaining : vlmax;
+
+    return __riscv_vsetvl_e8m4(avl - avl % block_size);
+}
+
+static void
+encrypt_blocks(const uint8_t* in, uint8_t* out, size_t nbytes, uint8_t* lane_keys,
+               const uint8_t* perm, size_t block_size, int steps)
+{
+    if (nbytes == 0) {
+        return;
+    }
+
+    size_t   vlmax = __riscv_vsetvlmax_e8m4();
+    size_t   span  = nbytes < vlmax ? nbytes : vlmax;
+    uint32_t keys[(steps + 2) * (span / 4)];
+    uint16_t perm_idx[span];
+    uint8_t  temp[64];
+
+    // The key added after a mixing layer is moved in front of it, into the
+    // vaesem that precedes the layer: mix(y) ^ k == mix(y ^ mix^-1(k))
+    for (int i = 1; i < steps; i++) {
+        uint8_t* rk = lane_keys + block_size * (i + 1);
+
+        for (size_t j = 0; j < block_size; j++) {
+            temp[perm[j]] = rk[j];
+        }
+        memcpy(rk, temp, block_size);
+    }
+    expand_tables((uint8_t*) keys, perm_idx, lane_keys, steps + 2, perm, block_size, span);
+
+    size_t      vl32 = span / 4;
+    vuint16m8_t idx  = __riscv_vle16_v_u16m8(perm_idx, span);
+    vuint32m4_t fk   = KEY(0);
+
+    for (size_t off = 0; off < nbytes;) {
+        size_t vl = group_vl(nbytes - off, vlmax, block_size);
+
+        vl32          = vl / 4;
+        vuint32m4_t x = __riscv_vreinterpret_v_u8m4_u32m4(__riscv_vle8_v_u8m4(in + off, vl));
+
+        x = __riscv_vxor_vv_u32m4(x, KEY(1), vl32);
+        x = __riscv_vaesem_vv_u32m4(x, fk, vl32);
+
+        for (int i = 1; i < steps; i++) {
+            x = __riscv_vaesem_vv_u32m4(x, KEY(i + 1), vl32);
+            x = mixing_layer(x, idx, vl);
+            x = __riscv_vaesem_vv_u32m4(x, fk, vl32);
+        }
+
+        x = __riscv_vaesef_vv_u32m4(x, KEY(steps + 1), vl32);
+
+        __riscv_vse8_v_u8m4(out + off, __riscv_vreinterpret_v_u32m4_u8m4(x), vl);
+        off += vl;
+    }
+}
+
+static void
+decrypt_blocks(const uint8_t* in, uint8_t* out, size_t nbytes, const uint8_t* lane_keys,
+               const uint8_t* perm, size_t block_size, int steps)
+{
+    if (nbytes == 0) {
+        return;
+    }
+
+    size_t   vlmax = __riscv_vsetvlmax_e8m4();
+    size_t   span  = nbytes < vlmax ? nbytes : vlmax;
+    uint32_t keys[(steps + 2) * (span / 4)];
+    uint16_t perm_idx[span];
+
+    expand_tables((uint8_t*) keys, perm_idx, lane_keys, steps + 2, perm, block_size, span);
+
+    size_t      vl32 = span / 4;
+    vuint16m8_t idx  = __riscv_vle16_v_u16m8(perm_idx, span);
+    vuint32m4_t fk   = KEY(0);
+    vuint32m4_t zero = __riscv_vmv_v_x_u32m4(0, vl32);
+
+    // vaesdm applies InvMixColumns after AddRoundKey, so it takes the fixed
+    // key as is. The InvMixColumns of the state after the inverse mixing
+    // layer has no instruction of its own: it is done as vaesdm(vaesef(x)).
+    for (size_t off = 0; off < nbytes;) {
+        size_t vl = group_vl(nbytes - off, vlmax, block_size);
+
+        vl32          = vl / 4;
+        vuint32m4_t x = __riscv_vreinterpret_v_u8m4_u32m4(__riscv_vle8_v_u8m4(in + off, vl));
+
+        x = __riscv_vxor_vv_u32m4(x, KEY(steps + 1), vl32);
+        x = __riscv_vaesdm_vv_u32m4(x, fk, vl32);
+
+        for (int i = steps - 1; i > 0; i--) {
+            x = __riscv_vaesdf_vv_u32m4(x, KEY(i + 1), vl32);
+            x = mixing_layer(x, idx, vl);
+            x = __riscv_vaesef_vv_u32m4(x, zero, vl32);
+            x = __riscv_vaesdm_vv_u32m4(x, zero, vl32);
+            x = __riscv_vaesdm_vv_u32m4(x, fk, vl32);
+        }
+
+        x = __riscv_vaesdf_vv_u32m4(x, KEY(1), vl32);
+
+        __riscv_vse8_v_u8m4(out + off, __riscv_vreinterpret_v_u32m4_u8m4(x), vl);
+        off += vl;
+    }
+}
+
+void
+vistrutah_256_encrypt_blocks(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    int     steps = rounds / ROUNDS_PER_STEP;
+    uint8_t lane_keys[(steps + 2) * 32];
+
+    round_keys_256(lane_keys, key, key_size, steps);
+    encrypt_blocks(plaintext, ciphertext, blocks * 32, lane_keys, asura, 32, steps);
+}
+
+void
+vistrutah_256_decrypt_blocks(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    int     steps = rounds / ROUNDS_PER_STEP;
+    uint8_t lane_keys[(steps + 2) * 32];
+
+    round_keys_256(lane_keys, key, key_size, steps);
+    decrypt_blocks(ciphertext, plaintext, blocks * 32, lane_keys, asura_inv, 32, steps);
+}
+
+void
+vistrutah_512_encrypt_blocks(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    int     steps = rounds / ROUNDS_PER_STEP;
+    uint8_t lane_keys[(steps + 2) * 64];
+
+    round_keys_512(lane_keys, key, key_size, steps);
+    encrypt_blocks(plaintext, ciphertext, blocks * 64, lane_keys, vzip, 64, steps);
+}
+
+void
+vistrutah_512_decrypt_blocks(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    int     steps = rounds / ROUNDS_PER_STEP;
+    uint8_t lane_keys[(steps + 2) * 64];
+
+    round_keys_512(lane_keys, key, key_size, steps);
+    decrypt_blocks(ciphertext, plaintext, blocks * 64, lane_keys, vunzip, 64, steps);
+}
+
+void
+vistrutah_256_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8_t* key,
+                      int key_size, int rounds)
+{
+    vistrutah_256_encrypt_blocks(plaintext, ciphertext, 1, key, key_size, rounds);
+}
+
+void
+vistrutah_256_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key,
+                      int key_size, int rounds)
+{
+    vistrutah_256_decrypt_blocks(ciphertext, plaintext, 1, key, key_size, rounds);
+}
+
+void
+vistrutah_512_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8_t* key,
+                      int key_size, int rounds)
+{
+    vistrutah_512_encrypt_blocks(plaintext, ciphertext, 1, key, key_size, rounds);
+}
+
+void
+vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key,
+                      int key_size, int rounds)
+{
+    vistrutah_512_decrypt_blocks(ciphertext, plaintext, 1, key, key_size, rounds);
+}
+
+#endif
@@ -0,0 +1,307 @@
+#define VISTRUTAH_INTERNAL
+#include "vistrutah.h"
+
+// Deterministic authenticated encryption in the SIV style (RFC 5297), with
+// Vistrutah-512 as both the PRF and the CTR-mode block cipher:
+//
+//   H   = PMAC(AD)
+//   SIV = E_mac(sum_i E_mac(M_i ^ offset_i) ^ last(M) ^ 2*H)
+//   C   = M ^ CTR_enc(SIV)
+//
+// The PRF is PMAC1-like with offsets in GF(2^512) modulo
+// x^512 + x^8 + x^5 + x^2 + 1; a full final block is masked with L_$, a
+// padded one with L_*. Both passes feed VISTRUTAH_SIV_BATCH blocks at a time
+// to the multi-block API and touch each input byte once.
+
+#define SIV_BLOCK_LIMIT ((uint64_t) 1 << VISTRUTAH_SIV_L_COUNT)
+
+static int
+verify_siv(const uint8_t* a, const uint8_t* b)
+{
+    volatile uint8_t d = 0;
+
+    for (int i = 0; i < VISTRUTAH_SIV_BYTES; i++) {
+        d |= a[i] ^ b[i];
+    }
+    return (int) ((1 & ((d - 1) >> 8)) - 1);
+}
+
+int
+vistrutah_siv_init(vistrutah_siv_ctx* ctx, const uint8_t* key, int key_size, int rounds)
+{
+    uint8_t subkeys[2 * 64] = { 0 };
+    uint8_t zero[64]        = { 0 };
+
+    if (key_size != VISTRUTAH_KEY_SIZE_256 && key_size != VISTRUTAH_KEY_SIZE_512) {
+        return -1;
+    }
+    memset(ctx, 0, sizeof *ctx);
+    ctx->key_size = key_size;
+    ctx->rounds   = rounds;
+
+    // Subkeys are the encryptions of two distinct constant blocks
+    subkeys[63]  = 0x01;
+    subkeys[127] = 0x02;
+    vistrutah_512_encrypt_blocks(subkeys, subkeys, 2, key, key_size, rounds);
+    memcpy(ctx->mac_key, subkeys, 64);
+    memcpy(ctx->enc_key, subkeys + 64, 64);
+    vistrutah_secure_zero(subkeys, sizeof subkeys);
+
+    vistrutah_512_encrypt(zero, ctx->L_star, ctx->mac_key, key_size, rounds);
+    vistrutah_gf512_double(ctx->L_dollar, ctx->L_star);
+    vistrutah_gf512_double(ctx->L[0], ctx->L_dollar);
+    for (int i = 1; i < VISTRUTAH_SIV_L_COUNT; i++) {
+        vistrutah_gf512_double(ctx->L[i], ctx->L[i - 1]);
+    }
+    VISTRUTAH_PROBE(key_init, SIV, key_size);
+
+    return 0;
+}
+
+// PRF pass
+
+static void
+mac_blocks(vistrutah_siv_mac_state* st, const uint8_t* data, size_t blocks)
+{
+    const vistrutah_siv_ctx* ctx = st->ctx;
+    uint8_t                  buf[VISTRUTAH_SIV_BATCH * 64];
+
+    if (st->blocks >= SIV_BLOCK_LIMIT || SIV_BLOCK_LIMIT - st->blocks <= blocks) {
+        st->blocks = SIV_BLOCK_LIMIT;
+        return;
+    }
+    while (blocks > 0) {
+        size_t n = blocks < VISTRUTAH_SIV_BATCH ? blocks : VISTRUTAH_SIV_BATCH;
+
+        for (size_t j = 0; j < n; j++) {
+            st->blocks++;
+            vistrutah_xor_block(st->offset, st->offset, ctx->L[__builtin_ctzll(st->blocks)]);
+            vistrutah_xor_block(buf + 64 * j, data + 64 * j, st->offset);
+        }
+        vistrutah_512_encrypt_blocks(buf, buf, n, ctx->mac_key, ctx->key_size, ctx->rounds);
+        for (size_t j = 0; j < n; j++) {
+            vistrutah_xor_block(st->sum, st->sum, buf + 64 * j);
+        }
+        data += 64 * n;
+        blocks -= n;
+    }
+}
+
+static void
+mac_reset(vistrutah_siv_mac_state* st, const vistrutah_siv_ctx* ctx)
+{
+    st->ctx = ctx;
+    memset(st->offset, 0, 64);
+    memset(st->sum, 0, 64);
+    st->buf_len = 0;
+    st->blocks  = 0;
+}
+
+void
+vistrutah_siv_mac_update(vistrutah_siv_mac_state* st, const uint8_t* data, size_t len)
+{
+    // The final block is masked differently, so at least one byte is always
+    // held back until vistrutah_siv_mac_final()
+    while (len > 0) {
+        if (st->buf_len == sizeof st->buf) {
+            mac_blocks(st, st->buf, VISTRUTAH_SIV_BATCH);
+            st->buf_len = 0;
+        }
+        if (st->buf_len == 0 && len > sizeof st->buf) {
+            size_t blocks = (len - 1) / 64;
+
+            mac_blocks(st, data, blocks);
+            data += 64 * blocks;
+            len -= 64 * blocks;
+            continue;
+        }
+
+        size_t n = sizeof st->buf - st->buf_len;
+
+        if (n > len) {
+            n = len;
+        }
+        memcpy(st->buf + st->buf_len, data, n);
+        st->buf_len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static void
+mac_finish(vistrutah_siv_mac_state* st, uint8_t* out)
+{
+    const vistrutah_siv_ctx* ctx  = st->ctx;
+    size_t                   full = st->buf_len > 0 ? (st->buf_len - 1) / 64 : 0;
+    size_t                   rem  = st->buf_len - 64 * full;
+    uint8_t                  last[64];
+
+    mac_blocks(st, st->buf, full);
+
+    if (rem == 64) {
+        vistrutah_xor_block(last, st->buf + 64 * full, ctx->L_dollar);
+    } else {
+        memset(last, 0, 64);
+        memcpy(last, st->buf + 64 * full, rem);
+        last[rem] = 0x80;
+        vistrutah_xor_block(last, last, ctx->L_star);
+    }
+    vistrutah_xor_block(st->sum, st->sum, last);
+    vistrutah_xor_block(st->sum, st->sum, st->ad_hash);
+    vistrutah_512_encrypt(st->sum, out, ctx->mac_key, ctx->key_size, ctx->rounds);
+}
+
+void
+vistrutah_siv_mac_init(vistrutah_siv_mac_state* st, const vistrutah_siv_ctx* ctx,
+                       const uint8_t* ad, size_t ad_len)
+{
+    uint8_t h[64];
+
+    mac_reset(st, ctx);
+    memset(st->ad_hash, 0, 64);
+    vistrutah_siv_mac_update(st, ad, ad_len);
+    mac_finish(st, h);
+
+    if (st->blocks >= SIV_BLOCK_LIMIT) {
+        return;
+    }
+    mac_reset(st, ctx);
+    vistrutah_gf512_double(st->ad_hash, h);
+}
+
+int
+vistrutah_siv_mac_final(vistrutah_siv_mac_state* st, uint8_t* siv)
+{
+    if (st->blocks >= SIV_BLOCK_LIMIT) {
+        return -1;
+    }
+    mac_finish(st, siv);
+    if (st->blocks >= SIV_BLOCK_LIMIT) {
+        return -1;
+    }
+    return 0;
+}
+
+int
+vistrutah_siv_mac_verify(vistrutah_siv_mac_state* st, const uint8_t* siv)
+{
+    uint8_t computed[VISTRUTAH_SIV_BYTES];
+
+    if (vistrutah_siv_mac_final(st, computed) != 0) {
+        return -1;
+    }
+    return verify_siv(computed, siv);
+}
+
+// CTR pass
+
+void
+vistrutah_siv_ctr_init(vistrutah_siv_ctr_state* st, const vistrutah_siv_ctx* ctx,
+                       const uint8_t* siv)
+{
+    st->ctx = ctx;
+    memcpy(st->iv, siv, 64);
+    st->counter       = 0;
+    st->keystream_pos = 0;
+    st->keystream_len = 0;
+}
+
+static void
+ctr_refill(vistrutah_siv_ctr_state* st, size_t blocks)
+{
+    const vistrutah_siv_ctx* ctx = st->ctx;
+
+    // Counter block i is the SIV with i added to its last 64 bits
+    for (size_t j = 0; j < blocks; j++) {
+        uint8_t* block = st->keystream + 64 * j;
+        uint64_t c     = st->counter++;
+        unsigned carry = 0;
+
+        memcpy(block, st->iv, 64);
+        for (int k = 63; k >= 56; k--) {
+            unsigned t = block[k] + (unsigned) (c & 0xff) + carry;
+
+            block[k] = (uint8_t) t;
+            carry    = t >> 8;
+            c >>= 8;
+        }
+    }
+    vistrutah_512_encrypt_blocks(st->keystream, st->keystream, blocks, ctx->enc_key,
+                                 ctx->key_size, ctx->rounds);
+    st->keystream_pos = 0;
+    st->keystream_len = 64 * blocks;
+}
+
+void
+vistrutah_siv_ctr_update(vistrutah_siv_ctr_state* st, const uint8_t* in, uint8_t* out,
+                         size_t len)
+{
+    while (len > 0) {
+        if (st->keystream_pos == st->keystream_len) {
+            size_t blocks = (len + 63) / 64;
+
+            ctr_refill(st, blocks < VISTRUTAH_SIV_BATCH ? blocks : VISTRUTAH_SIV_BATCH);
+        }
+
+        size_t         n  = st->keystream_len - st->keystream_pos;
+        const uint8_t* ks = st->keystream + st->keystream_pos;
+
+        if (n > len) {
+            n = len;
+        }
+        for (size_t i = 0; i < n; i++) {
+            out[i] = in[i] ^ ks[i];
+        }
+        st->keystream_pos += n;
+        in += n;
+        out += n;
+        len -= n;
+    }
+}
+
+// One-shot interface
+
+int
+vistrutah_siv_encrypt(const vistrutah_siv_ctx* ctx, const uint8_t* plaintext,
+                      uint8_t* ciphertext, size_t len, const uint8_t* ad, size_t ad_len,
+                      uint8_t* siv)
+{
+    vistrutah_siv_mac_state mac;
+    vistrutah_siv_ctr_state ctr;
+
+    VISTRUTAH_ENTER(t0, mode, SIV_ENCRYPT, len);
+    vistrutah_siv_mac_init(&mac, ctx, ad, ad_len);
+    vistrutah_siv_mac_update(&mac, plaintext, len);
+    if (vistrutah_siv_mac_final(&mac, siv) != 0) {
+        VISTRUTAH_LEAVE(t0, mode, SIV_ENCRYPT);
+        return -1;
+    }
+    vistrutah_siv_ctr_init(&ctr, ctx, siv);
+    vistrutah_siv_ctr_update(&ctr, plaintext, ciphertext, len);
+    VISTRUTAH_LEAVE(t0, mode, SIV_ENCRYPT);
+
+    return 0;
+}
+
+int
+vistrutah_siv_decrypt(const vistrutah_siv_ctx* ctx, const uint8_t* ciphertext,
+                      uint8_t* plaintext, size_t len, const uint8_t* ad, size_t ad_len,
+                      const uint8_t* siv)
+{
+    vistrutah_siv_mac_state mac;
+    vistrutah_siv_ctr_state ctr;
+
+    VISTRUTAH_ENTER(t0, mode, SIV_DECRYPT, len);
+    vistrutah_siv_ctr_init(&ctr, ctx, siv);
+    vistrutah_siv_ctr_update(&ctr, ciphertext, plaintext, len);
+
+    vistrutah_siv_mac_init(&mac, ctx, ad, ad_len);
+    vistrutah_siv_mac_update(&mac, plaintext, len);
+    if (vistrutah_siv_mac_verify(&mac, siv) != 0) {
+        memset(plaintext, 0, len);
+        VISTRUTAH_LEAVE(t0, mode, SIV_DECRYPT);
+        return -1;
+    }
+    VISTRUTAH_LEAVE(t0, mode, SIV_DECRYPT);
+    return 0;
+}
@@ -0,0 +1,389 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "vistrutah.h"
+
+#ifdef VISTRUTAH_STATS
+
+#    include <pthread.h>
+#    include <stdatomic.h>
+#    include <stdlib.h>
+#    include <time.h>
+
+// Per-entry-point statistics. Every thread gets its own block on first use,
+// linked into a global list so that snapshots can sum them. The owner is
+// the only writer of its counters; it updates them with relaxed atomic
+// loads and stores, which compile to plain moves, so readers see whole
+// values without a locked instruction on the hot path. When a thread
+// exits, its counts are folded into `retired` and the block is freed.
+//
+// A reset only bumps `generation`; each owner clears its own counters when
+// it next records a call under a new generation, and until then snapshots
+// leave the block out. No other thread ever stores to the counters.
+
+typedef struct thread_stats {
+    vistrutah_stats      stats;
+    size_t               bytes;
+    unsigned             depth;
+    unsigned             tick;
+    _Atomic unsigned     generation;
+    struct thread_stats* next;
+} thread_stats;
+
+static _Thread_local thread_stats* local;
+
+static pthread_mutex_t  registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static thread_stats*    registry;
+static vistrutah_stats  retired;
+static _Atomic unsigned generation;
+static pthread_key_t   exit_key;
+static pthread_once_t  exit_key_once = PTHREAD_ONCE_INIT;
+
+static const char* const entry_names[VISTRUTAH_STAT_ENTRIES] = {
+    "256_encrypt",         "256_decrypt",         "512_encrypt",         "512_decrypt",
+    "256_encrypt_blocks",  "256_decrypt_blocks",  "512_encrypt_blocks",  "512_decrypt_blocks",
+    "256_encrypt_strided", "256_decrypt_strided", "512_encrypt_strided", "512_decrypt_strided",
+    "256_encrypt_ptrs",    "256_decrypt_ptrs",    "512_encrypt_ptrs",    "512_decrypt_ptrs",
+    "256_encrypt_stream",  "256_decrypt_stream",  "512_encrypt_stream",  "512_decrypt_stream",
+    "256_encrypt_crc32c",  "256_decrypt_crc32c",  "512_encrypt_crc32c",  "512_decrypt_crc32c",
+    "512_reencrypt",       "ctr_xor",             "ctr_reencrypt",       "ocb_encrypt",
+    "ocb_decrypt",         "siv_encrypt",         "siv_decrypt",         "hash",
+    "hash_update",         "hash_final",          "hash_many",           "xof",
+    "xof_absorb",          "xof_squeeze",         "512_permute",         "deck_absorb",
+    "deck_squeeze",        "kdf_derive",          "keywrap_wrap",        "keywrap_unwrap",
+    "mb_dispatch",
+};
+
+#    if defined(VISTRUTAH_INTEL)
+#        define COUNTER_NAME "rdtsc"
+
+static inline uint64_t
+read_counter(void)
+{
+    return __rdtsc();
+}
+#    elif defined(__aarch64__)
+#        define COUNTER_NAME "cntvct"
+
+static inline uint64_t
+read_counter(void)
+{
+    uint64_t t;
+
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(t));
+    return t;
+}
+#    else
+#        define COUNTER_NAME "ns"
+
+static inline uint64_t
+read_counter(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+#    endif
+
+static inline void
+add(uint64_t* counter, uint64_t v)
+{
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + v, __ATOMIC_RELAXED);
+}
+
+static void
+add_all(vistrutah_stats* into, const vistrutah_stats* from)
+{
+    const uint64_t* src = (const uint64_t*) from;
+    uint64_t*       dst = (uint64_t*) into;
+
+    for (size_t i = 0; i < sizeof *from / sizeof(uint64_t); i++) {
+        dst[i] += __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+    }
+}
+
+static void
+thread_exit(void* arg)
+{
+    thread_stats* ts = arg;
+
+    pthread_mutex_lock(&registry_lock);
+    for (thread_stats** p = &registry; *p != NULL; p = &(*p)->next) {
+        if (*p == ts) {
+            *p = ts->next;
+            break;
+        }
+    }
+    if (atomic_load_explicit(&ts->generation, memory_order_relaxed) ==
+        atomic_load_explicit(&generation, memory_order_relaxed)) {
+        add_all(&retired, &ts->stats);
+    }
+    pthread_mutex_unlock(&registry_lock);
+    local = NULL;
+    free(ts);
+}
+
+static void
+create_exit_key(void)
+{
+    pthread_key_create(&exit_key, thread_exit);
+}
+
+// Kept out of line so that the wrappers only pay for it once per thread
+static __attribute__((cold, noinline)) thread_stats*
+register_thread(void)
+{
+    thread_stats* ts = calloc(1, sizeof *ts);
+
+    if (ts == NULL) {
+        return NULL;
+    }
+    pthread_once(&exit_key_once, create_exit_key);
+    pthread_setspecific(exit_key, ts);
+
+    pthread_mutex_lock(&registry_lock);
+    atomic_init(&ts->generation, atomic_load_explicit(&generation, memory_order_relaxed));
+    ts->next = registry;
+    registry = ts;
+    pthread_mutex_unlock(&registry_lock);
+
+    local = ts;
+    return ts;
+}
+
+uint64_t
+vistrutah_stats_begin(size_t bytes)
+{
+    thread_stats* ts = local;
+
+    if (ts == NULL && (ts = register_thread()) == NULL) {
+        return 0;
+    }
+    if (ts->depth++ != 0) {
+        return 0;
+    }
+    ts->bytes = bytes;
+    if (bytes < VISTRUTAH_STATS_TIME_BYTES && ts->tick++ % VISTRUTAH_STATS_SAMPLE != 0) {
+        return 0;
+    }
+    return read_counter();
+}
+
+void
+vistrutah_stats_end(uint64_t start, vistrutah_stat_entry entry)
+{
+    thread_stats* ts = local;
+
+    if (ts == NULL || --ts->depth != 0) {
+        return;
+    }
+
+    vistrutah_stat* s   = &ts->stats.entries[entry];
+    unsigned        gen = atomic_load_explicit(&generation, memory_order_acquire);
+
+    // Catch up with a reset: the counters are cleared before the new
+    // generation is published, so snapshots never see stale counts
+    if (atomic_load_explicit(&ts->generation, memory_order_relaxed) != gen) {
+        memset(&ts->stats, 0, sizeof ts->stats);
+        atomic_store_explicit(&ts->generation, gen, memory_order_release);
+    }
+    add(&s->calls, 1);
+    add(&s->bytes, ts->bytes);
+
+    // Everything else is per timed call, so untimed calls stop here
+    if (start != 0) {
+        uint64_t cycles = read_counter() - start;
+        int      bucket = 63 - __builtin_clzll(cycles | 1);
+        int      size   = 0;
+
+        for (uint64_t limit = 64; ts->bytes > limit && size < VISTRUTAH_STATS_SIZES - 1;
+             limit <<= 2) {
+            size++;
+        }
+        if (bucket >= VISTRUTAH_STATS_BUCKETS) {
+            bucket = VISTRUTAH_STATS_BUCKETS - 1;
+        }
+        add(&s->timed, 1);
+        add(&s->cycles, cycles);
+        add(&s->size_timed[size], 1);
+        add(&s->size_cycles[size], cycles);
+        add(&s->histogram[bucket], 1);
+    }
+}
+
+void
+vistrutah_stats_snapshot(vistrutah_stats* stats)
+{
+    memset(stats, 0, sizeof *stats);
+
+    pthread_mutex_lock(&registry_lock);
+    add_all(stats, &retired);
+    for (thread_stats* ts = registry; ts != NULL; ts = ts->next) {
+        if (atomic_load_explicit(&ts->generation, memory_order_acquire) ==
+            atomic_load_explicit(&generation, memory_order_relaxed)) {
+            add_all(stats, &ts->stats);
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
+
+void
+vistrutah_stats_merge(vistrutah_stats* into, const vistrutah_stats* from)
+{
+    add_all(into, from);
+}
+
+void
+vistrutah_stats_reset(void)
+{
+    pthread_mutex_lock(&registry_lock);
+    memset(&retired, 0, sizeof retired);
+    atomic_fetch_add_explicit(&generation, 1, memory_order_release);
+    pthread_mutex_unlock(&registry_lock);
+}
+
+const char*
+vistrutah_stats_entry_name(vistrutah_stat_entry entry)
+{
+    if ((unsigned) entry >= VISTRUTAH_STAT_ENTRIES) {
+        return NULL;
+    }
+    return entry_names[entry];
+}
+
+static void
+write_array(FILE* out, const char* name, const uint64_t* v, int n)
+{
+    fprintf(out, ", \"%s\": [", name);
+    for (int i = 0; i < n; i++) {
+        fprintf(out, "%s%llu", i > 0 ? ", " : "", (unsigned long long) v[i]);
+    }
+    fprintf(out, "]");
+}
+
+// One object per entry point that has been called. The size arrays are
+// indexed by size class, with the class limits in "size_limits" (0 for
+// unbounded); trailing empty histogram buckets are left out.
+int
+vistrutah_stats_write_json(const vistrutah_stats* stats, FILE* out)
+{
+    uint64_t limits[VISTRUTAH_STATS_SIZES];
+    int      first = 1;
+
+    for (int i = 0; i < VISTRUTAH_STATS_SIZES; i++) {
+        limits[i] = i < VISTRUTAH_STATS_SIZES - 1 ? (uint64_t) 64 << (2 * i) : 0;
+    }
+
+    fprintf(out, "{\"impl\": \"%s\", \"counter\": \"%s\", \"sample\": %d, \"time_bytes\": %d",
+            vistrutah_get_impl_name(), COUNTER_NAME, VISTRUTAH_STATS_SAMPLE,
+            VISTRUTAH_STATS_TIME_BYTES);
+    write_array(out, "size_limits", limits, VISTRUTAH_STATS_SIZES);
+    fprintf(out, ", \"entries\": {");
+
+    for (int e = 0; e < VISTRUTAH_STAT_ENTRIES; e++) {
+        const vistrutah_stat* s       = &stats->entries[e];
+        int                   buckets = VISTRUTAH_STATS_BUCKETS;
+
+        if (s->calls == 0) {
+            continue;
+        }
+        while (buckets > 0 && s->histogram[buckets - 1] == 0) {
+            buckets--;
+        }
+        fprintf(out, "%s\n  \"%s\": {\"calls\": %llu, \"bytes\": %llu, \"timed\": %llu, "
+                "\"cycles\": %llu",
+                first ? "" : ",", entry_names[e], (unsigned long long) s->calls,
+                (unsigned long long) s->bytes, (unsigned long long) s->timed,
+                (unsigned long long) s->cycles);
+        write_array(out, "size_timed", s->size_timed, VISTRUTAH_STATS_SIZES);
+        write_array(out, "size_cycles", s->size_cycles, VISTRUTAH_STATS_SIZES);
+        write_array(out, "histogram", s->histogram, buckets);
+        fprintf(out, "}");
+        first = 0;
+    }
+    fprintf(out, "%s}}\n", first ? "" : "\n");
+
+    return ferror(out) ? -1 : 0;
+}
+
+// Single-block entry points; the backends define the _raw versions
+
+void
+vistrutah_256_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8_t* key,
+                      int key_size, int rounds)
+{
+    VISTRUTAH_STATS_BEGIN(t0, 32);
+    vistrutah_256_encrypt_raw(plaintext, ciphertext, key, key_size, rounds);
+    VISTRUTAH_STATS_END(t0, 256_ENCRYPT);
+}
+
+void
+vistrutah_256_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key,
+                      int key_size, int rounds)
+{
+    VISTRUTAH_STATS_BEGIN(t0, 32);
+    vistrutah_256_decrypt_raw(ciphertext, plaintext, key, key_size, rounds);
+    VISTRUTAH_STATS_END(t0, 256_DECRYPT);
+}
+
+void
+vistrutah_512_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8_t* key,
+                      int key_size, int rounds)
+{
+    VISTRUTAH_STATS_BEGIN(t0, 64);
+    vistrutah_512_encrypt_raw(plaintext, ciphertext, key, key_size, rounds);
+    VISTRUTAH_STATS_END(t0, 512_ENCRYPT);
+}
+
+void
+vistrutah_512_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key,
+                      int key_size, int rounds)
+{
+    VISTRUTAH_STATS_BEGIN(t0, 64);
+    vistrutah_512_decrypt_raw(ciphertext, plaintext, key, key_size, rounds);
+    VISTRUTAH_STATS_END(t0, 512_DECRYPT);
+}
+
+#endif
+
+#ifdef VISTRUTAH_ENTRY_HOOKS
+
+// Multi-block entry points, also wrapped when only the probes are enabled
+
+void
+vistrutah_256_encrypt_blocks(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    VISTRUTAH_ENTER(t0, batch, 256_ENCRYPT_BLOCKS, 32 * blocks);
+    vistrutah_256_encrypt_blocks_raw(plaintext, ciphertext, blocks, key, key_size, rounds);
+    VISTRUTAH_LEAVE(t0, batch, 256_ENCRYPT_BLOCKS);
+}
+
+void
+vistrutah_256_decrypt_blocks(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    VISTRUTAH_ENTER(t0, batch, 256_DECRYPT_BLOCKS, 32 * blocks);
+    vistrutah_256_decrypt_blocks_raw(ciphertext, plaintext, blocks, key, key_size, rounds);
+    VISTRUTAH_LEAVE(t0, batch, 256_DECRYPT_BLOCKS);
+}
+
+void
+vistrutah_512_encrypt_blocks(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    VISTRUTAH_ENTER(t0, batch, 512_ENCRYPT_BLOCKS, 64 * blocks);
+    vistrutah_512_encrypt_blocks_raw(plaintext, ciphertext, blocks, key, key_size, rounds);
+    VISTRUTAH_LEAVE(t0, batch, 512_ENCRYPT_BLOCKS);
+}
+
+void
+vistrutah_512_decrypt_blocks(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                             const uint8_t* key, int key_size, int rounds)
+{
+    VISTRUTAH_ENTER(t0, batch, 512_DECRYPT_BLOCKS, 64 * blocks);
+    vistrutah_512_decrypt_blocks_raw(ciphertext, plaintext, blocks, key, key_size, rounds);
+    VISTRUTAH_LEAVE(t0, batch, 512_DECRYPT_BLOCKS);
+}
+
+#endif
@@ -0,0 +1,115 @@
+#include "vistrutah.h"
+
+// Bulk encryption with non-temporal output stores. Each group of blocks is
+// encrypted into an L1 buffer and then written to the destination with
+// streaming stores, which bypass the cache and skip the read-for-ownership
+// of every output line. This pays off only when the output does not fit in
+// the last-level cache; for smaller buffers the regular calls are faster.
+//
+// Streaming stores use the widest vector available and need a 64-byte
+// aligned destination. Otherwise the group is copied with memcpy, which
+// gives the cached behavior.
+
+#define STREAM_BYTES    4096
+#define STREAM_PREFETCH (4 * STREAM_BYTES)
+
+typedef void (*blocks_fn)(const uint8_t*, uint8_t*, size_t, const uint8_t*, int, int);
+
+// Each loop streams whole vectors while they fit, so a group that is not a
+// multiple of the widest vector (an odd number of 256-bit blocks) finishes
+// with narrower stores instead of writing past the end of out
+static inline void
+store_group(uint8_t* out, const uint8_t* buf, size_t bytes, bool stream)
+{
+    size_t i = 0;
+
+    if (stream) {
+#if defined(__AVX512F__)
+        for (; i + 64 <= bytes; i += 64) {
+            _mm512_stream_si512((void*) (out + i), _mm512_load_si512(buf + i));
+        }
+#endif
+#if defined(__AVX__)
+        for (; i + 32 <= bytes; i += 32) {
+            __m256i v = _mm256_load_si256((const __m256i*) (buf + i));
+
+            _mm256_stream_si256((__m256i*) (out + i), v);
+        }
+#endif
+#if defined(__SSE2__)
+        for (; i + 16 <= bytes; i += 16) {
+            _mm_stream_si128((__m128i*) (out + i), _mm_load_si128((const __m128i*) (buf + i)));
+        }
+#endif
+    }
+    memcpy(out + i, buf + i, bytes - i);
+}
+
+static void
+crypt_stream(blocks_fn fn, size_t block_size, const uint8_t* key, int key_size, int rounds,
+             const uint8_t* in, uint8_t* out, size_t blocks)
+{
+    uint8_t buf[STREAM_BYTES] __attribute__((aligned(64)));
+    size_t  group  = STREAM_BYTES / block_size;
+    size_t  total  = blocks * block_size;
+    bool    stream = ((uintptr_t) out & 63) == 0;
+
+    for (size_t i = 0; i < blocks;) {
+        size_t n     = blocks - i < group ? blocks - i : group;
+        size_t bytes = n * block_size;
+        size_t pos   = i * block_size;
+
+        for (size_t p = pos + STREAM_PREFETCH; p < pos + STREAM_PREFETCH + bytes && p < total;
+             p += 64) {
+            __builtin_prefetch(in + p, 0, 0);
+        }
+        fn(in + pos, buf, n, key, key_size, rounds);
+        store_group(out + pos, buf, bytes, stream);
+        i += n;
+    }
+
+#if defined(__SSE2__)
+    // Make the weakly-ordered stores visible before returning
+    _mm_sfence();
+#endif
+}
+
+void
+vistrutah_256_encrypt_blocks_stream(const vistrutah_256_ctx* ctx, const uint8_t* in, uint8_t* out,
+                                    size_t blocks)
+{
+    VISTRUTAH_ENTER(t0, batch, 256_ENCRYPT_STREAM, 32 * blocks);
+    crypt_stream(vistrutah_256_encrypt_blocks, 32, ctx->key, ctx->key_size, ctx->rounds, in, out,
+                 blocks);
+    VISTRUTAH_LEAVE(t0, batch, 256_ENCRYPT_STREAM);
+}
+
+void
+vistrutah_256_decrypt_blocks_stream(const vistrutah_256_ctx* ctx, const uint8_t* in, uint8_t* out,
+                                    size_t blocks)
+{
+    VISTRUTAH_ENTER(t0, batch, 256_DECRYPT_STREAM, 32 * blocks);
+    crypt_stream(vistrutah_256_decrypt_blocks, 32, ctx->key, ctx->key_size, ctx->rounds, in, out,
+                 blocks);
+    VISTRUTAH_LEAVE(t0, batch, 256_DECRYPT_STREAM);
+}
+
+void
+vistrutah_512_encrypt_blocks_stream(const vistrutah_512_ctx* ctx, const uint8_t* in, uint8_t* out,
+                                    size_t blocks)
+{
+    VISTRUTAH_ENTER(t0, batch, 512_ENCRYPT_STREAM, 64 * blocks);
+    crypt_stream(vistrutah_512_encrypt_blocks, 64, ctx->key, ctx->key_size, ctx->rounds, in, out,
+                 blocks);
+    VISTRUTAH_LEAVE(t0, batch, 512_ENCRYPT_STREAM);
+}
+
+void
+vistrutah_512_decrypt_blocks_stream(const vistrutah_512_ctx* ctx, const uint8_t* in, uint8_t* out,
+                                    size_t blocks)
+{
+    VISTRUTAH_ENTER(t0, batch, 512_DECRYPT_STREAM, 64 * blocks);
+    crypt_stream(vistrutah_512_decrypt_blocks, 64, ctx->key, ctx->key_size, ctx->rounds, in, out,
+                 blocks);
+    VISTRUTAH_LEAVE(t0, batch, 512_DECRYPT_STREAM);
+}
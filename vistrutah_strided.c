@@ -0,0 +1,231 @@
+#define VISTRUTAH_INTERNAL
+#include "vistrutah.h"
+
+// Strided and pointer-array batches on top of the multi-block API. Where
+// the backend has a batch kernel (SVE2, RISC-V), records are staged through
+// a small buffer that stays in L1 so the kernel sees contiguous blocks;
+// elsewhere the multi-block API is a loop over single blocks, and records
+// are processed in place. Contiguous records skip the copies either way.
+// The VAES backend has its own Vistrutah-512 versions, which load the
+// records in place.
+
+#if defined(VISTRUTAH_SVE2) || defined(VISTRUTAH_RISCV)
+#    define STAGE_RECORDS
+#endif
+
+#define STRIDED_BATCH 8
+
+void
+vistrutah_prefetch_ptrs(const uint8_t* const* in, uint8_t* const* out, size_t first, size_t count,
+                        size_t n)
+{
+    for (size_t k = first; k < first + count && k < n; k++) {
+        __builtin_prefetch(in[k], 0, 3);
+        __builtin_prefetch(out[k], 1, 3);
+    }
+}
+
+int
+vistrutah_256_init(vistrutah_256_ctx* ctx, const uint8_t* key, int key_size, int rounds)
+{
+    if (key_size != VISTRUTAH_KEY_SIZE_128 && key_size != VISTRUTAH_KEY_SIZE_256) {
+        return -1;
+    }
+    memset(ctx, 0, sizeof *ctx);
+    memcpy(ctx->key, key, key_size);
+    ctx->key_size = key_size;
+    ctx->rounds   = rounds;
+    VISTRUTAH_PROBE(key_init, 256, key_size);
+
+    return 0;
+}
+
+int
+vistrutah_512_init(vistrutah_512_ctx* ctx, const uint8_t* key, int key_size, int rounds)
+{
+    if (key_size != VISTRUTAH_KEY_SIZE_256 && key_size != VISTRUTAH_KEY_SIZE_512) {
+        return -1;
+    }
+    memset(ctx, 0, sizeof *ctx);
+    memcpy(ctx->key, key, key_size);
+    ctx->key_size = key_size;
+    ctx->rounds   = rounds;
+    VISTRUTAH_PROBE(key_init, 512, key_size);
+
+    return 0;
+}
+
+typedef void (*blocks_fn)(const uint8_t*, uint8_t*, size_t, const uint8_t*, int, int);
+
+static void
+staged(blocks_fn fn, size_t block_size, const uint8_t* key, int key_size, int rounds,
+       const uint8_t* in, size_t in_stride, uint8_t* out, size_t out_stride, size_t n)
+{
+    if (in_stride == block_size && out_stride == block_size) {
+        fn(in, out, n, key, key_size, rounds);
+        return;
+    }
+
+#ifdef STAGE_RECORDS
+    uint8_t buf[STRIDED_BATCH * 64];
+
+    for (size_t i = 0; i < n;) {
+        size_t batch = n - i < STRIDED_BATCH ? n - i : STRIDED_BATCH;
+
+        for (size_t j = 0; j < batch; j++) {
+            memcpy(buf + block_size * j, in + in_stride * (i + j), block_size);
+        }
+        fn(buf, buf, batch, key, key_size, rounds);
+        for (size_t j = 0; j < batch; j++) {
+            memcpy(out + out_stride * (i + j), buf + block_size * j, block_size);
+        }
+        i += batch;
+    }
+#else
+    for (size_t i = 0; i < n; i++) {
+        fn(in + in_stride * i, out + out_stride * i, 1, key, key_size, rounds);
+    }
+#endif
+}
+
+// One run of entries under the same key, STRIDED_BATCH at a time while the
+// next batch is prefetched
+static void
+staged_ptrs(blocks_fn fn, size_t block_size, const uint8_t* key, int key_size, int rounds,
+            const uint8_t* const* in, uint8_t* const* out, size_t n)
+{
+#ifdef STAGE_RECORDS
+    uint8_t buf[STRIDED_BATCH * 64];
+#endif
+
+    for (size_t i = 0; i < n;) {
+        size_t batch = n - i < STRIDED_BATCH ? n - i : STRIDED_BATCH;
+
+        vistrutah_prefetch_ptrs(in, out, i + STRIDED_BATCH, STRIDED_BATCH, n);
+#ifdef STAGE_RECORDS
+        for (size_t j = 0; j < batch; j++) {
+            memcpy(buf + block_size * j, in[i + j], block_size);
+        }
+        fn(buf, buf, batch, key, key_size, rounds);
+        for (size_t j = 0; j < batch; j++) {
+            memcpy(out[i + j], buf + block_size * j, block_size);
+        }
+#else
+        (void) block_size;
+        for (size_t j = 0; j < batch; j++) {
+            fn(in[i + j], out[i + j], 1, key, key_size, rounds);
+        }
+#endif
+        i += batch;
+    }
+}
+
+void
+vistrutah_256_encrypt_strided(const vistrutah_256_ctx* ctx, const uint8_t* in, size_t in_stride,
+                              uint8_t* out, size_t out_stride, size_t n)
+{
+    VISTRUTAH_ENTER(t0, batch, 256_ENCRYPT_STRIDED, 32 * n);
+    staged(vistrutah_256_encrypt_blocks, 32, ctx->key, ctx->key_size, ctx->rounds, in, in_stride,
+           out, out_stride, n);
+    VISTRUTAH_LEAVE(t0, batch, 256_ENCRYPT_STRIDED);
+}
+
+void
+vistrutah_256_decrypt_strided(const vistrutah_256_ctx* ctx, const uint8_t* in, size_t in_stride,
+                              uint8_t* out, size_t out_stride, size_t n)
+{
+    VISTRUTAH_ENTER(t0, batch, 256_DECRYPT_STRIDED, 32 * n);
+    staged(vistrutah_256_decrypt_blocks, 32, ctx->key, ctx->key_size, ctx->rounds, in, in_stride,
+           out, out_stride, n);
+    VISTRUTAH_LEAVE(t0, batch, 256_DECRYPT_STRIDED);
+}
+
+static void
+ptrs_256(blocks_fn fn, const vistrutah_256_ctx* ctx, const vistrutah_256_ctx* const* ctxs,
+         const uint8_t* const* in, uint8_t* const* out, size_t n)
+{
+    for (size_t i = 0; i < n;) {
+        const vistrutah_256_ctx* c   = ctxs != NULL ? ctxs[i] : ctx;
+        size_t                   end = ctxs != NULL ? i + 1 : n;
+
+        while (end < n && ctxs[end] == c) {
+            end++;
+        }
+        staged_ptrs(fn, 32, c->key, c->key_size, c->rounds, in + i, out + i, end - i);
+        i = end;
+    }
+}
+
+void
+vistrutah_256_encrypt_ptrs(const vistrutah_256_ctx* ctx, const vistrutah_256_ctx* const* ctxs,
+                           const uint8_t* const* in, uint8_t* const* out, size_t n)
+{
+    VISTRUTAH_ENTER(t0, batch, 256_ENCRYPT_PTRS, 32 * n);
+    ptrs_256(vistrutah_256_encrypt_blocks, ctx, ctxs, in, out, n);
+    VISTRUTAH_LEAVE(t0, batch, 256_ENCRYPT_PTRS);
+}
+
+void
+vistrutah_256_decrypt_ptrs(const vistrutah_256_ctx* ctx, const vistrutah_256_ctx* const* ctxs,
+                           const uint8_t* const* in, uint8_t* const* out, size_t n)
+{
+    VISTRUTAH_ENTER(t0, batch, 256_DECRYPT_PTRS, 32 * n);
+    ptrs_256(vistrutah_256_decrypt_blocks, ctx, ctxs, in, out, n);
+    VISTRUTAH_LEAVE(t0, batch, 256_DECRYPT_PTRS);
+}
+
+#if !defined(VISTRUTAH_INTEL) || !defined(VISTRUTAH_512_VAES256)
+void
+vistrutah_512_encrypt_strided(const vistrutah_512_ctx* ctx, const uint8_t* in, size_t in_stride,
+                              uint8_t* out, size_t out_stride, size_t n)
+{
+    VISTRUTAH_ENTER(t0, batch, 512_ENCRYPT_STRIDED, 64 * n);
+    staged(vistrutah_512_encrypt_blocks, 64, ctx->key, ctx->key_size, ctx->rounds, in, in_stride,
+           out, out_stride, n);
+    VISTRUTAH_LEAVE(t0, batch, 512_ENCRYPT_STRIDED);
+}
+
+void
+vistrutah_512_decrypt_strided(const vistrutah_512_ctx* ctx, const uint8_t* in, size_t in_stride,
+                              uint8_t* out, size_t out_stride, size_t n)
+{
+    VISTRUTAH_ENTER(t0, batch, 512_DECRYPT_STRIDED, 64 * n);
+    staged(vistrutah_512_decrypt_blocks, 64, ctx->key, ctx->key_size, ctx->rounds, in, in_stride,
+           out, out_stride, n);
+    VISTRUTAH_LEAVE(t0, batch, 512_DECRYPT_STRIDED);
+}
+
+static void
+ptrs_512(blocks_fn fn, const vistrutah_512_ctx* ctx, const vistrutah_512_ctx* const* ctxs,
+         const uint8_t* const* in, uint8_t* const* out, size_t n)
+{
+    for (size_t i = 0; i < n;) {
+        const vistrutah_512_ctx* c   = ctxs != NULL ? ctxs[i] : ctx;
+        size_t                   end = ctxs != NULL ? i + 1 : n;
+
+        while (end < n && ctxs[end] == c) {
+            end++;
+        }
+        staged_ptrs(fn, 64, c->key, c->key_size, c->rounds, in + i, out + i, end - i);
+        i = end;
+    }
+}
+
+void
+vistrutah_512_encrypt_ptrs(const vistrutah_512_ctx* ctx, const vistrutah_512_ctx* const* ctxs,
+                           const uint8_t* const* in, uint8_t* const* out, size_t n)
+{
+    VISTRUTAH_ENTER(t0, batch, 512_ENCRYPT_PTRS, 64 * n);
+    ptrs_512(vistrutah_512_encrypt_blocks, ctx, ctxs, in, out, n);
+    VISTRUTAH_LEAVE(t0, batch, 512_ENCRYPT_PTRS);
+}
+
+void
+vistrutah_512_decrypt_ptrs(const vistrutah_512_ctx* ctx, const vistrutah_512_ctx* const* ctxs,
+                           const uint8_t* const* in, uint8_t* const* out, size_t n)
+{
+    VISTRUTAH_ENTER(t0, batch, 512_DECRYPT_PTRS, 64 * n);
+    ptrs_512(vistrutah_512_decrypt_blocks, ctx, ctxs, in, out, n);
+    VISTRUTAH_LEAVE(t0, batch, 512_DECRYPT_PTRS);
+}
+#endif
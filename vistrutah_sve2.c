@@ -0,0 +1,416 @@
+#include "vistrutah.h"
+
+#if defined(VISTRUTAH_ARM) && defined(VISTRUTAH_SVE2)
+
+#    include <arm_sve.h>
+#    include <string.h>
+#    ifdef __linux__
+#        include <sys/auxv.h>
+#    endif
+
+#    ifndef HWCAP2_SVE2
+#        define HWCAP2_SVE2 (1 << 1)
+#    endif
+#    ifndef HWCAP2_SVEAES
+#        define HWCAP2_SVEAES (1 << 2)
+#    endif
+
+extern const uint8_t ROUND_CONSTANTS[16 * 48];
+extern const uint8_t VISTRUTAH_P4[16];
+extern const uint8_t VISTRUTAH_P5[16];
+extern const uint8_t VISTRUTAH_KEXP_SHUFFLE[32];
+
+// Blocks are kept in memory order: a group of 2 (Vistrutah-256) or 4
+// (Vistrutah-512) vectors holds VL/128 consecutive blocks, and each 128-bit
+// segment of a vector is one AES lane. The mixing layers are byte
+// permutations within a block, done with TBL over vector pairs. The 0xFF
+// "out of range" index must not address a byte of the pair, which limits
+// this backend to VL <= 512 bits; wider machines use the NEON path.
+#    define SVE2_MAX_VB 64
+
+// Byte permutations of the mixing layers, as out[i] = in[perm[i]]
+static const uint8_t asura[32] = { 0,  2,  4,  6,  8,  10, 12, 14, 16, 18, 20,
+                                   22, 24, 26, 28, 30, 1,  3,  5,  7,  9,  11,
+                                   13, 15, 17, 19, 21, 23, 25, 27, 29, 31 };
+
+static const uint8_t asura_inv[32] = { 0, 16, 1, 17, 2,  18, 3,  19, 4,  20, 5,
+                                       21, 6, 22, 7, 23, 8, 24, 9, 25, 10, 26,
+                                       11, 27, 12, 28, 13, 29, 14, 30, 15, 31 };
+
+static const uint8_t vzip[64] = { 0,  16, 32, 48, 1,  17, 33, 49, 2,  18, 34, 50, 3,  19, 35, 51,
+                                  8,  24, 40, 56, 9,  25, 41, 57, 10, 26, 42, 58, 11, 27, 43, 59,
+                                  4,  20, 36, 52, 5,  21, 37, 53, 6,  22, 38, 54, 7,  23, 39, 55,
+                                  12, 28, 44, 60, 13, 29, 45, 61, 14, 30, 46, 62, 15, 31, 47, 63 };
+
+static const uint8_t vunzip[64] = { 0, 4, 8,  12, 32, 36, 40, 44, 16, 20, 24, 28, 48, 52, 56, 60,
+                                    1, 5, 9,  13, 33, 37, 41, 45, 17, 21, 25, 29, 49, 53, 57, 61,
+                                    2, 6, 10, 14, 34, 38, 42, 46, 18, 22, 26, 30, 50, 54, 58, 62,
+                                    3, 7, 11, 15, 35, 39, 43, 47, 19, 23, 27, 31, 51, 55, 59, 63 };
+
+bool
+vistrutah_sve2_available(void)
+{
+#    if defined(__linux__) && defined(AT_HWCAP2)
+    unsigned long hwcap2 = getauxval(AT_HWCAP2);
+
+    if ((hwcap2 & HWCAP2_SVE2) == 0 || (hwcap2 & HWCAP2_SVEAES) == 0) {
+        return false;
+    }
+    return svcntb() <= SVE2_MAX_VB;
+#    else
+    return false;
+#    endif
+}
+
+// Spread per-lane round keys over a group of vectors: nkeys sets of
+// `lanes` 16-byte keys become nkeys sets of `lanes` vectors, where every
+// 128-bit segment gets the key of the block lane it holds.
+static void
+expand_keys(uint8_t* out, const uint8_t* lane_keys, int nkeys, int lanes, size_t vb)
+{
+    for (int k = 0; k < nkeys; k++) {
+        for (int v = 0; v < lanes; v++) {
+            for (size_t p = 0; p < vb; p++) {
+                size_t lane = ((v * vb + p) / 16) % lanes;
+
+                out[(k * lanes + v) * vb + p] = lane_keys[(k * lanes + lane) * 16 + p % 16];
+            }
+        }
+    }
+}
+
+// TBL indices for a block permutation over a group of `lanes` vectors.
+// Output vector v is the OR of one TBL per source vector pair; indices
+// that fall in another pair are set to 0xFF so that TBL yields zero.
+static void
+expand_permutation(uint8_t* out, const uint8_t* perm, int lanes, size_t vb)
+{
+    size_t block_size = 16 * lanes;
+    int    pairs      = lanes / 2;
+
+    for (int v = 0; v < lanes; v++) {
+        for (size_t p = 0; p < vb; p++) {
+            size_t dst = v * vb + p;
+            size_t src = dst - dst % block_size + perm[dst % block_size];
+
+            for (int q = 0; q < pairs; q++) {
+                out[(v * pairs + q) * vb + p] =
+                    src / (2 * vb) == (size_t) q ? (uint8_t) (src % (2 * vb)) : 0xFF;
+            }
+        }
+    }
+}
+
+static void
+round_keys_256(uint8_t* lane_keys, const uint8_t* key, int key_size, int steps)
+{
+    uint8_t fixed_key[32];
+    uint8_t round_key[32];
+    uint8_t temp[16];
+
+    if (key_size == 16) {
+        memcpy(fixed_key, key, 16);
+        memcpy(fixed_key + 16, key, 16);
+    } else {
+        memcpy(fixed_key, key, 32);
+    }
+
+    memcpy(round_key, fixed_key + 16, 16);
+    memcpy(round_key + 16, fixed_key, 16);
+    memcpy(lane_keys, fixed_key, 32);
+    memcpy(lane_keys + 32, round_key, 32);
+
+    for (int i = 1; i <= steps; i++) {
+        memcpy(temp, round_key, 16);
+        for (int j = 0; j < 16; j++) {
+            round_key[j] = temp[VISTRUTAH_P4[j]];
+        }
+        memcpy(temp, round_key + 16, 16);
+        for (int j = 0; j < 16; j++) {
+            round_key[16 + j] = temp[VISTRUTAH_P5[j]];
+        }
+
+        uint8_t* rk = lane_keys + 32 * (i + 1);
+        memcpy(rk, round_key, 32);
+        if (i < steps) {
+            for (int j = 0; j < 16; j++) {
+                rk[j] ^= ROUND_CONSTANTS[16 * (i - 1) + j];
+            }
+        }
+    }
+}
+
+static void
+round_keys_512(uint8_t* lane_keys, const uint8_t* key, int key_size, int steps)
+{
+    static const int shifts[4] = { 5, 10, 5, 10 };
+    uint8_t          fixed_key[64];
+    uint8_t          round_key[64];
+    uint8_t          temp[32];
+
+    if (key_size == 32) {
+        memcpy(fixed_key, key, 32);
+        memcpy(fixed_key + 32, key, 32);
+    } else {
+        memcpy(fixed_key, key, 64);
+    }
+
+    memcpy(temp, fixed_key + 32, 32);
+    for (int i = 0; i < 32; i++) {
+        fixed_key[32 + i] = temp[VISTRUTAH_KEXP_SHUFFLE[i]];
+    }
+
+    memcpy(round_key, fixed_key + 16, 16);
+    memcpy(round_key + 16, fixed_key, 16);
+    memcpy(round_key + 32, fixed_key + 48, 16);
+    memcpy(round_key + 48, fixed_key + 32, 16);
+    memcpy(lane_keys, fixed_key, 64);
+    memcpy(lane_keys + 64, round_key, 64);
+
+    for (int i = 1; i <= steps; i++) {
+        for (int l = 0; l < 4; l++) {
+            memcpy(temp, round_key + 16 * l, 16);
+            for (int j = 0; j < 16; j++) {
+                round_key[16 * l + j] = temp[(j + shifts[l]) % 16];
+            }
+        }
+
+        uint8_t* rk = lane_keys + 64 * (i + 1);
+        memcpy(rk, round_key, 64);
+        if (i < steps) {
+            for (int j = 0; j < 16; j++) {
+                rk[j] ^= ROUND_CONSTANTS[16 * (i - 1) + j];
+            }
+        }
+    }
+}
+
+static inline void
+mixing_layer_256(svuint8_t* s0, svuint8_t* s1, const svuint8_t* idx)
+{
+    svuint8x2_t t = svcreate2_u8(*s0, *s1);
+
+    *s0 = svtbl2_u8(t, idx[0]);
+    *s1 = svtbl2_u8(t, idx[1]);
+}
+
+static inline void
+mixing_layer_512(svuint8_t* s, const svuint8_t* idx)
+{
+    svbool_t    pt = svptrue_b8();
+    svuint8x2_t lo = svcreate2_u8(s[0], s[1]);
+    svuint8x2_t hi = svcreate2_u8(s[2], s[3]);
+
+    for (int v = 0; v < 4; v++) {
+        s[v] = svorr_u8_x(pt, svtbl2_u8(lo, idx[2 * v]), svtbl2_u8(hi, idx[2 * v + 1]));
+    }
+}
+
+// Key material for one call: the fixed key vectors, then steps + 1 round
+// key vectors (round constant included) indexed by step.
+#    define RK(i, v) svld1_u8(pt, keys + ((size_t) ((i) + 1) * LANES + (v)) * vb)
+#    define FK(v)    svld1_u8(pt, keys + (size_t) (v) * vb)
+
+void
+vistrutah_256_encrypt_blocks_sve2(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                                  const uint8_t* key, int key_size, int rounds)
+{
+    enum { LANES = 2 };
+    int      steps  = rounds / ROUNDS_PER_STEP;
+    size_t   vb     = svcntb();
+    size_t   nbytes = blocks * 32;
+    svbool_t pt     = svptrue_b8();
+    uint8_t  lane_keys[(steps + 2) * 32];
+    uint8_t  keys[(steps + 2) * LANES * vb];
+    uint8_t  perm[LANES * vb];
+
+    round_keys_256(lane_keys, key, key_size, steps);
+    expand_keys(keys, lane_keys, steps + 2, LANES, vb);
+    expand_permutation(perm, asura, LANES, vb);
+
+    svuint8_t idx[2] = { svld1_u8(pt, perm), svld1_u8(pt, perm + vb) };
+    svuint8_t fk0    = FK(0);
+    svuint8_t fk1    = FK(1);
+
+    for (size_t off = 0; off < nbytes; off += LANES * vb) {
+        svbool_t pg0 = svwhilelt_b8_u64(off, nbytes);
+        svbool_t pg1 = svwhilelt_b8_u64(off + vb, nbytes);
+
+        svuint8_t s0 = svld1_u8(pg0, plaintext + off);
+        svuint8_t s1 = svld1_u8(pg1, plaintext + off + vb);
+
+        s0 = svaesmc_u8(svaese_u8(s0, RK(0, 0)));
+        s1 = svaesmc_u8(svaese_u8(s1, RK(0, 1)));
+
+        for (int i = 1; i < steps; i++) {
+            s0 = svaesmc_u8(svaese_u8(s0, fk0));
+            s1 = svaesmc_u8(svaese_u8(s1, fk1));
+            mixing_layer_256(&s0, &s1, idx);
+            s0 = svaesmc_u8(svaese_u8(s0, RK(i, 0)));
+            s1 = svaesmc_u8(svaese_u8(s1, RK(i, 1)));
+        }
+
+        s0 = sveor_u8_x(pt, svaese_u8(s0, fk0), RK(steps, 0));
+        s1 = sveor_u8_x(pt, svaese_u8(s1, fk1), RK(steps, 1));
+
+        svst1_u8(pg0, ciphertext + off, s0);
+        svst1_u8(pg1, ciphertext + off + vb, s1);
+    }
+}
+
+void
+vistrutah_256_decrypt_blocks_sve2(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                                  const uint8_t* key, int key_size, int rounds)
+{
+    enum { LANES = 2 };
+    int      steps  = rounds / ROUNDS_PER_STEP;
+    size_t   vb     = svcntb();
+    size_t   nbytes = blocks * 32;
+    svbool_t pt     = svptrue_b8();
+    uint8_t  lane_keys[(steps + 2) * 32];
+    uint8_t  keys[(steps + 2) * LANES * vb];
+    uint8_t  perm[LANES * vb];
+
+    round_keys_256(lane_keys, key, key_size, steps);
+    expand_keys(keys, lane_keys, steps + 2, LANES, vb);
+    expand_permutation(perm, asura_inv, LANES, vb);
+
+    svuint8_t idx[2] = { svld1_u8(pt, perm), svld1_u8(pt, perm + vb) };
+    svuint8_t fk0    = svaesimc_u8(FK(0));
+    svuint8_t fk1    = svaesimc_u8(FK(1));
+    svuint8_t zero   = svdup_n_u8(0);
+
+    for (size_t off = 0; off < nbytes; off += LANES * vb) {
+        svbool_t pg0 = svwhilelt_b8_u64(off, nbytes);
+        svbool_t pg1 = svwhilelt_b8_u64(off + vb, nbytes);
+
+        svuint8_t s0 = svld1_u8(pg0, ciphertext + off);
+        svuint8_t s1 = svld1_u8(pg1, ciphertext + off + vb);
+
+        s0 = svaesimc_u8(svaesd_u8(s0, RK(steps, 0)));
+        s1 = svaesimc_u8(svaesd_u8(s1, RK(steps, 1)));
+
+        for (int i = steps - 1; i > 0; i--) {
+            s0 = sveor_u8_x(pt, svaesd_u8(s0, fk0), RK(i, 0));
+            s1 = sveor_u8_x(pt, svaesd_u8(s1, fk1), RK(i, 1));
+            mixing_layer_256(&s0, &s1, idx);
+            s0 = svaesimc_u8(svaesd_u8(svaesimc_u8(s0), zero));
+            s1 = svaesimc_u8(svaesd_u8(svaesimc_u8(s1), zero));
+        }
+
+        s0 = sveor_u8_x(pt, svaesd_u8(s0, fk0), RK(0, 0));
+        s1 = sveor_u8_x(pt, svaesd_u8(s1, fk1), RK(0, 1));
+
+        svst1_u8(pg0, plaintext + off, s0);
+        svst1_u8(pg1, plaintext + off + vb, s1);
+    }
+}
+
+void
+vistrutah_512_encrypt_blocks_sve2(const uint8_t* plaintext, uint8_t* ciphertext, size_t blocks,
+                                  const uint8_t* key, int key_size, int rounds)
+{
+    enum { LANES = 4 };
+    int      steps  = rounds / ROUNDS_PER_STEP;
+    size_t   vb     = svcntb();
+    size_t   nbytes = blocks * 64;
+    svbool_t pt     = svptrue_b8();
+    uint8_t  lane_keys[(steps + 2) * 64];
+    uint8_t  keys[(steps + 2) * LANES * vb];
+    uint8_t  perm[2 * LANES * vb];
+
+    round_keys_512(lane_keys, key, key_size, steps);
+    expand_keys(keys, lane_keys, steps + 2, LANES, vb);
+    expand_permutation(perm, vzip, LANES, vb);
+
+    svuint8_t idx[8];
+    svuint8_t fk[LANES];
+    for (int v = 0; v < 8; v++) {
+        idx[v] = svld1_u8(pt, perm + v * vb);
+    }
+    for (int v = 0; v < LANES; v++) {
+        fk[v] = FK(v);
+    }
+
+    for (size_t off = 0; off < nbytes; off += LANES * vb) {
+        svbool_t  pg[LANES];
+        svuint8_t s[LANES];
+
+        for (int v = 0; v < LANES; v++) {
+            pg[v] = svwhilelt_b8_u64(off + v * vb, nbytes);
+            s[v]  = svld1_u8(pg[v], plaintext + off + v * vb);
+            s[v]  = svaesmc_u8(svaese_u8(s[v], RK(0, v)));
+        }
+
+        for (int i = 1; i < steps; i++) {
+            for (int v = 0; v < LANES; v++) {
+                s[v] = svaesmc_u8(svaese_u8(s[v], fk[v]));
+            }
+            mixing_layer_512(s, idx);
+            for (int v = 0; v < LANES; v++) {
+                s[v] = svaesmc_u8(svaese_u8(s[v], RK(i, v)));
+            }
+        }
+
+        for (int v = 0; v < LANES; v++) {
+            s[v] = sveor_u8_x(pt, svaese_u8(s[v], fk[v]), RK(steps, v));
+            svst1_u8(pg[v], ciphertext + off + v * vb, s[v]);
+        }
+    }
+}
+
+void
+vistrutah_512_decrypt_blocks_sve2(const uint8_t* ciphertext, uint8_t* plaintext, size_t blocks,
+                                  const uint8_t* key, int key_size, int rounds)
+{
+    enum { LANES = 4 };
+    int      steps  = rounds / ROUNDS_PER_STEP;
+    size_t   vb     = svcntb();
+    size_t   nbytes = blocks * 64;
+    svbool_t pt     = svptrue_b8();
+    uint8_t  lane_keys[(steps + 2) * 64];
+    uint8_t  keys[(steps + 2) * LANES * vb];
+    uint8_t  perm[2 * LANES * vb];
+
+    round_keys_512(lane_keys, key, key_size, steps);
+    expand_keys(keys, lane_keys, steps + 2, LANES, vb);
+    expand_permutation(perm, vunzip, LANES, vb);
+
+    svuint8_t idx[8];
+    svuint8_t fk[LANES];
+    svuint8_t zero = svdup_n_u8(0);
+    for (int v = 0; v < 8; v++) {
+        idx[v] = svld1_u8(pt, perm + v * vb);
+    }
+    for (int v = 0; v < LANES; v++) {
+        fk[v] = svaesimc_u8(FK(v));
+    }
+
+    for (size_t off = 0; off < nbytes; off += LANES * vb) {
+        svbool_t  pg[LANES];
+        svuint8_t s[LANES];
+
+        for (int v = 0; v < LANES; v++) {
+            pg[v] = svwhilelt_b8_u64(off + v * vb, nbytes);
+            s[v]  = svld1_u8(pg[v], ciphertext + off + v * vb);
+            s[v]  = svaesimc_u8(svaesd_u8(s[v], RK(steps, v)));
+        }
+
+        for (int i = steps - 1; i > 0; i--) {
+            for (int v = 0; v < LANES; v++) {
+                s[v] = sveor_u8_x(pt, svaesd_u8(s[v], fk[v]), RK(i, v));
+            }
+            mixing_layer_512(s, idx);
+            for (int v = 0; v < LANES; v++) {
+                s[v] = svaesimc_u8(svaesd_u8(svaesimc_u8(s[v]), zero));
+            }
+        }
+
+        for (int v = 0; v < LANES; v++) {
+            s[v] = sveor_u8_x(pt, svaesd_u8(s[v], fk[v]), RK(0, v));
+            svst1_u8(pg[v], plaintext + off + v * vb, s[v]);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,349 @@
+#define _POSIX_C_SOURCE 200809L
+#define VISTRUTAH_INTERNAL
+
+#include "vistrutah.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(VISTRUTAH_INTEL) && defined(__x86_64__)
+#    include <cpuid.h>
+#endif
+
+// Startup autotuner. Each backend offers a short list of batch kernels per
+// variant; the first entry is the default. Candidates are timed on a
+// buffer that stays in L1, best of a few short runs, and the fastest is
+// written to vistrutah_kernel_configs[], which the backends read on every
+// multi-block call.
+
+#define TUNE_BLOCKS 64
+#define TUNE_RUNS   5
+#define TUNE_NANOS  400000
+
+#if defined(VISTRUTAH_INTEL) && defined(__AES__)
+#    define BASE_KERNEL "AES-NI"
+#    define BASE_WIDTH  1
+#elif defined(VISTRUTAH_SVE2)
+#    define BASE_KERNEL "SVE2"
+#    define BASE_WIDTH  0
+#elif defined(VISTRUTAH_RISCV)
+#    define BASE_KERNEL "RVV"
+#    define BASE_WIDTH  0
+#elif defined(VISTRUTAH_ARM)
+#    define BASE_KERNEL "NEON"
+#    define BASE_WIDTH  1
+#else
+#    define BASE_KERNEL "portable"
+#    define BASE_WIDTH  1
+#endif
+
+// blocks_in_flight 0: as many as the vector length holds
+#define BASE_CONFIG { BASE_KERNEL, BASE_WIDTH }
+
+static const vistrutah_kernel_config kernels_256[] = { BASE_CONFIG };
+
+#if defined(VISTRUTAH_512_VAES256)
+#    define DEFAULT_512 { "VAES", 4 }
+static const vistrutah_kernel_config kernels_512[] = {
+    DEFAULT_512, { "VAES", 2 }, { "VAES", 6 }, { "VAES", 8 }
+};
+#elif defined(VISTRUTAH_512_VAES_KERNEL)
+#    define DEFAULT_512 BASE_CONFIG
+static const vistrutah_kernel_config kernels_512[] = {
+    DEFAULT_512, { "VAES", 2 }, { "VAES", 4 }, { "VAES", 6 }, { "VAES", 8 }
+};
+#else
+#    define DEFAULT_512 BASE_CONFIG
+static const vistrutah_kernel_config kernels_512[] = { DEFAULT_512 };
+#endif
+
+#define KERNELS_256 (sizeof kernels_256 / sizeof kernels_256[0])
+#define KERNELS_512 (sizeof kernels_512 / sizeof kernels_512[0])
+
+vistrutah_kernel_config vistrutah_kernel_configs[VISTRUTAH_VARIANTS] = {
+    [VISTRUTAH_256_ENCRYPT] = BASE_CONFIG,
+    [VISTRUTAH_256_DECRYPT] = BASE_CONFIG,
+    [VISTRUTAH_512_ENCRYPT] = DEFAULT_512,
+    [VISTRUTAH_512_DECRYPT] = DEFAULT_512,
+};
+
+static const char* const variant_names[VISTRUTAH_VARIANTS] = { "256-encrypt", "256-decrypt",
+                                                               "512-encrypt", "512-decrypt" };
+
+static size_t
+candidates(vistrutah_variant v, const vistrutah_kernel_config** list)
+{
+    if (v == VISTRUTAH_256_ENCRYPT || v == VISTRUTAH_256_DECRYPT) {
+        *list = kernels_256;
+        return KERNELS_256;
+    }
+    *list = kernels_512;
+    return KERNELS_512;
+}
+
+static uint64_t
+now_nanos(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+// Best blocks per second of the current configuration of v
+static double
+time_variant(vistrutah_variant v, uint8_t* buf, const uint8_t* key)
+{
+    double best = 0;
+
+    for (int run = 0; run < TUNE_RUNS; run++) {
+        uint64_t start = now_nanos(), elapsed;
+        size_t   done  = 0;
+
+        do {
+            switch (v) {
+            case VISTRUTAH_256_ENCRYPT:
+                vistrutah_256_encrypt_blocks(buf, buf, TUNE_BLOCKS, key, 32,
+                                             VISTRUTAH_256_ROUNDS_LONG);
+                break;
+            case VISTRUTAH_256_DECRYPT:
+                vistrutah_256_decrypt_blocks(buf, buf, TUNE_BLOCKS, key, 32,
+                                             VISTRUTAH_256_ROUNDS_LONG);
+                break;
+            case VISTRUTAH_512_ENCRYPT:
+                vistrutah_512_encrypt_blocks(buf, buf, TUNE_BLOCKS, key, 64,
+                                             VISTRUTAH_512_ROUNDS_LONG_512KEY);
+                break;
+            default:
+                vistrutah_512_decrypt_blocks(buf, buf, TUNE_BLOCKS, key, 64,
+                                             VISTRUTAH_512_ROUNDS_LONG_512KEY);
+                break;
+            }
+            done += TUNE_BLOCKS;
+            elapsed = now_nanos() - start;
+        } while (elapsed < TUNE_NANOS / TUNE_RUNS);
+
+        double rate = (double) done / (double) elapsed;
+
+        if (rate > best) {
+            best = rate;
+        }
+    }
+    return best;
+}
+
+// Where the CPU model comes from: the brand string, or the /proc/cpuinfo
+// fields that identify the core
+#if defined(VISTRUTAH_INTEL) && defined(__x86_64__)
+#    define MODEL_CPUID
+#elif defined(__linux__) && defined(__aarch64__)
+// The fields of MIDR_EL1
+#    define MODEL_KEYS "CPU implementer", "CPU variant", "CPU part", "CPU revision"
+#elif defined(__linux__) && defined(__riscv)
+#    define MODEL_KEYS "mvendorid", "marchid", "mimpid"
+#elif defined(__linux__) && (defined(__x86_64__) || defined(__i386__))
+#    define MODEL_KEYS "model name"
+#endif
+
+#ifdef MODEL_KEYS
+// Values of MODEL_KEYS for the first CPU listed, which appear in that
+// order, joined by spaces
+static int
+cpuinfo_model(char* out, size_t len)
+{
+    static const char* const keys[] = { MODEL_KEYS };
+    const int                nkeys  = sizeof keys / sizeof keys[0];
+
+    FILE*  f = fopen("/proc/cpuinfo", "r");
+    char   line[256];
+    size_t used  = 0;
+    int    found = 0;
+
+    if (f == NULL) {
+        return -1;
+    }
+    while (found < nkeys && fgets(line, sizeof line, f) != NULL) {
+        size_t key_len = strlen(keys[found]);
+        char*  value   = strchr(line, ':');
+        int    n;
+
+        if (strncmp(line, keys[found], key_len) != 0 || value == NULL ||
+            line + key_len + strspn(line + key_len, " \t") != value) {
+            continue;
+        }
+        value += 1 + strspn(value + 1, " \t");
+        value[strcspn(value, "\n")] = '\0';
+        n = snprintf(out + used, len - used, "%s%s", found > 0 ? " " : "", value);
+        if (n < 0 || (size_t) n >= len - used) {
+            break;
+        }
+        used += (size_t) n;
+        found++;
+    }
+    fclose(f);
+    return found == nkeys ? 0 : -1;
+}
+#endif
+
+// Returns -1 when the CPU model is unknown
+static int
+cpu_model(char* out, size_t len)
+{
+#if defined(MODEL_CPUID)
+    unsigned int regs[12];
+
+    if (__get_cpuid_max(0x80000000, NULL) >= 0x80000004) {
+        for (unsigned int i = 0; i < 3; i++) {
+            __get_cpuid(0x80000002 + i, &regs[4 * i], &regs[4 * i + 1], &regs[4 * i + 2],
+                        &regs[4 * i + 3]);
+        }
+
+        char   brand[49];
+        size_t start = 0;
+
+        memcpy(brand, regs, 48);
+        brand[48] = '\0';
+        while (brand[start] == ' ') {
+            start++;
+        }
+        snprintf(out, len, "%s", brand + start);
+        return 0;
+    }
+    return -1;
+#elif defined(MODEL_KEYS)
+    return cpuinfo_model(out, len);
+#else
+    (void) out;
+    (void) len;
+    return -1;
+#endif
+}
+
+// Cache file: a header line with the CPU model and implementation, then
+// one line per variant: "<variant> <kernel> <blocks in flight>"
+static int
+cache_header(char* out, size_t len)
+{
+    char model[96];
+
+    if (cpu_model(model, sizeof model) != 0) {
+        return -1;
+    }
+    snprintf(out, len, "vistrutah-tune cpu=%s impl=%s\n", model, vistrutah_get_impl_name());
+    return 0;
+}
+
+static int
+load_cache(const char* path, const char* expected, size_t* choice)
+{
+    FILE* f = fopen(path, "r");
+    char  line[256];
+    int   found = 0;
+
+    if (f == NULL) {
+        return -1;
+    }
+    if (fgets(line, sizeof line, f) == NULL || strcmp(line, expected) != 0) {
+        fclose(f);
+        return -1;
+    }
+    while (fgets(line, sizeof line, f) != NULL) {
+        char name[32], kernel[32];
+        int  width;
+
+        if (sscanf(line, "%31s %31s %d", name, kernel, &width) != 3) {
+            continue;
+        }
+        for (int v = 0; v < VISTRUTAH_VARIANTS; v++) {
+            const vistrutah_kernel_config* list;
+            size_t                         n = candidates((vistrutah_variant) v, &list);
+
+            if (strcmp(name, variant_names[v]) != 0) {
+                continue;
+            }
+            for (size_t k = 0; k < n; k++) {
+                if (strcmp(kernel, list[k].kernel) == 0 && width == list[k].blocks_in_flight) {
+                    choice[v] = k;
+                    found |= 1 << v;
+                }
+            }
+        }
+    }
+    fclose(f);
+    return found == (1 << VISTRUTAH_VARIANTS) - 1 ? 0 : -1;
+}
+
+static int
+store_cache(const char* path, const char* header)
+{
+    FILE* f = fopen(path, "w");
+    int   ok;
+
+    if (f == NULL) {
+        return -1;
+    }
+    ok = fputs(header, f) >= 0;
+    for (int v = 0; v < VISTRUTAH_VARIANTS; v++) {
+        ok &= fprintf(f, "%s %s %d\n", variant_names[v], vistrutah_kernel_configs[v].kernel,
+                      vistrutah_kernel_configs[v].blocks_in_flight) > 0;
+    }
+    ok &= fclose(f) == 0;
+    return ok ? 0 : -1;
+}
+
+int
+vistrutah_autotune(const char* cache_path)
+{
+    size_t  choice[VISTRUTAH_VARIANTS] = { 0 };
+    uint8_t key[64];
+    uint8_t buf[TUNE_BLOCKS * 64];
+    char    header[256];
+
+    // A decision is only valid for the CPU model it was timed on, so
+    // without a model there is nothing to key the cache by
+    if (cache_path != NULL && cache_header(header, sizeof header) != 0) {
+        cache_path = NULL;
+    }
+    if (cache_path != NULL && load_cache(cache_path, header, choice) == 0) {
+        for (int v = 0; v < VISTRUTAH_VARIANTS; v++) {
+            const vistrutah_kernel_config* list;
+
+            candidates((vistrutah_variant) v, &list);
+            vistrutah_kernel_configs[v] = list[choice[v]];
+        }
+        return 0;
+    }
+
+    for (size_t i = 0; i < sizeof key; i++) {
+        key[i] = (uint8_t) (i * 29 + 3);
+    }
+    memset(buf, 0x5c, sizeof buf);
+
+    for (int v = 0; v < VISTRUTAH_VARIANTS; v++) {
+        const vistrutah_kernel_config* list;
+        size_t                         n         = candidates((vistrutah_variant) v, &list);
+        size_t                         best      = 0;
+        double                         best_rate = 0;
+
+        for (size_t k = 0; k < n && n > 1; k++) {
+            double rate;
+
+            vistrutah_kernel_configs[v] = list[k];
+            rate                        = time_variant((vistrutah_variant) v, buf, key);
+            if (rate > best_rate) {
+                best_rate = rate;
+                best      = k;
+            }
+        }
+        vistrutah_kernel_configs[v] = list[best];
+    }
+
+    return cache_path != NULL ? store_cache(cache_path, header) : 0;
+}
+
+vistrutah_kernel_config
+vistrutah_get_kernel_config(vistrutah_variant variant)
+{
+    return vistrutah_kernel_configs[variant];
+}
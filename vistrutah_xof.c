@@ -0,0 +1,105 @@
+#include "vistrutah.h"
+
+// Sponge over vistrutah_512_permute(). Byte 63 of the state is in the
+// capacity for every allowed rate; it is initialised with the rate, so
+// different rates give unrelated outputs.
+//
+// A full block is only permuted once more input arrives. The last block
+// is padded with 0x01 if it is partial; if it is full, a frame bit in the
+// capacity is flipped instead of adding a padding block, so a 32-byte
+// input at rate 32 costs a single permutation.
+
+#define FULL_BLOCK_FRAME 0x80
+
+int
+vistrutah_xof_init(vistrutah_xof_state* st, size_t rate)
+{
+    if (rate == 0 || rate >= 64) {
+        return -1;
+    }
+    memset(st->state, 0, sizeof st->state);
+    st->state[63] = (uint8_t) rate;
+    st->rate      = rate;
+    st->pos       = 0;
+    st->squeezing = false;
+
+    return 0;
+}
+
+void
+vistrutah_xof_absorb(vistrutah_xof_state* st, const uint8_t* in, size_t len)
+{
+    VISTRUTAH_ENTER(t0, mode, XOF_ABSORB, len);
+
+    while (len > 0) {
+        if (st->pos == st->rate) {
+            vistrutah_512_permute(st->state);
+            st->pos = 0;
+        }
+
+        size_t n = st->rate - st->pos;
+
+        if (n > len) {
+            n = len;
+        }
+        for (size_t i = 0; i < n; i++) {
+            st->state[st->pos + i] ^= in[i];
+        }
+        st->pos += n;
+        in += n;
+        len -= n;
+    }
+    VISTRUTAH_LEAVE(t0, mode, XOF_ABSORB);
+}
+
+void
+vistrutah_xof_squeeze(vistrutah_xof_state* st, uint8_t* out, size_t len)
+{
+    VISTRUTAH_ENTER(t0, mode, XOF_SQUEEZE, len);
+
+    if (!st->squeezing) {
+        if (st->pos == st->rate) {
+            st->state[63] ^= FULL_BLOCK_FRAME;
+        } else {
+            st->state[st->pos] ^= 0x01;
+        }
+        vistrutah_512_permute(st->state);
+        st->pos       = 0;
+        st->squeezing = true;
+    }
+
+    while (len > 0) {
+        if (st->pos == st->rate) {
+            vistrutah_512_permute(st->state);
+            st->pos = 0;
+        }
+
+        size_t n = st->rate - st->pos;
+
+        if (n > len) {
+            n = len;
+        }
+        memcpy(out, st->state + st->pos, n);
+        st->pos += n;
+        out += n;
+        len -= n;
+    }
+    VISTRUTAH_LEAVE(t0, mode, XOF_SQUEEZE);
+}
+
+int
+vistrutah_xof(const uint8_t* in, size_t len, uint8_t* out, size_t out_len, size_t rate)
+{
+    vistrutah_xof_state st;
+
+    if (vistrutah_xof_init(&st, rate) != 0) {
+        return -1;
+    }
+
+    VISTRUTAH_ENTER(t0, mode, XOF, len + out_len);
+    vistrutah_xof_absorb(&st, in, len);
+    vistrutah_xof_squeeze(&st, out, out_len);
+    VISTRUTAH_LEAVE(t0, mode, XOF);
+
+    return 0;
+}